@@ -28,6 +28,9 @@ if(NOT WITH_PROFILER)
     add_definitions(-DPADDLE_DISABLE_PROFILER)
 endif(NOT WITH_PROFILER)
 
+# Eigen::ThreadPoolDevice is used for intra-op parallelism of CPU kernels.
+add_definitions(-DEIGEN_USE_THREADS)
+
 if(WITH_AVX AND AVX_FOUND)
     set(SIMD_FLAG ${AVX_FLAG})
     add_definitions(-DPADDLE_WITH_AVX)
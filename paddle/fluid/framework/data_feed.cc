@@ -34,6 +34,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
+#ifdef PADDLE_WITH_DISTRIBUTE
+#include "paddle/fluid/operators/distributed/parameter_prefetch.h"
+#endif
 #include "paddle/fluid/platform/timer.h"
 
 namespace paddle {
@@ -898,73 +901,218 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstance(Record* instance) {
   return false;
 }
 
-void MultiSlotInMemoryDataFeed::PutToFeedVec(
-    const std::vector<Record>& ins_vec) {
+MultiSlotInMemoryDataFeed::~MultiSlotInMemoryDataFeed() {
+  // The batch being assembled may still announce its ids.
+  if (next_batch_.valid()) {
+    next_batch_.wait();
+  }
+  UnregisterFeedVars();
+}
+
+void MultiSlotInMemoryDataFeed::AssignFeedVar(const Scope& scope) {
+  UnregisterFeedVars();
+  DataFeed::AssignFeedVar(scope);
+}
+
+void MultiSlotInMemoryDataFeed::UnregisterFeedVars() {
+#ifdef PADDLE_WITH_DISTRIBUTE
+  std::vector<const LoDTensor*> feed_vars;
+  for (auto* var : feed_vec_) {
+    if (var != nullptr) {
+      feed_vars.push_back(var);
+    }
+  }
+  if (!feed_vars.empty()) {
+    operators::distributed::PrefetchPipeline::Instance().Unregister(feed_vars);
+  }
+#endif
+}
+
+int MultiSlotInMemoryDataFeed::Next() {
 #ifdef _LINUX
-  std::vector<std::vector<float>> batch_float_feasigns(use_slots_.size(),
-                                                       std::vector<float>());
-  std::vector<std::vector<uint64_t>> batch_uint64_feasigns(
-      use_slots_.size(), std::vector<uint64_t>());
-  std::vector<std::vector<size_t>> offset(use_slots_.size(),
-                                          std::vector<size_t>{0});
-  std::vector<bool> visit(use_slots_.size(), false);
-  ins_content_vec_.clear();
-  ins_content_vec_.reserve(ins_vec.size());
-  ins_id_vec_.clear();
-  ins_id_vec_.reserve(ins_vec.size());
+  this->CheckStart();
+  CHECK(output_channel_ != nullptr);
+  CHECK(consume_channel_ != nullptr);
+  VLOG(3) << "output_channel_ size=" << output_channel_->Size()
+          << ", consume_channel_ size=" << consume_channel_->Size()
+          << ", thread_id=" << thread_id_;
+  if (assemble_thread_ == nullptr) {
+    assemble_thread_.reset(new ::ThreadPool(1));
+  }
+  // The first batch of a pass is assembled here, the next ones while the
+  // previous one is trained.
+  if (!next_batch_.valid()) {
+    FeedBatch* batch = &batches_[cur_batch_];
+    next_batch_ = assemble_thread_->enqueue(
+        [this, batch] { return AssembleBatch(batch); });
+  }
+  this->batch_size_ = next_batch_.get();
+  VLOG(3) << "batch_size_=" << this->batch_size_
+          << ", thread_id=" << thread_id_;
+  if (this->batch_size_ != 0) {
+    FeedBatchToVars(&batches_[cur_batch_]);
+    cur_batch_ = 1 - cur_batch_;
+    FeedBatch* batch = &batches_[cur_batch_];
+    next_batch_ = assemble_thread_->enqueue(
+        [this, batch] { return AssembleBatch(batch); });
+  } else {
+    VLOG(3) << "finish reading, output_channel_ size="
+            << output_channel_->Size()
+            << ", consume_channel_ size=" << consume_channel_->Size()
+            << ", thread_id=" << thread_id_;
+  }
+  return this->batch_size_;
+#else
+  return 0;
+#endif
+}
+
+int MultiSlotInMemoryDataFeed::AssembleBatch(FeedBatch* batch) {
+  auto& ins_vec = batch->ins_vec;
+  ins_vec.clear();
+  Record instance;
+  while (static_cast<int>(ins_vec.size()) < this->default_batch_size_) {
+    if (output_channel_->Size() == 0) {
+      break;
+    }
+    output_channel_->Get(instance);
+    ins_vec.push_back(instance);
+    consume_channel_->Put(std::move(instance));
+  }
+  if (!ins_vec.empty()) {
+    BuildBatch(ins_vec, batch);
+#ifdef PADDLE_WITH_DISTRIBUTE
+    // The rows of the ids can be requested while the previous batch is
+    // trained.
+    if (operators::distributed::PrefetchPipeline::IsEnabled()) {
+      std::vector<const LoDTensor*> feed_vars;
+      std::vector<const LoDTensor*> ids;
+      for (size_t i = 0; i < use_slots_.size(); ++i) {
+        if (feed_vec_[i] != nullptr && all_slots_type_[i][0] == 'u') {
+          feed_vars.push_back(feed_vec_[i]);
+          ids.push_back(&batch->tensors[i]);
+        }
+      }
+      operators::distributed::PrefetchPipeline::Instance().PrefetchNextBatch(
+          feed_vars, ids);
+    }
+#endif
+  }
+  return static_cast<int>(ins_vec.size());
+}
+
+void MultiSlotInMemoryDataFeed::BuildBatch(const std::vector<Record>& ins_vec,
+                                           FeedBatch* batch) {
+  size_t num_slots = use_slots_.size();
+  batch->tensors.resize(num_slots);
+  batch->capacities.resize(num_slots, 0);
+  batch->offsets.resize(num_slots);
+  batch->ins_ids.clear();
+  batch->ins_contents.clear();
+
+  // Count the feasigns of every slot first, an instance without any in a
+  // slot gets a default 0.
+  std::vector<size_t> counts(num_slots, 0);
+  for (auto& offset : batch->offsets) {
+    offset.resize(ins_vec.size() + 1);
+    offset[0] = 0;
+  }
   for (size_t i = 0; i < ins_vec.size(); ++i) {
     auto& r = ins_vec[i];
-    ins_id_vec_.push_back(r.ins_id_);
-    ins_content_vec_.push_back(r.content_);
+    batch->ins_ids.push_back(r.ins_id_);
+    batch->ins_contents.push_back(r.content_);
     for (auto& item : r.float_feasigns_) {
-      batch_float_feasigns[item.slot()].push_back(item.sign().float_feasign_);
-      visit[item.slot()] = true;
+      ++counts[item.slot()];
     }
     for (auto& item : r.uint64_feasigns_) {
-      batch_uint64_feasigns[item.slot()].push_back(item.sign().uint64_feasign_);
-      visit[item.slot()] = true;
+      ++counts[item.slot()];
     }
-    for (size_t j = 0; j < use_slots_.size(); ++j) {
-      const auto& type = all_slots_type_[j];
-      if (visit[j]) {
-        visit[j] = false;
-      } else {
-        // fill slot value with default value 0
-        if (type[0] == 'f') {  // float
-          batch_float_feasigns[j].push_back(0.0);
-        } else if (type[0] == 'u') {  // uint64
-          batch_uint64_feasigns[j].push_back(0);
-        }
+    for (size_t j = 0; j < num_slots; ++j) {
+      batch->offsets[j][i + 1] =
+          batch->offsets[j][i] + std::max<size_t>(counts[j], 1);
+      counts[j] = 0;
+    }
+  }
+
+  // Then write them straight into the tensors, grown when needed. The memory
+  // of a tensor is only reused when nothing else holds it any more: the feed
+  // variables of a pipeline scope or the views of ops, e.g. reshape2, may
+  // still use the batch built in it before.
+  std::vector<float*> float_data(num_slots, nullptr);
+  std::vector<int64_t*> uint64_data(num_slots, nullptr);
+  platform::CPUPlace cpu_place;
+  for (size_t j = 0; j < num_slots; ++j) {
+    int64_t total = batch->offsets[j].back();
+    auto& tensor = batch->tensors[j];
+    auto& capacity = batch->capacities[j];
+    const auto& type = all_slots_type_[j];
+    bool in_use = tensor.IsInitialized() && tensor.Holder().use_count() > 1;
+    if (in_use || total > capacity) {
+      if (total > capacity) {
+        capacity = std::max(total, capacity + capacity / 2);
       }
-      // get offset of this ins in this slot
+      tensor = LoDTensor();
+      tensor.Resize({capacity, 1});
       if (type[0] == 'f') {  // float
-        offset[j].push_back(batch_float_feasigns[j].size());
+        tensor.mutable_data<float>(cpu_place);
       } else if (type[0] == 'u') {  // uint64
-        offset[j].push_back(batch_uint64_feasigns[j].size());
+        tensor.mutable_data<int64_t>(cpu_place);
+      }
+    }
+    tensor.Resize({total, 1});
+    if (type[0] == 'f') {  // float
+      float_data[j] = tensor.data<float>();
+    } else if (type[0] == 'u') {  // uint64, no uint64_t type in paddlepaddle
+      uint64_data[j] = tensor.data<int64_t>();
+    }
+  }
+  std::vector<size_t> pos(num_slots, 0);
+  for (size_t i = 0; i < ins_vec.size(); ++i) {
+    auto& r = ins_vec[i];
+    for (auto& item : r.float_feasigns_) {
+      float_data[item.slot()][pos[item.slot()]++] = item.sign().float_feasign_;
+    }
+    for (auto& item : r.uint64_feasigns_) {
+      uint64_data[item.slot()][pos[item.slot()]++] =
+          static_cast<int64_t>(item.sign().uint64_feasign_);
+    }
+    for (size_t j = 0; j < num_slots; ++j) {
+      if (pos[j] != batch->offsets[j][i]) continue;
+      // fill slot value with default value 0
+      if (float_data[j] != nullptr) {
+        float_data[j][pos[j]] = 0.0;
+      } else if (uint64_data[j] != nullptr) {
+        uint64_data[j][pos[j]] = 0;
       }
+      ++pos[j];
     }
   }
+}
 
+void MultiSlotInMemoryDataFeed::FeedBatchToVars(FeedBatch* batch) {
   for (size_t i = 0; i < use_slots_.size(); ++i) {
     if (feed_vec_[i] == nullptr) {
       continue;
     }
-    int total_instance = offset[i].back();
-    const auto& type = all_slots_type_[i];
-    if (type[0] == 'f') {  // float
-      float* feasign = batch_float_feasigns[i].data();
-      float* tensor_ptr =
-          feed_vec_[i]->mutable_data<float>({total_instance, 1}, this->place_);
-      CopyToFeedTensor(tensor_ptr, feasign, total_instance * sizeof(float));
-    } else if (type[0] == 'u') {  // uint64
-      // no uint64_t type in paddlepaddle
-      uint64_t* feasign = batch_uint64_feasigns[i].data();
-      int64_t* tensor_ptr = feed_vec_[i]->mutable_data<int64_t>(
-          {total_instance, 1}, this->place_);
-      CopyToFeedTensor(tensor_ptr, feasign, total_instance * sizeof(int64_t));
+    auto& tensor = batch->tensors[i];
+    int total_instance = static_cast<int>(tensor.numel());
+    if (platform::is_cpu_place(this->place_)) {
+      feed_vec_[i]->ShareDataWith(tensor);
+    } else {
+      const auto& type = all_slots_type_[i];
+      if (type[0] == 'f') {  // float
+        float* tensor_ptr = feed_vec_[i]->mutable_data<float>(
+            {total_instance, 1}, this->place_);
+        CopyToFeedTensor(tensor_ptr, tensor.data<float>(),
+                         total_instance * sizeof(float));
+      } else if (type[0] == 'u') {  // uint64
+        int64_t* tensor_ptr = feed_vec_[i]->mutable_data<int64_t>(
+            {total_instance, 1}, this->place_);
+        CopyToFeedTensor(tensor_ptr, tensor.data<int64_t>(),
+                         total_instance * sizeof(int64_t));
+      }
     }
-    auto& slot_offset = offset[i];
-    LoD data_lod{slot_offset};
+    LoD data_lod{batch->offsets[i]};
     feed_vec_[i]->set_lod(data_lod);
     if (use_slots_is_dense_[i]) {
       if (inductive_shape_index_[i] != -1) {
@@ -974,6 +1122,20 @@ void MultiSlotInMemoryDataFeed::PutToFeedVec(
       feed_vec_[i]->Resize(framework::make_ddim(use_slots_shape_[i]));
     }
   }
+  ins_id_vec_.swap(batch->ins_ids);
+  ins_content_vec_.swap(batch->ins_contents);
+}
+
+// Next() assembles the batches ahead, this feeds a batch synchronously.
+void MultiSlotInMemoryDataFeed::PutToFeedVec(
+    const std::vector<Record>& ins_vec) {
+#ifdef _LINUX
+  PADDLE_ENFORCE(!next_batch_.valid(),
+                 "Cannot feed a batch while the next one is assembled.");
+  FeedBatch* batch = &batches_[cur_batch_];
+  BuildBatch(ins_vec, batch);
+  FeedBatchToVars(batch);
+  cur_batch_ = 1 - cur_batch_;
 #endif
 }
 
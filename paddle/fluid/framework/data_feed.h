@@ -30,6 +30,7 @@ limitations under the License. */
 #include <utility>
 #include <vector>
 
+#include "ThreadPool.h"
 #include "paddle/fluid/framework/archive.h"
 #include "paddle/fluid/framework/blocking_queue.h"
 #include "paddle/fluid/framework/channel.h"
@@ -547,16 +548,47 @@ class MultiSlotDataFeed
   virtual void PutToFeedVec(const std::vector<MultiSlotType>& ins_vec);
 };
 
+// The batches are assembled into two sets of tensors in turn, by a helper
+// thread: while the feed variables share the tensors of batch N, batch N + 1
+// is written into the other ones. The tensors keep their capacity, so a
+// batch needs neither temporary vectors nor allocations once the largest
+// batch has been seen.
 class MultiSlotInMemoryDataFeed : public InMemoryDataFeed<Record> {
  public:
   MultiSlotInMemoryDataFeed() {}
-  virtual ~MultiSlotInMemoryDataFeed() {}
+  virtual ~MultiSlotInMemoryDataFeed();
   virtual void Init(const DataFeedDesc& data_feed_desc);
+  virtual void AssignFeedVar(const Scope& scope);
+  virtual int Next();
 
  protected:
   virtual bool ParseOneInstance(Record* instance);
   virtual bool ParseOneInstanceFromPipe(Record* instance);
   virtual void PutToFeedVec(const std::vector<Record>& ins_vec);
+
+ private:
+  struct FeedBatch {
+    std::vector<Record> ins_vec;
+    // The data of every used slot on CPU, and its capacity in elements.
+    std::vector<LoDTensor> tensors;
+    std::vector<int64_t> capacities;
+    std::vector<std::vector<size_t>> offsets;
+    std::vector<std::string> ins_ids;
+    std::vector<std::string> ins_contents;
+  };
+
+  // Move up to a batch of instances from the output channel to the consume
+  // channel, and assemble them into batch. Return the batch size.
+  int AssembleBatch(FeedBatch* batch);
+  void BuildBatch(const std::vector<Record>& ins_vec, FeedBatch* batch);
+  void FeedBatchToVars(FeedBatch* batch);
+  // Forget the rows prefetched for the feed variables.
+  void UnregisterFeedVars();
+
+  FeedBatch batches_[2];
+  int cur_batch_{0};
+  std::unique_ptr<::ThreadPool> assemble_thread_;
+  std::future<int> next_batch_;
 };
 
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/framework/data_feed.h"
 #include <fcntl.h>
+#include <algorithm>
 #include <chrono>  // NOLINT
 #include <fstream>
 #include <iostream>
@@ -328,3 +329,106 @@ TEST(DataFeed, MultiSlotUnitTest) {
   // GetElemSetFromFile(&file_elem_set, data_feed_desc, filelist);
   // CheckIsUnorderedSame(reader_elem_set, file_elem_set);
 }
+
+// Instance i has i % 3 ids, the ones without any get a default 0, and one
+// value.
+static std::vector<int64_t> InstanceIds(int i) {
+  std::vector<int64_t> ids;
+  for (int k = 0; k < i % 3; ++k) {
+    ids.push_back(10 * i + k);
+  }
+  if (ids.empty()) {
+    ids.push_back(0);
+  }
+  return ids;
+}
+
+TEST(DataFeed, MultiSlotInMemoryNext) {
+  paddle::framework::DataFeedDesc data_feed_desc;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+      "name: \"MultiSlotInMemoryDataFeed\"\n"
+      "batch_size: 2\n"
+      "multi_slot_desc {\n"
+      "  slots { name: \"ids\" type: \"uint64\" is_dense: false "
+      "is_used: true }\n"
+      "  slots { name: \"values\" type: \"float\" is_dense: false "
+      "is_used: true }\n"
+      "}",
+      &data_feed_desc));
+  const int num_instances = 7;
+  std::vector<paddle::framework::Record> records(num_instances);
+  for (int i = 0; i < num_instances; ++i) {
+    paddle::framework::FeatureKey key;
+    for (int k = 0; k < i % 3; ++k) {
+      key.uint64_feasign_ = 10 * i + k;
+      records[i].uint64_feasigns_.emplace_back(key, 0);
+    }
+    key.float_feasign_ = i + 0.5f;
+    records[i].float_feasigns_.emplace_back(key, 1);
+  }
+
+  auto reader = paddle::framework::DataFeedFactory::CreateDataFeed(
+      "MultiSlotInMemoryDataFeed");
+  reader->Init(data_feed_desc);
+  auto input_channel =
+      paddle::framework::MakeChannel<paddle::framework::Record>();
+  auto output_channel =
+      paddle::framework::MakeChannel<paddle::framework::Record>();
+  auto consume_channel =
+      paddle::framework::MakeChannel<paddle::framework::Record>();
+  output_channel->Write(std::move(records));
+  reader->SetInputChannel(input_channel.get());
+  reader->SetOutputChannel(output_channel.get());
+  reader->SetConsumeChannel(consume_channel.get());
+  std::mutex filelist_mutex;
+  reader->SetFileListMutex(&filelist_mutex);
+  reader->SetFileList({});
+  paddle::framework::Scope scope;
+  auto* ids = scope.Var("ids")->GetMutable<paddle::framework::LoDTensor>();
+  auto* values =
+      scope.Var("values")->GetMutable<paddle::framework::LoDTensor>();
+  reader->AssignFeedVar(scope);
+  reader->Start();
+
+  // The batches are kept, like the feed variables of a pipeline scope, and
+  // must stay intact while the next batches are built.
+  std::vector<paddle::framework::LoDTensor> kept_ids;
+  std::vector<paddle::framework::LoDTensor> kept_values;
+  auto check_batch = [](const paddle::framework::LoDTensor& ids,
+                        const paddle::framework::LoDTensor& values,
+                        int first) {
+    int batch_size = static_cast<int>(values.numel());
+    ASSERT_EQ(ids.lod().size(), 1UL);
+    ASSERT_EQ(ids.lod()[0].size(), static_cast<size_t>(batch_size + 1));
+    size_t pos = 0;
+    for (int i = 0; i < batch_size; ++i) {
+      auto expected_ids = InstanceIds(first + i);
+      EXPECT_EQ(ids.lod()[0][i], pos);
+      for (auto id : expected_ids) {
+        EXPECT_EQ(ids.data<int64_t>()[pos++], id);
+      }
+      EXPECT_EQ(values.lod()[0][i], static_cast<size_t>(i));
+      EXPECT_EQ(values.data<float>()[i], first + i + 0.5f);
+    }
+    EXPECT_EQ(ids.lod()[0][batch_size], pos);
+    EXPECT_EQ(static_cast<size_t>(ids.numel()), pos);
+  };
+  int first = 0;
+  int batch_size = 0;
+  while ((batch_size = reader->Next()) > 0) {
+    EXPECT_EQ(batch_size, std::min(2, num_instances - first));
+    check_batch(*ids, *values, first);
+    kept_ids.emplace_back();
+    kept_ids.back().ShareDataWith(*ids);
+    kept_ids.back().set_lod(ids->lod());
+    kept_values.emplace_back();
+    kept_values.back().ShareDataWith(*values);
+    kept_values.back().set_lod(values->lod());
+    first += batch_size;
+  }
+  EXPECT_EQ(first, num_instances);
+  ASSERT_EQ(kept_ids.size(), 4UL);
+  for (size_t i = 0; i < kept_ids.size(); ++i) {
+    check_batch(kept_ids[i], kept_values[i], static_cast<int>(2 * i));
+  }
+}
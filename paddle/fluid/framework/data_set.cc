@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/framework/data_set.h"
 #include <algorithm>
+#include <functional>
+#include <numeric>
 #include <random>
 #include <unordered_map>
 #include "google/protobuf/io/zero_copy_stream_impl.h"
@@ -132,7 +134,7 @@ void DatasetImpl<T>::SetMergeByInsId(
 template <typename T>
 void DatasetImpl<T>::SetFeaEval(bool fea_eval, int record_candidate_size) {
   slots_shuffle_fea_eval_ = fea_eval;
-  slots_shuffle_rclist_.ReSize(record_candidate_size);
+  slots_shuffle_candidate_size_ = record_candidate_size;
   VLOG(3) << "SetFeaEval fea eval mode: " << fea_eval
           << " with record candidate size: " << record_candidate_size;
 }
@@ -635,6 +637,17 @@ int DatasetImpl<T>::ReceiveFromClient(int msg_type, int client_id,
 // explicit instantiation
 template class DatasetImpl<Record>;
 
+// Run func(i) for every i in [0, n), each on its own thread.
+static void ParallelFor(size_t n, const std::function<void(size_t)>& func) {
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < n; ++i) {
+    threads.push_back(std::thread(func, i));
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
 void MultiSlotDataset::MergeByInsId() {
   VLOG(3) << "MultiSlotDataset::MergeByInsId begin";
   if (!merge_by_insid_) {
@@ -661,26 +674,106 @@ void MultiSlotDataset::MergeByInsId() {
     }
   }
   CHECK(multi_output_channel_.size() != 0);  // NOLINT
-  auto channel_data = paddle::framework::MakeChannel<Record>();
-  VLOG(3) << "multi_output_channel_.size() " << multi_output_channel_.size();
-  for (size_t i = 0; i < multi_output_channel_.size(); ++i) {
+  // The records are hash partitioned by ins_id into as many partitions as
+  // output channels, so that all the records of an ins_id are in the same
+  // partition. Then every partition is sorted, merged and shuffled on its own
+  // thread, and becomes an output channel. The records are moved from stage
+  // to stage, never copied.
+  size_t partition_num = multi_output_channel_.size();
+  VLOG(3) << "multi_output_channel_.size() " << partition_num;
+  platform::Timer timeline;
+  timeline.Start();
+  // [output channel][partition]
+  std::vector<std::vector<std::vector<Record>>> parts(
+      partition_num, std::vector<std::vector<Record>>(partition_num));
+  ParallelFor(partition_num, [&](size_t i) {
     std::vector<Record> vec_data;
     multi_output_channel_[i]->Close();
     multi_output_channel_[i]->ReadAll(vec_data);
-    channel_data->Write(std::move(vec_data));
-    vec_data.clear();
-    vec_data.shrink_to_fit();
     multi_output_channel_[i]->Clear();
+    for (auto& rec : vec_data) {
+      size_t part =
+          XXH64(rec.ins_id_.data(), rec.ins_id_.length(), 0) % partition_num;
+      parts[i][part].push_back(std::move(rec));
+    }
+  });
+  timeline.Pause();
+  VLOG(2) << "MultiSlotDataset::MergeByInsId partition cost time="
+          << timeline.ElapsedSec() << " seconds";
+
+  // The time of every stage of every partition.
+  std::vector<double> sort_sec(partition_num);
+  std::vector<double> merge_sec(partition_num);
+  std::vector<double> shuffle_sec(partition_num);
+  std::vector<size_t> num_recs(partition_num);
+  std::vector<size_t> num_results(partition_num);
+  // Without PSLIB every thread's LocalRandomEngine starts from the same seed,
+  // so every partition is shuffled by an engine seeded from this thread.
+  auto fleet_ptr = FleetWrapper::GetInstance();
+  std::vector<std::default_random_engine::result_type> seeds(partition_num);
+  for (auto& seed : seeds) {
+    seed = fleet_ptr->LocalRandomEngine()();
   }
-  channel_data->Close();
-  std::vector<Record> recs;
-  recs.reserve(channel_data->Size());
-  channel_data->ReadAll(recs);
-  channel_data->Clear();
-  std::sort(recs.begin(), recs.end(), [](const Record& a, const Record& b) {
-    return a.ins_id_ < b.ins_id_;
+  timeline.Start();
+  ParallelFor(partition_num, [&](size_t part) {
+    platform::Timer stage;
+    stage.Start();
+    std::vector<Record> recs;
+    size_t size = 0;
+    for (size_t i = 0; i < partition_num; ++i) {
+      size += parts[i][part].size();
+    }
+    recs.reserve(size);
+    for (size_t i = 0; i < partition_num; ++i) {
+      recs.insert(recs.end(), std::make_move_iterator(parts[i][part].begin()),
+                  std::make_move_iterator(parts[i][part].end()));
+      std::vector<Record>().swap(parts[i][part]);
+    }
+    std::sort(recs.begin(), recs.end(), [](const Record& a, const Record& b) {
+      return a.ins_id_ < b.ins_id_;
+    });
+    stage.Pause();
+    sort_sec[part] = stage.ElapsedSec();
+    num_recs[part] = recs.size();
+
+    stage.Start();
+    std::vector<Record> results;
+    MergeSortedRecords(merge_slots, &recs, &results);
+    std::vector<Record>().swap(recs);
+    results.shrink_to_fit();
+    stage.Pause();
+    merge_sec[part] = stage.ElapsedSec();
+    num_results[part] = results.size();
+
+    stage.Start();
+    std::default_random_engine engine(seeds[part]);
+    std::shuffle(results.begin(), results.end(), engine);
+    multi_output_channel_[part]->Open();
+    multi_output_channel_[part]->Write(std::move(results));
+    stage.Pause();
+    shuffle_sec[part] = stage.ElapsedSec();
   });
+  timeline.Pause();
+  parts.clear();
+  // The slowest partition bounds every stage.
+  VLOG(2) << "MultiSlotDataset::MergeByInsId merge cost time="
+          << timeline.ElapsedSec() << " seconds, max sort time="
+          << *std::max_element(sort_sec.begin(), sort_sec.end())
+          << ", max merge time="
+          << *std::max_element(merge_sec.begin(), merge_sec.end())
+          << ", max shuffle time="
+          << *std::max_element(shuffle_sec.begin(), shuffle_sec.end());
+  VLOG(3) << "recs.size() "
+          << std::accumulate(num_recs.begin(), num_recs.end(), size_t(0))
+          << ", results size "
+          << std::accumulate(num_results.begin(), num_results.end(),
+                             size_t(0));
+  VLOG(3) << "MultiSlotDataset::MergeByInsId end";
+}
 
+void MultiSlotDataset::MergeSortedRecords(
+    const std::unordered_map<int, bool>& merge_slots,
+    std::vector<Record>* sorted_recs, std::vector<Record>* results) {
   auto sort_cmp_uint64 = [&merge_slots](const FeatureItem& a,
                                         const FeatureItem& b) {
     auto& a_sign = a.sign().uint64_feasign_;
@@ -714,8 +807,7 @@ void MultiSlotDataset::MergeByInsId() {
     return a_sign == b_sign && a.slot() == b.slot();
   };
 
-  std::vector<Record> results;
-  VLOG(3) << "recs.size() " << recs.size();
+  auto& recs = *sorted_recs;
   for (size_t i = 0; i < recs.size();) {
     size_t j = i + 1;
     while (j < recs.size() && recs[j].ins_id_ == recs[i].ins_id_) {
@@ -724,7 +816,7 @@ void MultiSlotDataset::MergeByInsId() {
     if (j - i < min_merge_size_) {
       if (keep_unmerged_ins_) {
         for (size_t k = i; k < j; ++k) {
-          results.push_back(std::move(recs[k]));
+          results->push_back(std::move(recs[k]));
         }
       }
       i = j;
@@ -806,64 +898,89 @@ void MultiSlotDataset::MergeByInsId() {
                                  not_merge_float_feasigns.begin(),
                                  not_merge_float_feasigns.end());
     }
-    results.push_back(rec);
+    results->push_back(std::move(rec));
   }
-  VLOG(3) << "results size " << results.size();
-  results.shrink_to_fit();
-
-  auto fleet_ptr = FleetWrapper::GetInstance();
-  std::shuffle(results.begin(), results.end(), fleet_ptr->LocalRandomEngine());
-  channel_data->Open();
-  channel_data->Write(std::move(results));
-  channel_data->Close();
-  results.clear();
-  results.shrink_to_fit();
-  VLOG(3) << "channel data size " << channel_data->Size();
-  channel_data->SetBlockSize(channel_data->Size() / channel_num_ + 1);
-  VLOG(3) << "channel data block size " << channel_data->BlockSize();
-  for (size_t i = 0; i < multi_output_channel_.size(); ++i) {
-    std::vector<Record> vec_data;
-    channel_data->Read(vec_data);
-    multi_output_channel_[i]->Open();
-    multi_output_channel_[i]->Write(std::move(vec_data));
-    vec_data.clear();
-    vec_data.shrink_to_fit();
-  }
-  CHECK(channel_data->Size() == 0);  // NOLINT
-  channel_data->Clear();
-  VLOG(3) << "MultiSlotDataset::MergeByInsId end";
 }
 
 void MultiSlotDataset::GetRandomData(const std::set<uint16_t>& slots_to_replace,
                                      std::vector<Record>* result) {
-  int debug_erase_cnt = 0;
-  int debug_push_cnt = 0;
-  auto multi_slot_desc = data_feed_desc_.multi_slot_desc();
-  slots_shuffle_rclist_.ReInit();
-  for (const auto& rec : slots_shuffle_original_data_) {
-    RecordCandidate rand_rec;
-    Record new_rec = rec;
-    slots_shuffle_rclist_.AddAndGet(rec, &rand_rec);
-    for (auto it = new_rec.uint64_feasigns_.begin();
-         it != new_rec.uint64_feasigns_.end();) {
-      if (slots_to_replace.find(it->slot()) != slots_to_replace.end()) {
-        it = new_rec.uint64_feasigns_.erase(it);
-        debug_erase_cnt += 1;
-      } else {
-        ++it;
-      }
+  // The replacing feasigns are drawn from one reservoir of at most
+  // slots_shuffle_candidate_size_ records, sampled uniformly from the whole
+  // original data. The reservoir is only read afterwards, so the original
+  // data is cut into as many contiguous partitions as channels, which draw
+  // from it on their own threads without locking.
+  size_t partition_num = std::max(channel_num_, 1);
+  size_t total = slots_shuffle_original_data_.size();
+  size_t candidate_num =
+      std::min(static_cast<size_t>(slots_shuffle_candidate_size_), total);
+  auto fleet_ptr = FleetWrapper::GetInstance();
+  std::vector<size_t> sample(candidate_num);
+  std::iota(sample.begin(), sample.end(), 0);
+  auto& engine = fleet_ptr->LocalRandomEngine();
+  for (size_t i = candidate_num; i < total; ++i) {
+    size_t index = engine() % (i + 1);
+    if (index < candidate_num) {
+      sample[index] = i;
+    }
+  }
+  std::vector<RecordCandidate> candidates(candidate_num);
+  size_t candidate_part_size =
+      (candidate_num + partition_num - 1) / partition_num;
+  ParallelFor(partition_num, [&](size_t part) {
+    size_t begin = std::min(candidate_num, part * candidate_part_size);
+    size_t end = std::min(candidate_num, begin + candidate_part_size);
+    for (size_t i = begin; i < end; ++i) {
+      candidates[i] = slots_shuffle_original_data_[sample[i]];
     }
-    for (auto slot : slots_to_replace) {
-      auto range = rand_rec.feas.equal_range(slot);
-      for (auto it = range.first; it != range.second; ++it) {
-        new_rec.uint64_feasigns_.push_back({it->second, it->first});
-        debug_push_cnt += 1;
+  });
+  std::vector<size_t>().swap(sample);
+  // Each partition draws from its own engine seeded here, as in MergeByInsId.
+  std::vector<std::default_random_engine::result_type> seeds(partition_num);
+  for (auto& seed : seeds) {
+    seed = engine();
+  }
+
+  size_t partition_size = (total + partition_num - 1) / partition_num;
+  std::vector<std::vector<Record>> parts(partition_num);
+  std::vector<int64_t> erase_cnt(partition_num, 0);
+  std::vector<int64_t> push_cnt(partition_num, 0);
+  ParallelFor(partition_num, [&](size_t part) {
+    size_t begin = std::min(total, part * partition_size);
+    size_t end = std::min(total, begin + partition_size);
+    std::default_random_engine local_engine(seeds[part]);
+    parts[part].reserve(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+      const auto& rand_rec = candidates[local_engine() % candidate_num];
+      Record new_rec = slots_shuffle_original_data_[i];
+      for (auto it = new_rec.uint64_feasigns_.begin();
+           it != new_rec.uint64_feasigns_.end();) {
+        if (slots_to_replace.find(it->slot()) != slots_to_replace.end()) {
+          it = new_rec.uint64_feasigns_.erase(it);
+          erase_cnt[part] += 1;
+        } else {
+          ++it;
+        }
       }
+      for (auto slot : slots_to_replace) {
+        auto range = rand_rec.feas.equal_range(slot);
+        for (auto it = range.first; it != range.second; ++it) {
+          new_rec.uint64_feasigns_.push_back({it->second, it->first});
+          push_cnt[part] += 1;
+        }
+      }
+      parts[part].push_back(std::move(new_rec));
     }
-    result->push_back(std::move(new_rec));
+  });
+  result->reserve(result->size() + total);
+  for (auto& part : parts) {
+    result->insert(result->end(), std::make_move_iterator(part.begin()),
+                   std::make_move_iterator(part.end()));
+    std::vector<Record>().swap(part);
   }
-  VLOG(2) << "erase feasign num: " << debug_erase_cnt
-          << " repush feasign num: " << debug_push_cnt;
+  VLOG(2) << "erase feasign num: "
+          << std::accumulate(erase_cnt.begin(), erase_cnt.end(), int64_t(0))
+          << " repush feasign num: "
+          << std::accumulate(push_cnt.begin(), push_cnt.end(), int64_t(0));
 }
 
 // slots shuffle to input_channel_ with needed-shuffle slots
@@ -887,6 +1004,8 @@ void MultiSlotDataset::SlotsShuffle(
                "fea eval mode off, need to set on for slots shuffle";
     return;
   }
+  CHECK(slots_shuffle_candidate_size_ > 0)
+      << "SetFeaEval must set a record_candidate_size > 0 first";
   if ((!input_channel_ || input_channel_->Size() == 0) &&
       slots_shuffle_original_data_.size() == 0 && out_channel_size == 0) {
     VLOG(3) << "DatasetImpl<T>::SlotsShuffle() end, no data to slots shuffle";
@@ -980,6 +1099,11 @@ void MultiSlotDataset::SlotsShuffle(
   }
   CHECK(input_channel_->Size() == 0)
       << "input channel should be empty before slots shuffle";
+  timeline.Pause();
+  double gather_sec = timeline.ElapsedSec();
+  VLOG(2) << "DatasetImpl<T>::SlotsShuffle() gather original data cost time="
+          << gather_sec << " seconds";
+  timeline.Resume();
   std::vector<Record> random_data;
   random_data.clear();
   // get slots shuffled random_data
@@ -993,7 +1117,9 @@ void MultiSlotDataset::SlotsShuffle(
   timeline.Pause();
   VLOG(2) << "DatasetImpl<T>::SlotsShuffle() end"
           << ", memory data size for slots shuffle=" << input_channel_->Size()
-          << ", cost time=" << timeline.ElapsedSec() << " seconds";
+          << ", cost time=" << timeline.ElapsedSec()
+          << " seconds, slots replace cost time="
+          << timeline.ElapsedSec() - gather_sec << " seconds";
 }
 
 }  // end namespace framework
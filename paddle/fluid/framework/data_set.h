@@ -20,6 +20,7 @@
 #include <set>
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -204,7 +205,7 @@ class DatasetImpl : public Dataset {
   // so if cur_channel=0, all data are in output_channel, else consume_channel
   int cur_channel_;
   std::vector<T> slots_shuffle_original_data_;
-  RecordCandidateList slots_shuffle_rclist_;
+  int slots_shuffle_candidate_size_ = 0;
   int thread_num_;
   paddle::framework::DataFeedDesc data_feed_desc_;
   int trainer_num_;
@@ -238,6 +239,13 @@ class MultiSlotDataset : public DatasetImpl<Record> {
   virtual void GetRandomData(const std::set<uint16_t>& slots_to_replace,
                              std::vector<Record>* result);
   virtual ~MultiSlotDataset() {}
+
+ protected:
+  // Merge the records of sorted_recs, sorted by ins_id, into one record per
+  // ins_id and append them to results.
+  void MergeSortedRecords(const std::unordered_map<int, bool>& merge_slots,
+                          std::vector<Record>* sorted_recs,
+                          std::vector<Record>* results);
 };
 
 }  // end namespace framework
@@ -0,0 +1,140 @@
+//   Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/data_set.h"
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+// Exposes the output channels, so that the records can be put into and taken
+// out of them without readers.
+class TestMultiSlotDataset : public MultiSlotDataset {
+ public:
+  std::vector<Channel<Record>>& OutputChannels() {
+    return multi_output_channel_;
+  }
+};
+
+static std::vector<Record> ReadAllRecords(std::vector<Channel<Record>>* chans) {
+  std::vector<Record> all;
+  for (auto& chan : *chans) {
+    std::vector<Record> recs;
+    chan->Close();
+    chan->ReadAll(recs);
+    all.insert(all.end(), recs.begin(), recs.end());
+    chan->Clear();
+  }
+  return all;
+}
+
+static std::multiset<uint64_t> SlotFeasigns(const Record& rec, uint16_t slot) {
+  std::multiset<uint64_t> feasigns;
+  for (auto& fea : rec.uint64_feasigns_) {
+    if (fea.slot() == slot) {
+      feasigns.insert(fea.sign().uint64_feasign_);
+    }
+  }
+  return feasigns;
+}
+
+TEST(DataSet, MergeByInsIdAndSlotsShuffle) {
+  const int channel_num = 2;
+  const int ins_num = 4;
+  TestMultiSlotDataset dataset;
+  dataset.SetDataFeedDesc(
+      "name: \"MultiSlotInMemoryDataFeed\"\n"
+      "batch_size: 2\n"
+      "multi_slot_desc {\n"
+      "  slots { name: \"merged\" type: \"uint64\" is_dense: false "
+      "is_used: true }\n"
+      "  slots { name: \"kept\" type: \"uint64\" is_dense: false "
+      "is_used: true }\n"
+      "}");
+  dataset.SetChannelNum(channel_num);
+  dataset.SetMergeByInsId({"merged"}, false, 2, true);
+  dataset.CreateChannel();
+
+  // Instances 0 and 1 are in both channels, instance 2 only in channel 0 and
+  // instance 3 only in channel 1. Slot 0 differs between the copies of an
+  // instance, slot 1 does not.
+  std::vector<std::vector<Record>> inputs(channel_num);
+  for (int i = 0; i < ins_num; ++i) {
+    for (int c = 0; c < channel_num; ++c) {
+      if ((i == 2 && c == 1) || (i == 3 && c == 0)) {
+        continue;
+      }
+      Record rec;
+      rec.ins_id_ = "ins" + std::to_string(i);
+      FeatureKey key;
+      key.uint64_feasign_ = 100 * i + c;
+      rec.uint64_feasigns_.emplace_back(key, 0);
+      key.uint64_feasign_ = 1000 + i;
+      rec.uint64_feasigns_.emplace_back(key, 1);
+      inputs[c].push_back(rec);
+    }
+  }
+  auto& chans = dataset.OutputChannels();
+  ASSERT_EQ(chans.size(), static_cast<size_t>(channel_num));
+  for (int c = 0; c < channel_num; ++c) {
+    chans[c]->Open();
+    chans[c]->Write(std::move(inputs[c]));
+  }
+
+  dataset.MergeByInsId();
+
+  std::map<std::string, std::multiset<uint64_t>> expected_merged = {
+      {"ins0", {0, 1}}, {"ins1", {100, 101}}, {"ins2", {200}}, {"ins3", {300}}};
+  std::vector<Record> merged = ReadAllRecords(&chans);
+  ASSERT_EQ(merged.size(), static_cast<size_t>(ins_num));
+  std::set<std::string> ins_ids;
+  for (auto& rec : merged) {
+    ins_ids.insert(rec.ins_id_);
+    ASSERT_EQ(expected_merged.count(rec.ins_id_), 1UL);
+    EXPECT_EQ(SlotFeasigns(rec, 0), expected_merged[rec.ins_id_]);
+    int i = std::stoi(rec.ins_id_.substr(3));
+    EXPECT_EQ(SlotFeasigns(rec, 1), std::multiset<uint64_t>({1000UL + i}));
+  }
+  EXPECT_EQ(ins_ids.size(), static_cast<size_t>(ins_num));
+
+  // Put the merged records back and replace slot 0 of every one of them by
+  // slot 0 of a record of the original data.
+  chans[0]->Open();
+  chans[0]->Write(std::move(merged));
+  dataset.SetFeaEval(true, 3);
+  dataset.SlotsShuffle({"merged"});
+
+  auto input_channel = dataset.GetInputChannel();
+  std::vector<Record> shuffled;
+  input_channel->ReadAll(shuffled);
+  ASSERT_EQ(shuffled.size(), static_cast<size_t>(ins_num));
+  for (auto& rec : shuffled) {
+    ASSERT_EQ(expected_merged.count(rec.ins_id_), 1UL);
+    int i = std::stoi(rec.ins_id_.substr(3));
+    EXPECT_EQ(SlotFeasigns(rec, 1), std::multiset<uint64_t>({1000UL + i}));
+    bool from_original = false;
+    for (auto& kv : expected_merged) {
+      from_original |= SlotFeasigns(rec, 0) == kv.second;
+    }
+    EXPECT_TRUE(from_original);
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -31,6 +31,7 @@ class COWPtr {
  public:
   COWPtr() : m_sp(nullptr) {}
   explicit COWPtr(T* t) : m_sp(t) {}
+  explicit COWPtr(const RefPtr& sp) : m_sp(sp) {}
 
   const T& Data() const { return *m_sp; }
 
@@ -40,6 +40,11 @@ struct ExecutionStrategy {
   // only use with async_ssa_graph_executor
   // and pyreader with data queue
   size_t num_iteration_per_run_{1};
+  // Only used by the kExperimental executor with more than one thread. The
+  // ready operators are run in the order of the measured run time of the
+  // longest path from them to the end of the graph, so that the operators on
+  // the critical path start first.
+  bool use_critical_path_priority_{false};
 };
 
 }  //  namespace details
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include "paddle/fluid/framework/details/fast_threaded_ssa_graph_executor.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <deque>
 #include <memory>
 #include <string>
@@ -48,6 +50,11 @@ FastThreadedSSAGraphExecutor::FastThreadedSSAGraphExecutor(
     }
   }
   PADDLE_ENFORCE_GT(op_deps_.size(), 0, "The graph doesn't have operators.");
+  use_op_priority_ =
+      strategy_.use_critical_path_priority_ && strategy_.num_threads_ > 1;
+  if (use_op_priority_) {
+    PrepareCriticalPath();
+  }
   PrepareAtomicOpDeps();
 }
 
@@ -83,6 +90,7 @@ FeedFetchList FastThreadedSSAGraphExecutor::Run(
       ExecutionFinal(&fetch_ops);
     }
   } else {
+    auto start = std::chrono::steady_clock::now();
     traced_ops_.clear();
     remaining_ = 0;
     auto complete_q = std::make_shared<BlockingQueue<size_t>>();
@@ -113,6 +121,23 @@ FeedFetchList FastThreadedSSAGraphExecutor::Run(
       }
       num_complete += num_comp;
     }
+    if (use_op_priority_) {
+      double makespan = std::chrono::duration<double, std::micro>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+      // The first timed iteration replaces the unit costs, later ones are
+      // smoothed in to follow slow changes without chasing noise.
+      const double decay = num_timed_runs_ == 0 ? 0.0 : 0.8;
+      for (size_t i = 0; i < op_cost_.size(); ++i) {
+        op_cost_[i] = decay * op_cost_[i] + (1 - decay) * op_elapsed_[i];
+      }
+      UpdateOpPriorities();
+      ++num_timed_runs_;
+      VLOG(3) << "Iteration " << num_timed_runs_ << " makespan " << makespan
+              << " us, critical path "
+              << *std::max_element(op_priority_.begin(), op_priority_.end())
+              << " us";
+    }
   }
   // Wait FetchOps.
   ClearFetchOp(graph_, &fetch_ops);
@@ -171,7 +196,18 @@ void FastThreadedSSAGraphExecutor::InsertFetchOps(
 bool FastThreadedSSAGraphExecutor::RunOp(
     OpHandleBase *op, const std::shared_ptr<BlockingQueue<size_t>> &complete_q,
     size_t *complete) {
-  RunOpSync(op);
+  if (use_op_priority_) {
+    auto start = std::chrono::steady_clock::now();
+    RunOpSync(op);
+    auto it = op_index_.find(op);
+    if (it != op_index_.end()) {
+      op_elapsed_[it->second] = std::chrono::duration<double, std::micro>(
+                                    std::chrono::steady_clock::now() - start)
+                                    .count();
+    }
+  } else {
+    RunOpSync(op);
+  }
   if (LIKELY(!exception_.IsCaught())) {
     if (LIKELY(!strategy_.dry_run_)) {
       RecordOps(op);
@@ -190,9 +226,21 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
     OpHandleBase *op,
     const std::shared_ptr<BlockingQueue<size_t>> &complete_q) {
   ++remaining_;
+  if (use_op_priority_) {
+    std::lock_guard<std::mutex> guard(ready_ops_mutex_);
+    ready_ops_.emplace(OpPriority(op), op);
+  }
   this->pool_.enqueue([=] {
     std::deque<OpHandleBase *> op_queue;
-    op_queue.push_front(op);
+    if (use_op_priority_) {
+      // Every task pushes one ready operator, and runs the one that is the
+      // most urgent when the task starts.
+      std::lock_guard<std::mutex> guard(ready_ops_mutex_);
+      op_queue.push_front(ready_ops_.top().second);
+      ready_ops_.pop();
+    } else {
+      op_queue.push_front(op);
+    }
 
     size_t complete = 0;
     while (!op_queue.empty()) {
@@ -217,6 +265,10 @@ void FastThreadedSSAGraphExecutor::RunOpAsync(
           } else {
             if (op_to_run == nullptr) {
               op_to_run = pending_op;
+            } else if (use_op_priority_ &&
+                       OpPriority(pending_op) > OpPriority(op_to_run)) {
+              RunOpAsync(op_deps, op_to_run, complete_q);
+              op_to_run = pending_op;
             } else {
               RunOpAsync(op_deps, pending_op, complete_q);
             }
@@ -244,6 +296,83 @@ void FastThreadedSSAGraphExecutor::PrepareAtomicOpDeps() {
   });
 }
 
+void FastThreadedSSAGraphExecutor::PrepareCriticalPath() {
+  std::vector<OpHandleBase *> ops;
+  for (auto &pair : op_deps_) {
+    op_index_.emplace(pair.first, ops.size());
+    ops.emplace_back(pair.first);
+  }
+  op_successors_.resize(ops.size());
+  std::vector<int> num_preceding(ops.size(), 0);
+  for (size_t i = 0; i < ops.size(); ++i) {
+    std::unordered_set<size_t> visited;
+    for (auto &output : ops[i]->Outputs()) {
+      for (auto &pending_op : output->PendingOps()) {
+        auto it = op_index_.find(pending_op);
+        if (it != op_index_.end() && visited.insert(it->second).second) {
+          op_successors_[i].emplace_back(it->second);
+          ++num_preceding[it->second];
+        }
+      }
+    }
+  }
+
+  std::deque<size_t> ready;
+  for (size_t i = 0; i < ops.size(); ++i) {
+    if (num_preceding[i] == 0) ready.emplace_back(i);
+  }
+  std::vector<size_t> order;
+  order.reserve(ops.size());
+  while (!ready.empty()) {
+    size_t i = ready.front();
+    ready.pop_front();
+    order.emplace_back(i);
+    for (size_t succ : op_successors_[i]) {
+      if (--num_preceding[succ] == 0) ready.emplace_back(succ);
+    }
+  }
+  PADDLE_ENFORCE_EQ(order.size(), ops.size(), "The graph has cycles.");
+
+  // Renumber the operators in topological order, so that the priorities can
+  // be computed in one backward pass.
+  std::vector<size_t> new_index(ops.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    new_index[order[i]] = i;
+  }
+  std::vector<std::vector<size_t>> successors(ops.size());
+  for (size_t i = 0; i < ops.size(); ++i) {
+    for (size_t succ : op_successors_[i]) {
+      successors[new_index[i]].emplace_back(new_index[succ]);
+    }
+    op_index_[ops[i]] = new_index[i];
+  }
+  op_successors_.swap(successors);
+
+  // Before the first iteration is timed, every operator costs one, so the
+  // operators with the most operators behind them go first.
+  op_cost_.assign(ops.size(), 1.0);
+  op_elapsed_.assign(ops.size(), 0.0);
+  op_priority_.assign(ops.size(), 0.0);
+  UpdateOpPriorities();
+}
+
+void FastThreadedSSAGraphExecutor::UpdateOpPriorities() {
+  for (size_t i = op_priority_.size(); i > 0; --i) {
+    double longest_tail = 0;
+    for (size_t succ : op_successors_[i - 1]) {
+      longest_tail = std::max(longest_tail, op_priority_[succ]);
+    }
+    op_priority_[i - 1] = op_cost_[i - 1] + longest_tail;
+  }
+}
+
+double FastThreadedSSAGraphExecutor::OpPriority(OpHandleBase *op) const {
+  // The fetch operators are created in each iteration, they are the last
+  // ones on their paths.
+  auto it = op_index_.find(op);
+  return it == op_index_.end() ? 0 : op_priority_[it->second];
+}
+
 const ir::Graph &FastThreadedSSAGraphExecutor::Graph() const { return *graph_; }
 
 void FastThreadedSSAGraphExecutor::RecordOps(OpHandleBase *op) {
@@ -15,8 +15,11 @@
 #pragma once
 #include <ThreadPool.h>
 #include <memory>
+#include <mutex>  // NOLINT
+#include <queue>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include "paddle/fluid/framework/blocking_queue.h"
 #include "paddle/fluid/framework/details/exception_holder.h"
@@ -64,6 +67,21 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
 
   std::vector<OpHandleBase *> traced_ops_;
 
+  // For ExecutionStrategy::use_critical_path_priority_. The index of the
+  // operators in topological order, the operators waiting for each of them,
+  // their run time in microseconds smoothed over the iterations, and their
+  // priority, which is the run time of the longest path from them to the end.
+  bool use_op_priority_{false};
+  size_t num_timed_runs_{0};
+  std::unordered_map<OpHandleBase *, size_t> op_index_;
+  std::vector<std::vector<size_t>> op_successors_;
+  std::vector<double> op_cost_;
+  std::vector<double> op_elapsed_;
+  std::vector<double> op_priority_;
+  // The ready operators, the one with the highest priority on the top.
+  std::priority_queue<std::pair<double, OpHandleBase *>> ready_ops_;
+  std::mutex ready_ops_mutex_;
+
   bool RunOp(OpHandleBase *op,
              const std::shared_ptr<BlockingQueue<size_t>> &complete_q,
              size_t *complete);
@@ -74,6 +92,12 @@ class FastThreadedSSAGraphExecutor : public SSAGraphExecutor {
 
   void PrepareAtomicOpDeps();
 
+  void PrepareCriticalPath();
+
+  void UpdateOpPriorities();
+
+  double OpPriority(OpHandleBase *op) const;
+
   inline void RecordOps(OpHandleBase *op);
 
   inline void ExecutionFinal(std::vector<OpHandleBase *> *fetch_ops);
@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 
 #include <atomic>
+#include <condition_variable>  // NOLINT
 #include <fstream>
 #include <map>
 #include <memory>
@@ -26,12 +27,13 @@ limitations under the License. */
 #include "paddle/fluid/framework/data_feed.h"
 #include "paddle/fluid/framework/fleet/fleet_wrapper.h"
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/mpmc_queue.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/framework/trainer_desc.pb.h"
 #include "paddle/fluid/framework/variable_helper.h"
-#include "paddle/fluid/operators/reader/blocking_queue.h"
+#include "paddle/fluid/framework/worker_metrics.h"
 #include "paddle/fluid/platform/place.h"
 #include "paddle/fluid/platform/port.h"
 #include "paddle/fluid/platform/timer.h"
@@ -116,6 +118,9 @@ class DeviceWorker {
   virtual void SetDataFeed(DataFeed* data_feed);
   virtual void SetNeedDump(bool need_dump_field) {}
   virtual void SetChannelWriter(ChannelObject<std::string>* queue) {}
+  // Create the thread scope under scope, a kid of the root scope holding
+  // replicas of some parameters, instead of under the root scope.
+  virtual void SetReplicaScope(Scope* scope) {}
   virtual void SetPlace(const paddle::platform::Place& place) {
     place_ = place;
   }
@@ -123,6 +128,8 @@ class DeviceWorker {
     device_reader_->SetPlace(place);
   }
   virtual Scope* GetThreadScope() { return thread_scope_; }
+  // The stage counters kept by TrainFiles, readable from any thread.
+  const WorkerMetrics& GetMetrics() const { return metrics_; }
 
  protected:
   Scope* root_scope_ = nullptr;
@@ -132,6 +139,7 @@ class DeviceWorker {
   int64_t batch_num_;
   FetchConfig fetch_config_;
   bool use_cvm_;
+  WorkerMetrics metrics_;
 };
 
 class CPUWorkerBase : public DeviceWorker {
@@ -163,6 +171,7 @@ class HogwildWorker : public CPUWorkerBase {
   virtual void PrintFetchVars();
   virtual void CreateDeviceResource(const ProgramDesc& main_prog);
   virtual void BindingDataFeedMemory();
+  virtual void SetReplicaScope(Scope* scope) { replica_scope_ = scope; }
   template <typename T>
   void SetZero(LoDTensor* tensor, LoDTensor* root_tensor, int tensor_dim);
 
@@ -175,6 +184,7 @@ class HogwildWorker : public CPUWorkerBase {
   HogwildWorkerParameter param_;
   std::vector<std::string> skip_ops_;
   std::map<std::string, int> stat_var_name_map_;
+  Scope* replica_scope_ = nullptr;
 };
 
 class DownpourWorker : public HogwildWorker {
@@ -233,7 +243,43 @@ class DownpourWorker : public HogwildWorker {
 };
 
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
-using ScopeQueue = operators::reader::BlockingQueue<Scope*>;
+using ScopeQueue = MPMCQueue<Scope*>;
+
+// The counters of a section of a pipeline, shared by its workers. The times
+// are in us.
+struct SectionStats {
+  std::atomic<int64_t> num_batches{0};
+  // Running the ops of the section.
+  std::atomic<int64_t> busy_us{0};
+  // Waiting for a scope from the previous section, and for room in the queue
+  // to the next one.
+  std::atomic<int64_t> in_wait_us{0};
+  std::atomic<int64_t> out_wait_us{0};
+};
+
+// Caps the number of the workers of a section running a batch at the same
+// time. The PipelineTrainer moves the permits between sections.
+class SectionThrottle {
+ public:
+  explicit SectionThrottle(int permits) : permits_(permits) {}
+
+  // Block until the worker may run a batch, return false when the section
+  // is finished.
+  bool Acquire();
+  void Release();
+  // Wake the waiting workers, their section is finished.
+  void Close();
+
+  void SetPermits(int permits);
+  int Permits() const;
+
+ private:
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  int permits_;
+  int running_{0};
+  bool closed_{false};
+};
 
 class SyncFunctor {
  public:
@@ -300,6 +346,10 @@ class SectionWorker : public DeviceWorker {
   void SetNextSectionPlace(const paddle::platform::Place& place) {
     next_section_place_ = place;
   }
+  void SetSectionStats(SectionStats* stats) { stats_ = stats; }
+  // The workers of a throttled section are not bound to CPUs, the ones
+  // running change.
+  void SetSectionThrottle(SectionThrottle* throttle) { throttle_ = throttle; }
   SyncFunctor* sync_func_ = nullptr;
   void SetSyncFunctor(SyncFunctor* sync_func) { sync_func_ = sync_func; }
 
@@ -307,6 +357,11 @@ class SectionWorker : public DeviceWorker {
 
  protected:
   void AutoSetCPUAffinity(bool reuse);
+  // Wait for a permit and a scope from the previous section.
+  bool ReceiveScope(Scope** scope);
+  // Pass scope to the next section.
+  void SendScope(Scope* scope);
+
   int section_id_;
   int pipeline_id_;
   int section_num_;
@@ -321,6 +376,9 @@ class SectionWorker : public DeviceWorker {
   std::mutex* worker_count_mutex_ = nullptr;
   int* worker_count_ = nullptr;
   paddle::platform::Place next_section_place_;
+  SectionStats* stats_ = nullptr;
+  SectionThrottle* throttle_ = nullptr;
+  uint64_t run_start_ns_ = 0;
 
   std::vector<std::unique_ptr<OperatorBase>> ops_;
 
@@ -66,6 +66,10 @@ void DistMultiTrainer::Initialize(const TrainerDesc &trainer_desc,
   pull_dense_worker_->Initialize(trainer_desc);
   VLOG(3) << "initialize pull dense worker";
   SetDebug(trainer_desc.debug());
+  if (!trainer_desc.metrics_path().empty()) {
+    SetMetricsFile(trainer_desc.metrics_path(),
+                   trainer_desc.metrics_interval_ms());
+  }
 }
 
 void DistMultiTrainer::DumpWork() {
@@ -128,12 +132,14 @@ void DistMultiTrainer::Run() {
                                      workers_[thidx].get()));
     }
   }
+  StartMetricsReporter();
 }
 
 void DistMultiTrainer::Finalize() {
   for (auto &th : threads_) {
     th.join();
   }
+  StopMetricsReporter();
   for (int i = 0; i < need_merge_var_names_.size(); i++) {
     Variable *root_var = root_scope_->FindVar(need_merge_var_names_[i]);
     if (root_var == nullptr) {
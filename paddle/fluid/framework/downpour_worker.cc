@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/device_worker.h"
 #include "paddle/fluid/framework/device_worker_factory.h"
 #include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/device_tracer.h"
 #include "paddle/fluid/string/string_helper.h"
 
 #if defined _WIN32 || defined __APPLE__
@@ -614,7 +615,9 @@ void DownpourWorker::TrainFiles() {
   device_reader_->Start();
   int batch_cnt = 0;
   int cur_batch;
+  int64_t read_start = platform::PosixInNsec();
   while ((cur_batch = device_reader_->Next()) > 0) {
+    metrics_.AddReadWait(platform::PosixInNsec() - read_start);
     // pull sparse here
     for (int i = 0; i < param_.program_config(0).pull_sparse_table_id_size();
          ++i) {
@@ -627,9 +630,11 @@ void DownpourWorker::TrainFiles() {
           break;
         }
       }
+      int64_t pull_start = platform::PosixInNsec();
       fleet_ptr_->PullSparseVarsSync(*thread_scope_, tid,
                                      sparse_key_names_[tid], &features_[tid],
                                      &feature_values_[tid], table.fea_dim());
+      metrics_.AddCommWait(platform::PosixInNsec() - pull_start);
       CollectLabelInfo(i);
       FillSparseValue(i);
       auto nid_iter = std::find(sparse_value_names_[tid].begin(),
@@ -642,16 +647,23 @@ void DownpourWorker::TrainFiles() {
     VLOG(3) << "fill sparse value for all sparse table done.";
 
     // do computation here
-    for (auto& op : ops_) {
+    int64_t op_start = platform::PosixInNsec();
+    for (size_t i = 0; i < ops_.size(); ++i) {
       bool need_skip = false;
       for (auto t = 0u; t < skip_ops_.size(); ++t) {
-        if (op->Type().find(skip_ops_[t]) != std::string::npos) {
+        if (ops_[i]->Type().find(skip_ops_[t]) != std::string::npos) {
           need_skip = true;
           break;
         }
       }
       if (!need_skip) {
-        op->Run(*thread_scope_, place_);
+        ops_[i]->Run(*thread_scope_, place_);
+        int64_t op_end = platform::PosixInNsec();
+        metrics_.AddOpTime(i, op_end - op_start);
+        op_start = op_end;
+      } else {
+        // The skip check is not charged to the next op.
+        op_start = platform::PosixInNsec();
       }
     }
 
@@ -694,9 +706,11 @@ void DownpourWorker::TrainFiles() {
           static_cast<uint32_t>(tmp_push_dense_wait_times);
 
       if (push_dense_status_.size() >= push_dense_wait_times) {
+        int64_t wait_start = platform::PosixInNsec();
         for (auto& t : push_dense_status_) {
           t.wait();
         }
+        metrics_.AddCommWait(platform::PosixInNsec() - wait_start);
         push_dense_status_.resize(0);
       }
 
@@ -711,9 +725,11 @@ void DownpourWorker::TrainFiles() {
       static uint32_t push_sparse_wait_times =
           static_cast<uint32_t>(tmp_push_sparse_wait_times);
       if (push_sparse_status_.size() >= push_sparse_wait_times) {
+        int64_t wait_start = platform::PosixInNsec();
         for (auto& t : push_sparse_status_) {
           t.wait();
         }
+        metrics_.AddCommWait(platform::PosixInNsec() - wait_start);
         push_sparse_status_.resize(0);
       }
 
@@ -769,9 +785,12 @@ void DownpourWorker::TrainFiles() {
       }
     }
 
+    metrics_.AddBatch(cur_batch);
+
     PrintFetchVars();
     thread_scope_->DropKids();
     ++batch_cnt;
+    read_start = platform::PosixInNsec();
   }
   if (need_dump_field_) {
     writer_.Flush();
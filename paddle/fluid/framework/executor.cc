@@ -507,5 +507,50 @@ void Executor::EnableMKLDNN(const ProgramDesc& program) {
       << "'MKLDNN' is not supported, Please re-compile with WITH_MKLDNN option";
 #endif
 }
+void ExecutorPrepareContextCache::Release::operator()(
+    ExecutorPrepareContext* ctx) const {
+  std::lock_guard<std::mutex> guard(cache->mutex_);
+  cache->entries_[entry].idle.emplace_back(ctx);
+}
+
+ExecutorPrepareContextCache::ContextPtr ExecutorPrepareContextCache::Acquire(
+    Executor* executor, const ProgramDesc& program, int block_id,
+    const std::vector<std::string>& skip_ref_cnt_vars, bool force_disable_gc) {
+  size_t entry = 0;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (; entry < entries_.size(); ++entry) {
+      auto& e = entries_[entry];
+      if (e.program == &program && e.block_id == block_id &&
+          e.force_disable_gc == force_disable_gc &&
+          e.skip_ref_cnt_vars == skip_ref_cnt_vars) {
+        break;
+      }
+    }
+    if (entry == entries_.size()) {
+      entries_.push_back(
+          Entry{&program, block_id, skip_ref_cnt_vars, force_disable_gc, {}});
+    }
+    auto& idle = entries_[entry].idle;
+    if (!idle.empty()) {
+      ExecutorPrepareContext* ctx = idle.back().release();
+      idle.pop_back();
+      size_t hits = ++hit_count_;
+      VLOG(3) << "Reuse prepared context of block " << block_id << ", hit "
+              << hits << " of " << hits + miss_count_ << " runs";
+      return ContextPtr(ctx, Release{this, entry});
+    }
+  }
+
+  platform::RecordEvent record_event("PrepareSubBlock");
+  size_t misses = ++miss_count_;
+  VLOG(3) << "Prepare context of block " << block_id << ", hit " << hit_count_
+          << " of " << hit_count_ + misses << " runs";
+  if (FLAGS_use_mkldnn) executor->EnableMKLDNN(program);
+  auto ctx = Executor::Prepare(program, block_id, skip_ref_cnt_vars,
+                               force_disable_gc);
+  return ContextPtr(ctx.release(), Release{this, entry});
+}
+
 }  // namespace framework
 }  // namespace paddle
@@ -14,8 +14,10 @@ limitations under the License. */
 
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -126,5 +128,53 @@ class Executor {
   const platform::Place place_;
 };
 
+/*
+ * Keeps the prepared contexts of a sub-block, so that the control flow
+ * operators running the same block again and again (while, conditional_block)
+ * do not create its operators and redo the garbage collection preparation on
+ * every run. The contexts are keyed by program, block and the variables that
+ * skip eager deletion. A context is lent to one run at a time, concurrent runs
+ * of the same block prepare contexts of their own.
+ */
+class ExecutorPrepareContextCache {
+ public:
+  struct Release {
+    void operator()(ExecutorPrepareContext* ctx) const;
+    ExecutorPrepareContextCache* cache;
+    size_t entry;
+  };
+  using ContextPtr = std::unique_ptr<ExecutorPrepareContext, Release>;
+
+  ExecutorPrepareContextCache() = default;
+  ExecutorPrepareContextCache(const ExecutorPrepareContextCache&) = delete;
+  ExecutorPrepareContextCache& operator=(const ExecutorPrepareContextCache&) =
+      delete;
+
+  // Return an idle context of the block, or prepare a new one with executor.
+  // The context returns to the cache when the pointer is destroyed.
+  ContextPtr Acquire(Executor* executor, const ProgramDesc& program,
+                     int block_id,
+                     const std::vector<std::string>& skip_ref_cnt_vars =
+                         std::vector<std::string>(),
+                     bool force_disable_gc = false);
+
+  size_t HitCount() const { return hit_count_; }
+  size_t MissCount() const { return miss_count_; }
+
+ private:
+  struct Entry {
+    const ProgramDesc* program;
+    int block_id;
+    std::vector<std::string> skip_ref_cnt_vars;
+    bool force_disable_gc;
+    std::vector<std::unique_ptr<ExecutorPrepareContext>> idle;
+  };
+
+  std::mutex mutex_;
+  std::vector<Entry> entries_;
+  std::atomic<size_t> hit_count_{0};
+  std::atomic<size_t> miss_count_{0};
+};
+
 }  // namespace framework
 }  // namespace paddle
@@ -0,0 +1,62 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/program_desc.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(ExecutorPrepareContextCache, ReuseIdleContext) {
+  ProgramDesc program;
+  auto* block = program.MutableBlock(0);
+  for (auto name : {"a", "b", "c"}) {
+    block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto* add = block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"a"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"c"});
+
+  platform::CPUPlace place;
+  Executor executor(place);
+  ExecutorPrepareContextCache cache;
+  ExecutorPrepareContext* first = nullptr;
+  {
+    auto ctx = cache.Acquire(&executor, program, 0);
+    ASSERT_EQ(ctx->ops_.size(), 1UL);
+    first = ctx.get();
+  }
+  {
+    // The released context is reused, another concurrent run gets its own.
+    auto ctx = cache.Acquire(&executor, program, 0);
+    EXPECT_EQ(ctx.get(), first);
+    auto other = cache.Acquire(&executor, program, 0);
+    EXPECT_NE(other.get(), first);
+  }
+  // A different set of skipped variables is another key.
+  auto skip_ctx = cache.Acquire(&executor, program, 0, {"c"});
+  EXPECT_NE(skip_ctx.get(), first);
+
+  EXPECT_EQ(cache.HitCount(), 1UL);
+  EXPECT_EQ(cache.MissCount(), 3UL);
+}
+
+}  // namespace framework
+}  // namespace paddle
+
+USE_OP(elementwise_add);
@@ -16,6 +16,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/device_worker.h"
 #include "paddle/fluid/framework/device_worker_factory.h"
 #include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/device_tracer.h"
 #include "paddle/fluid/platform/lodtensor_printer.h"
 
 namespace paddle {
@@ -41,6 +42,11 @@ void HogwildWorker::CreateThreadOperators(const ProgramDesc &program) {
     ops_.push_back(local_op_ptr);
     continue;
   }
+  std::vector<std::string> op_types;
+  for (auto &op : ops_) {
+    op_types.push_back(op->Type());
+  }
+  metrics_.SetOpTypes(op_types);
 }
 
 void HogwildWorker::CreateThreadScope(const ProgramDesc &program) {
@@ -49,7 +55,8 @@ void HogwildWorker::CreateThreadScope(const ProgramDesc &program) {
   PADDLE_ENFORCE_NOT_NULL(
       root_scope_, "root_scope should be set before creating thread scope");
 
-  thread_scope_ = &root_scope_->NewScope();
+  thread_scope_ = replica_scope_ != nullptr ? &replica_scope_->NewScope()
+                                            : &root_scope_->NewScope();
 
   for (auto &var : block.AllVars()) {
     if (var->Persistable()) {
@@ -166,22 +173,34 @@ void HogwildWorker::TrainFiles() {
   // how to accumulate fetched values here
   device_reader_->Start();
   int cur_batch;
+  // One clock read per stage: the end of a stage is the start of the next.
+  int64_t read_start = platform::PosixInNsec();
   while ((cur_batch = device_reader_->Next()) > 0) {
-    for (auto &op : ops_) {
+    int64_t op_start = platform::PosixInNsec();
+    metrics_.AddReadWait(op_start - read_start);
+    for (size_t i = 0; i < ops_.size(); ++i) {
       bool need_skip = false;
       for (auto t = 0u; t < skip_ops_.size(); ++t) {
-        if (op->Type().find(skip_ops_[t]) != std::string::npos) {
+        if (ops_[i]->Type().find(skip_ops_[t]) != std::string::npos) {
           need_skip = true;
           break;
         }
       }
       if (!need_skip) {
-        op->Run(*thread_scope_, place_);
+        ops_[i]->Run(*thread_scope_, place_);
+        int64_t op_end = platform::PosixInNsec();
+        metrics_.AddOpTime(i, op_end - op_start);
+        op_start = op_end;
+      } else {
+        // The skip check is not charged to the next op.
+        op_start = platform::PosixInNsec();
       }
     }
+    metrics_.AddBatch(cur_batch);
 
     PrintFetchVars();
     thread_scope_->DropKids();
+    read_start = platform::PosixInNsec();
   }
 }
 
@@ -0,0 +1,152 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/infer_shape_cache.h"
+#include "paddle/fluid/framework/variable.h"
+
+namespace paddle {
+namespace framework {
+
+InferShapeCacheStats &InferShapeCacheStats::Instance() {
+  static InferShapeCacheStats stats;
+  return stats;
+}
+
+InferShapeCacheStats::Counter *InferShapeCacheStats::Get(
+    const std::string &op_type) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  auto &counter = counters_[op_type];
+  if (counter == nullptr) {
+    counter.reset(new Counter());
+  }
+  return counter.get();
+}
+
+std::map<std::string, std::pair<size_t, size_t>>
+InferShapeCacheStats::Snapshot() const {
+  std::map<std::string, std::pair<size_t, size_t>> result;
+  std::lock_guard<std::mutex> guard(mtx_);
+  for (auto &pair : counters_) {
+    result[pair.first] = std::make_pair(pair.second->skipped.load(),
+                                        pair.second->inferred.load());
+  }
+  return result;
+}
+
+void InferShapeCacheStats::Reset() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  for (auto &pair : counters_) {
+    pair.second->skipped = 0;
+    pair.second->inferred = 0;
+  }
+}
+
+static bool HasTensor(const Variable *var) {
+  return var != nullptr && var->IsInitialized();
+}
+
+bool InferShapeCache::MatchInputs(const VariableValueMap &inputs) const {
+  size_t i = 0;
+  for (auto &pair : inputs) {
+    for (auto *var : pair.second) {
+      if (i == inputs_.size()) return false;
+      auto &shape = inputs_[i++];
+      if (HasTensor(var) != shape.has_tensor) return false;
+      if (!shape.has_tensor) continue;
+      if (!var->IsType<LoDTensor>()) return false;
+      auto &tensor = var->Get<LoDTensor>();
+      if (tensor.dims() != shape.dims || !(tensor.lod() == shape.lod)) {
+        return false;
+      }
+    }
+  }
+  return i == inputs_.size();
+}
+
+bool InferShapeCache::Apply(const VariableValueMap &inputs,
+                            const VariableValueMap &outputs) {
+  if (!enabled_ || !recorded_ || !MatchInputs(inputs)) return false;
+  // Check all outputs before changing any of them, so that a mismatch leaves
+  // them untouched for InferShape().
+  size_t i = 0;
+  for (auto &pair : outputs) {
+    for (auto *var : pair.second) {
+      if (i == outputs_.size()) return false;
+      if (outputs_[i++].has_tensor &&
+          (var == nullptr ||
+           (var->IsInitialized() && !var->IsType<LoDTensor>()))) {
+        return false;
+      }
+    }
+  }
+  if (i != outputs_.size()) return false;
+  i = 0;
+  for (auto &pair : outputs) {
+    for (auto *var : pair.second) {
+      auto &shape = outputs_[i++];
+      if (!shape.has_tensor) continue;
+      auto *tensor = var->GetMutable<LoDTensor>();
+      tensor->Resize(shape.dims);
+      tensor->set_lod(shape.lod);
+    }
+  }
+  return true;
+}
+
+// Record the shapes of vars, return false if any of them is not a LoDTensor.
+static bool RecordShapes(const VariableValueMap &vars,
+                         std::vector<InferShapeCache::Shape> *shapes) {
+  shapes->clear();
+  for (auto &pair : vars) {
+    for (auto *var : pair.second) {
+      InferShapeCache::Shape shape;
+      if (HasTensor(var)) {
+        if (!var->IsType<LoDTensor>()) return false;
+        auto &tensor = var->Get<LoDTensor>();
+        shape.has_tensor = true;
+        shape.dims = tensor.dims();
+        shape.lod = tensor.lod();
+      }
+      shapes->emplace_back(std::move(shape));
+    }
+  }
+  return true;
+}
+
+void InferShapeCache::RecordInputs(const VariableValueMap &inputs) {
+  if (!enabled_) return;
+  recorded_ = false;
+  if (!RecordShapes(inputs, &inputs_)) Disable();
+}
+
+void InferShapeCache::RecordOutputs(const VariableValueMap &outputs) {
+  if (!enabled_) return;
+  if (!RecordShapes(outputs, &outputs_)) {
+    Disable();
+    return;
+  }
+  recorded_ = true;
+}
+
+void InferShapeCache::Disable() {
+  VLOG(3) << "Disable the InferShape cache of an operator with "
+             "non-LoDTensor variables";
+  enabled_ = false;
+  recorded_ = false;
+  inputs_.clear();
+  outputs_.clear();
+}
+
+}  // namespace framework
+}  // namespace paddle
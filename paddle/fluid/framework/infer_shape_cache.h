@@ -0,0 +1,102 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/type_defs.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * The InferShape() calls skipped and run, counted by operator type.
+ */
+class InferShapeCacheStats {
+ public:
+  struct Counter {
+    std::atomic<size_t> skipped{0};
+    std::atomic<size_t> inferred{0};
+  };
+
+  static InferShapeCacheStats &Instance();
+
+  // The counter of op_type, which lives as long as the process.
+  Counter *Get(const std::string &op_type);
+
+  // The skipped and inferred counts of every operator type.
+  std::map<std::string, std::pair<size_t, size_t>> Snapshot() const;
+
+  void Reset();
+
+ private:
+  InferShapeCacheStats() = default;
+
+  mutable std::mutex mtx_;
+  std::unordered_map<std::string, std::unique_ptr<Counter>> counters_;
+};
+
+/*
+ * Remembers the dims and LoD of the inputs of an operator and the dims and LoD
+ * of its outputs after InferShape(). When the next run has the same inputs,
+ * Apply() sets the remembered outputs instead, which is what InferShape()
+ * would have done. Only operators whose inputs and outputs are all LoDTensors
+ * or empty are cached, any other variable disables the cache of the operator.
+ *
+ * An operator instance is not run by several threads at once, so the cache is
+ * not locked.
+ */
+class InferShapeCache {
+ public:
+  // The shape of a variable slot, has_tensor is false for a missing or empty
+  // variable.
+  struct Shape {
+    bool has_tensor{false};
+    DDim dims;
+    LoD lod;
+  };
+
+  // Set the recorded outputs and return true if inputs match the recorded
+  // inputs.
+  bool Apply(const VariableValueMap &inputs, const VariableValueMap &outputs);
+
+  // Record inputs before InferShape().
+  void RecordInputs(const VariableValueMap &inputs);
+
+  // Record outputs after InferShape(), which completes the record.
+  void RecordOutputs(const VariableValueMap &outputs);
+
+  bool enabled() const { return enabled_; }
+
+ private:
+  bool MatchInputs(const VariableValueMap &inputs) const;
+
+  void Disable();
+
+  bool enabled_{true};
+  bool recorded_{false};
+  std::vector<Shape> inputs_;
+  std::vector<Shape> outputs_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,83 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/infer_shape_cache.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/variable.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(InferShapeCache, ApplyRecordedOutputs) {
+  Variable x, out;
+  auto* x_tensor = x.GetMutable<LoDTensor>();
+  x_tensor->Resize(make_ddim({4, 8}));
+  x_tensor->set_lod({{0, 1, 4}});
+  VariableValueMap inputs{{"X", {&x}}, {"Y", {nullptr}}};
+  VariableValueMap outputs{{"Out", {&out}}};
+
+  InferShapeCache cache;
+  EXPECT_FALSE(cache.Apply(inputs, outputs));
+  cache.RecordInputs(inputs);
+  // What InferShape would do.
+  auto* out_tensor = out.GetMutable<LoDTensor>();
+  out_tensor->Resize(make_ddim({4, 2}));
+  out_tensor->set_lod(x_tensor->lod());
+  cache.RecordOutputs(outputs);
+
+  // The outputs are reset the next run, e.g. in a new local scope.
+  Variable new_out;
+  VariableValueMap new_outputs{{"Out", {&new_out}}};
+  EXPECT_TRUE(cache.Apply(inputs, new_outputs));
+  EXPECT_EQ(new_out.Get<LoDTensor>().dims(), make_ddim({4, 2}));
+  EXPECT_EQ(new_out.Get<LoDTensor>().lod(), x_tensor->lod());
+
+  // A different LoD with the same dims needs InferShape.
+  x_tensor->set_lod({{0, 2, 4}});
+  EXPECT_FALSE(cache.Apply(inputs, new_outputs));
+  x_tensor->set_lod({{0, 1, 4}});
+  x_tensor->Resize(make_ddim({5, 8}));
+  EXPECT_FALSE(cache.Apply(inputs, new_outputs));
+  EXPECT_TRUE(cache.enabled());
+}
+
+TEST(InferShapeCache, DisabledByOtherVariables) {
+  Variable x, out;
+  x.GetMutable<SelectedRows>();
+  out.GetMutable<LoDTensor>();
+  VariableValueMap inputs{{"X", {&x}}};
+  VariableValueMap outputs{{"Out", {&out}}};
+
+  InferShapeCache cache;
+  cache.RecordInputs(inputs);
+  cache.RecordOutputs(outputs);
+  EXPECT_FALSE(cache.enabled());
+  EXPECT_FALSE(cache.Apply(inputs, outputs));
+}
+
+TEST(InferShapeCacheStats, CountByType) {
+  auto& stats = InferShapeCacheStats::Instance();
+  stats.Reset();
+  auto* counter = stats.Get("test_op");
+  EXPECT_EQ(counter, stats.Get("test_op"));
+  counter->skipped += 3;
+  ++counter->inferred;
+  auto snapshot = stats.Snapshot();
+  EXPECT_EQ(snapshot["test_op"].first, 3UL);
+  EXPECT_EQ(snapshot["test_op"].second, 1UL);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,190 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/ir/graph_helper.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/string/pretty_log.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+using string::PrettyLogDetail;
+
+// Their results differ from run to run, or they have side effects.
+static const std::unordered_set<std::string> kUnfoldableOps = {
+    "uniform_random",
+    "uniform_random_batch_size_like",
+    "gaussian_random",
+    "gaussian_random_batch_size_like",
+    "truncated_gaussian_random",
+    "sampling_id",
+    "random_crop",
+    "dropout",
+    "save",
+    "save_combine",
+    "print",
+};
+
+bool ConstantFoldingPass::IsFoldable(Node* op) const {
+  if (!op->IsOp() || !op->Op()) return false;
+  const std::string& type = op->Op()->Type();
+  if (kUnfoldableOps.count(type)) return false;
+  // The operators without kernels, like feed, fetch and the control flow
+  // operators, have side effects or sub-blocks.
+  auto& all_kernels = OperatorWithKernel::AllOpKernels();
+  auto it = all_kernels.find(type);
+  if (it == all_kernels.end()) return false;
+  for (auto& kernel : it->second) {
+    if (platform::is_cpu_place(kernel.first.place_)) return true;
+  }
+  return false;
+}
+
+bool ConstantFoldingPass::IsConstant(
+    Node* var, const std::unordered_set<std::string>& folded_vars,
+    const std::unordered_map<std::string, int>& num_writers) const {
+  if (!var->IsVar() || var->IsCtrlVar() || !var->Var()) return false;
+  if (var->Var()->GetType() != proto::VarType::LOD_TENSOR) return false;
+  if (folded_vars.count(var->Name())) return true;
+  if (!var->Var()->Persistable() || num_writers.count(var->Name())) {
+    return false;
+  }
+  auto* scope_var = param_scope()->FindVar(var->Name());
+  return scope_var && scope_var->IsType<LoDTensor>() &&
+         scope_var->Get<LoDTensor>().IsInitialized();
+}
+
+void ConstantFoldingPass::ApplyImpl(Graph* graph) const {
+  PADDLE_ENFORCE_NOT_NULL(graph);
+  FusePassBase::Init(name_scope_, graph);
+  auto* scope = param_scope();
+  PADDLE_ENFORCE_NOT_NULL(scope, "The parameter scope should be set.");
+
+  std::unordered_map<std::string, int> num_writers;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    for (auto* out : node->outputs) {
+      ++num_writers[out->Name()];
+    }
+  }
+
+  // Run the foldable operators in topological order, so that an operator
+  // reading the results of folded ones is folded too. The results stay in a
+  // temporary scope until it is known which of them are still needed.
+  platform::CPUPlace place;
+  Scope& fold_scope = scope->NewScope();
+  std::unordered_set<std::string> folded_vars;
+  std::unordered_set<const Node*> folded_ops;
+  for (auto* op : TopologySortOperations(*graph)) {
+    if (!IsFoldable(op)) continue;
+    bool foldable = true;
+    for (auto* in : op->inputs) {
+      foldable = foldable && IsConstant(in, folded_vars, num_writers);
+    }
+    for (auto* out : op->outputs) {
+      foldable = foldable && !out->IsCtrlVar() && out->Var() &&
+                 out->Var()->GetType() == proto::VarType::LOD_TENSOR &&
+                 !out->Var()->Persistable() && num_writers[out->Name()] == 1;
+    }
+    if (!foldable) continue;
+
+    for (auto* out : op->outputs) {
+      fold_scope.Var(out->Name())->GetMutable<LoDTensor>();
+    }
+    try {
+      OpRegistry::CreateOp(*op->Op())->Run(fold_scope, place);
+    } catch (const std::exception& e) {
+      VLOG(3) << "Cannot fold " << op->Op()->Type() << ": " << e.what();
+      continue;
+    }
+    folded_ops.insert(op);
+    for (auto* out : op->outputs) {
+      folded_vars.insert(out->Name());
+    }
+  }
+
+  // The results read by the remaining operators become parameters, the
+  // others and the parameters only read by the folded operators are dropped.
+  auto only_read_by_folded = [&](const Node* var) -> bool {
+    for (auto* reader : var->outputs) {
+      if (!folded_ops.count(reader)) return false;
+    }
+    return true;
+  };
+  std::unordered_set<const Node*> nodes_to_remove(folded_ops.begin(),
+                                                  folded_ops.end());
+  std::unordered_set<std::string> dropped_params;
+  int num_new_params = 0;
+  size_t added_bytes = 0;
+  for (auto* op : folded_ops) {
+    for (auto* out : op->outputs) {
+      if (only_read_by_folded(out)) {
+        nodes_to_remove.insert(out);
+        continue;
+      }
+      auto& result = fold_scope.FindVar(out->Name())->Get<LoDTensor>();
+      auto* param = scope->Var(out->Name())->GetMutable<LoDTensor>();
+      param->ShareDataWith(result);
+      param->set_lod(result.lod());
+      out->Var()->SetPersistable(true);
+      out->Var()->SetShape(framework::vectorize(result.dims()));
+      out->Var()->SetDataType(result.type());
+      ++num_new_params;
+      added_bytes += result.memory_size();
+    }
+    for (auto* in : op->inputs) {
+      if (!folded_vars.count(in->Name()) && only_read_by_folded(in)) {
+        nodes_to_remove.insert(in);
+        dropped_params.insert(in->Name());
+      }
+    }
+  }
+  scope->DeleteScope(&fold_scope);
+
+  // Another node of the same name may still be read.
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && !nodes_to_remove.count(node)) {
+      dropped_params.erase(node->Name());
+    }
+  }
+  size_t released_bytes = 0;
+  for (auto& name : dropped_params) {
+    released_bytes += scope->FindVar(name)->Get<LoDTensor>().memory_size();
+  }
+  scope->EraseVars(std::vector<std::string>(dropped_params.begin(),
+                                            dropped_params.end()));
+  GraphSafeRemoveNodes(graph, nodes_to_remove);
+
+  AddStatis(folded_ops.size());
+  if (!folded_ops.empty()) {
+    PrettyLogDetail(
+        "---    folded %d ops into %d parameters, %d bytes added, %d bytes of "
+        "parameters released",
+        folded_ops.size(), num_new_params, added_bytes, released_bytes);
+  }
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(constant_folding_pass,
+              paddle::framework::ir::ConstantFoldingPass);
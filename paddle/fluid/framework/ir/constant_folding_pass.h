@@ -0,0 +1,55 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Evaluate the operators whose inputs are all constants once on CPU, and
+ * replace them by the persistable variables holding their results.
+ *
+ * The constants are the persistable LoDTensors of the parameter scope that no
+ * operator writes, and the outputs of the folded operators. Operators without
+ * inputs, like fill_constant and assign_value, are folded too. Random, and
+ * CPU kernel-less operators are never folded. The parameters only read by the
+ * folded operators are removed from the graph and the scope.
+ */
+class ConstantFoldingPass : public FusePassBase {
+ public:
+  virtual ~ConstantFoldingPass() {}
+
+ protected:
+  void ApplyImpl(Graph* graph) const override;
+
+ private:
+  bool IsFoldable(Node* op) const;
+  bool IsConstant(
+      Node* var, const std::unordered_set<std::string>& folded_vars,
+      const std::unordered_map<std::string, int>& num_writers) const;
+
+  const std::string name_scope_{"constant_folding"};
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
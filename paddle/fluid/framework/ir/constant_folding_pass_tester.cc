@@ -0,0 +1,116 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/ir/constant_folding_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+#include "paddle/fluid/framework/op_registry.h"
+
+USE_OP(relu);
+USE_OP(elementwise_add);
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static void InitTensor(Scope* scope, const std::string& name, float value) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->Resize({2, 3});
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int i = 0; i < tensor->numel(); ++i) {
+    data[i] = value * (i % 2 == 0 ? 1 : -1);
+  }
+}
+
+static Node* FindVarNode(const std::unique_ptr<Graph>& graph,
+                         const std::string& name) {
+  for (auto* node : graph->Nodes()) {
+    if (node->IsVar() && node->Name() == name) return node;
+  }
+  return nullptr;
+}
+
+TEST(ConstantFoldingPass, fold_parameter_subgraph) {
+  Layers layers;
+  // (w) -> relu -> (tmp_0)
+  // (tmp_0, b) -> elementwise_add -> (tmp_1)
+  // (x, tmp_1) -> mul -> (tmp_2)
+  // (x) -> relu -> (tmp_3)
+  auto* x = layers.data("x");
+  auto* w = layers.data("w", {2, 3}, true);
+  auto* b = layers.data("b", {2, 3}, true);
+  auto* relu_out = layers.relu(w);
+  auto* add_out = layers.elementwise_add(relu_out, b);
+  layers.mul(x, add_out);
+  layers.relu(x);
+
+  Scope scope;
+  InitTensor(&scope, "w", 2.f);
+  InitTensor(&scope, "b", 1.f);
+
+  std::unique_ptr<Graph> graph(new Graph(layers.main_program()));
+  graph->SetNotOwned(kParamScopeAttr, &scope);
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  graph.reset(pass->Apply(graph.release()));
+  VLOG(3) << DebugString(graph);
+
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_add"), 0);
+  EXPECT_EQ(GetNumOpNodes(graph, "relu"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "mul"), 1);
+  EXPECT_EQ(FindVarNode(graph, relu_out->Name()), nullptr);
+  EXPECT_EQ(FindVarNode(graph, "w"), nullptr);
+  EXPECT_EQ(FindVarNode(graph, "b"), nullptr);
+  EXPECT_EQ(scope.FindVar("w"), nullptr);
+  EXPECT_EQ(scope.FindVar("b"), nullptr);
+
+  auto* folded = FindVarNode(graph, add_out->Name());
+  ASSERT_NE(folded, nullptr);
+  EXPECT_TRUE(folded->Var()->Persistable());
+  auto& result = scope.FindVar(add_out->Name())->Get<LoDTensor>();
+  ASSERT_EQ(result.dims(), make_ddim({2, 3}));
+  const float* data = result.data<float>();
+  for (int i = 0; i < result.numel(); ++i) {
+    // relu(+-2) + (+-1)
+    EXPECT_FLOAT_EQ(data[i], i % 2 == 0 ? 3.f : -1.f);
+  }
+}
+
+TEST(ConstantFoldingPass, keep_written_parameter) {
+  Layers layers;
+  // (w) -> relu -> (tmp_0)
+  // (x, tmp_0) -> elementwise_add -> (w)
+  auto* x = layers.data("x");
+  auto* w = layers.data("w", {2, 3}, true);
+  auto* relu_out = layers.relu(w);
+  layers.elementwise_add(x, relu_out, w);
+
+  Scope scope;
+  InitTensor(&scope, "w", 2.f);
+
+  std::unique_ptr<Graph> graph(new Graph(layers.main_program()));
+  graph->SetNotOwned(kParamScopeAttr, &scope);
+  auto pass = PassRegistry::Instance().Get("constant_folding_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  EXPECT_EQ(GetNumOpNodes(graph, "relu"), 1);
+  EXPECT_EQ(GetNumOpNodes(graph, "elementwise_add"), 1);
+  EXPECT_NE(scope.FindVar("w"), nullptr);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(constant_folding_pass);
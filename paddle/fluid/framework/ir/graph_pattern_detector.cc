@@ -100,17 +100,49 @@ void GraphPatternDetector::operator()(Graph *graph,
     VLOG(3) << "optimizing #" << id++ << " subgraph";
     handler(g, graph);
   }
+  if (!graph->Has(kPatternMatchCountAttr)) {
+    graph->Set(kPatternMatchCountAttr, new size_t(0));
+  }
+  graph->Get<size_t>(kPatternMatchCountAttr) += subgraphs.size();
 }
 
 bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   VLOG(3) << "mark pdnodes in graph";
   if (graph.Nodes().empty()) return false;
 
-  for (auto &node : GraphTraits::DFS(graph)) {
-    for (const auto &pdnode : pattern_.nodes()) {
-      if (pdnode->Tell(&node)) {
-        VLOG(4) << "Node " << node.Name() << " marked as " << pdnode->name();
-        pdnodes2nodes_[pdnode.get()].insert(&node);
+  // Index the ops by type, so that the PDNodes asserting op types only tell
+  // the ops of these types, or their inputs or outputs.
+  std::unordered_map<std::string, std::vector<Node *>> ops_by_type;
+  for (auto *node : graph.Nodes()) {
+    if (node->IsOp() && node->Op()) {
+      ops_by_type[node->Op()->Type()].push_back(node);
+    }
+  }
+
+  for (const auto &pdnode : pattern_.nodes()) {
+    auto kind = pdnode->index_kind();
+    std::unordered_set<Node *> candidates;
+    if (kind != PDNode::IndexKind::kNone) {
+      for (auto &type : pdnode->index_op_types()) {
+        auto it = ops_by_type.find(type);
+        if (it == ops_by_type.end()) continue;
+        for (auto *op : it->second) {
+          if (kind == PDNode::IndexKind::kOp) {
+            candidates.insert(op);
+          } else {
+            auto &vars = kind == PDNode::IndexKind::kOpInput ? op->inputs
+                                                             : op->outputs;
+            candidates.insert(vars.begin(), vars.end());
+          }
+        }
+      }
+    }
+    const auto &nodes =
+        kind == PDNode::IndexKind::kNone ? graph.Nodes() : candidates;
+    for (auto *node : nodes) {
+      if (pdnode->Tell(node)) {
+        VLOG(4) << "Node " << node->Name() << " marked as " << pdnode->name();
+        pdnodes2nodes_[pdnode.get()].insert(node);
       }
     }
   }
@@ -223,21 +255,46 @@ GraphPatternDetector::DetectPatterns() {
     auto &cur_groups = bi_records[1 - (step++ % 2)];
     cur_groups.clear();
     if (pre_groups.empty()) break;
+    auto &sources = pdnodes2nodes_[edge.first];
+    auto &targets = pdnodes2nodes_[edge.second];
+    auto extend = [&](const HitGroup &group, Node *source, Node *target) {
+      HitGroup new_group = group;
+      bool flag = new_group.Match(source, edge.first) &&
+                  new_group.Match(target, edge.second);
+      if (flag) {
+        new_group.Register(source, edge.first);
+        new_group.Register(target, edge.second);
+        cur_groups.push_back(new_group);
+        // TODO(Superjomn) need to unique
+      }
+    };
     // source -> target
-    for (Node *source : pdnodes2nodes_[edge.first]) {
-      for (Node *target : pdnodes2nodes_[edge.second]) {
-        VLOG(8) << "check " << source->id() << " -- " << target->id();
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          if (IsNodesLink(source, target)) {
-            HitGroup new_group = group;
-            bool flag = new_group.Match(source, edge.first) &&
-                        new_group.Match(target, edge.second);
-            if (flag) {
-              new_group.Register(source, edge.first);
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
+    for (const auto &group : pre_groups) {
+      // When either end is already matched in the group, only its links can
+      // extend the group.
+      auto source_it = group.roles.find(edge.first);
+      auto target_it = group.roles.find(edge.second);
+      std::unordered_set<Node *> visited;
+      if (source_it != group.roles.end()) {
+        Node *source = source_it->second;
+        for (Node *target : source->outputs) {
+          if (targets.count(target) && visited.insert(target).second) {
+            extend(group, source, target);
+          }
+        }
+      } else if (target_it != group.roles.end()) {
+        Node *target = target_it->second;
+        for (Node *source : target->inputs) {
+          if (sources.count(source) && visited.insert(source).second) {
+            extend(group, source, target);
+          }
+        }
+      } else {
+        for (Node *source : sources) {
+          for (Node *target : targets) {
+            VLOG(8) << "check " << source->id() << " -- " << target->id();
+            if (IsNodesLink(source, target)) {
+              extend(group, source, target);
             }
           }
         }
@@ -368,6 +425,7 @@ PDNode *PDNode::assert_is_op() {
 }
 
 PDNode *PDNode::assert_is_op(const std::string &op_type) {
+  SetIndexHint(IndexKind::kOp, {op_type});
   asserts_.emplace_back([op_type](Node *x) {
     return x && x->IsOp() && x->Op()->Type() == op_type;
   });
@@ -413,6 +471,7 @@ PDNode *PDNode::assert_is_op_nth_input(const std::string &op_type,
 
 PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
                                         const std::string &argument, int nth) {
+  SetIndexHint(IndexKind::kOpOutput, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -426,6 +485,7 @@ PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
 }
 
 PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
+  SetIndexHint(IndexKind::kOpInput, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
@@ -440,6 +500,7 @@ PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
 }
 
 PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
+  SetIndexHint(IndexKind::kOpOutput, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -454,6 +515,7 @@ PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
 }
 
 PDNode *PDNode::assert_is_op_output(const std::string &op_type) {
+  SetIndexHint(IndexKind::kOpOutput, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -473,6 +535,7 @@ PDNode *PDNode::assert_is_op_output(const std::string &op_type,
   return this;
 }
 PDNode *PDNode::assert_is_op_input(const std::string &op_type) {
+  SetIndexHint(IndexKind::kOpInput, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
@@ -520,6 +583,7 @@ PDNode *PDNode::assert_more(PDNode::teller_t &&teller) {
 }
 
 PDNode *PDNode::assert_is_ops(const std::unordered_set<std::string> &op_types) {
+  SetIndexHint(IndexKind::kOp, op_types);
   asserts_.emplace_back([op_types](Node *x) {
     return x && x->IsOp() && op_types.count(x->Op()->Type());
   });
@@ -545,6 +609,7 @@ PDNode *PDNode::assert_is_ops_nth_input(
 PDNode *PDNode::assert_is_ops_nth_output(
     const std::unordered_set<std::string> &op_types,
     const std::string &argument, int nth) {
+  SetIndexHint(IndexKind::kOpOutput, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -558,6 +623,7 @@ PDNode *PDNode::assert_is_ops_nth_output(
 }
 PDNode *PDNode::assert_is_ops_output(
     const std::unordered_set<std::string> &op_types) {
+  SetIndexHint(IndexKind::kOpOutput, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -580,6 +646,7 @@ PDNode *PDNode::assert_is_ops_output(
 
 PDNode *PDNode::assert_is_ops_input(
     const std::unordered_set<std::string> &op_types) {
+  SetIndexHint(IndexKind::kOpInput, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
@@ -34,6 +34,10 @@ namespace framework {
 namespace ir {
 class PDPattern;
 
+// The number of subgraphs the GraphPatternDetectors have handed to their
+// handlers on a graph, a size_t.
+constexpr char kPatternMatchCountAttr[] = "__pattern_match_count__";
+
 // Some basic terminologies:
 //   - PDPattern: a pattern defined as a data flow graph.
 //   - PDNode: the node in the pattern, each PDNode represents an `ir::Node`
@@ -51,6 +55,14 @@ struct PDNode {
     kOutput,       // an output and will be retained,
     kIntermediate  // will be removed after handler.
   };
+  // How the candidates of this node can be looked up from the op types of
+  // the graph, instead of telling every node.
+  enum class IndexKind {
+    kNone,      // No hint, tell every node,
+    kOp,        // an op of index_op_types,
+    kOpInput,   // an input of an op of index_op_types,
+    kOpOutput   // an output of an op of index_op_types.
+  };
 
   // this link to others
   PDNode& LinksTo(const std::vector<PDNode*>& others);
@@ -68,6 +80,14 @@ struct PDNode {
   bool IsOp() const { return type_ == Type::kOp; }
   bool IsVar() const { return type_ == Type::kVar; }
 
+  // The asserts are ignored when a teller is set, so are their hints.
+  IndexKind index_kind() const {
+    return teller_ ? IndexKind::kNone : index_kind_;
+  }
+  const std::unordered_set<std::string>& index_op_types() const {
+    return index_op_types_;
+  }
+
   const std::string& name() const { return name_; }
 
   PDNode& operator=(const PDNode&) = delete;
@@ -160,9 +180,20 @@ struct PDNode {
 
   friend class PDPattern;
 
+  // All the asserts must hold, so the hint of any of them narrows the
+  // candidates soundly, the first one is kept.
+  void SetIndexHint(IndexKind kind,
+                    const std::unordered_set<std::string>& op_types) {
+    if (index_kind_ != IndexKind::kNone) return;
+    index_kind_ = kind;
+    index_op_types_ = op_types;
+  }
+
   // Will removed latter.
   teller_t teller_;
   std::vector<teller_t> asserts_;
+  IndexKind index_kind_{IndexKind::kNone};
+  std::unordered_set<std::string> index_op_types_;
   PDPattern* pattern_;
   std::string name_;
   Type type_;
@@ -234,9 +265,12 @@ class PDPattern {
  * This helper can be used to support fuse(conv+batchnorm => batchnorm e.g.).
  *
  * The algorithm has three phases:
- *   1. Mark the nodes that match the defined PDNodes in a PDPattern,
+ *   1. Mark the nodes that match the defined PDNodes in a PDPattern, the
+ *      PDNodes asserting op types only tell the ops of these types, or their
+ *      inputs or outputs, found in an index built in one scan of the graph,
  *   2. Extend a PDNode to subgraphs by deducing the connection relation defined
- *      in PAPattern(the edges),
+ *      in PAPattern(the edges), following the links of the nodes already
+ *      matched in a subgraph,
  *   3. Get the filtered subgraphs and treat them with a pre-defined handler.
  *
  * Usage:
@@ -288,6 +322,7 @@ class GraphPatternDetector {
 #ifdef PADDLE_WITH_TESTING
   FRIEND_TEST(GraphPatternDetecter, MarkPDNodesInGraph);
   FRIEND_TEST(GraphPatternDetecter, DetectPatterns);
+  FRIEND_TEST(GraphPatternDetecter, IndexedOpTypes);
 #endif
 
  private:
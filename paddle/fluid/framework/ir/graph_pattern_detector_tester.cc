@@ -15,6 +15,7 @@
 #include "paddle/fluid/framework/ir/graph_pattern_detector.h"
 
 #include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
 
 namespace paddle {
 namespace framework {
@@ -201,6 +202,44 @@ TEST(GraphPatternDetector, IntermediateCheck) {
   ASSERT_EQ(count, 1);
 }
 
+TEST(GraphPatternDetecter, IndexedOpTypes) {
+  Layers layers;
+  // (x, y) -> mul -> (tmp_0) -> relu -> (tmp_1)
+  // (x) -> relu -> (tmp_2) -> relu -> (tmp_3)
+  auto* x = layers.data("x");
+  auto* y = layers.data("y");
+  layers.relu(layers.mul(x, y));
+  layers.relu(layers.relu(x));
+  Graph graph(layers.main_program());
+
+  GraphPatternDetector detector;
+  auto* pattern = detector.mutable_pattern();
+  auto* mul = pattern->NewNode("mul")->assert_is_op("mul");
+  auto* mul_out = pattern->NewNode("mul_out")
+                      ->assert_is_op_output("mul")
+                      ->assert_is_op_input("relu")
+                      ->AsIntermediate();
+  auto* relu = pattern->NewNode("relu")->assert_is_op("relu");
+  mul_out->LinksFrom({mul}).LinksTo({relu});
+
+  ASSERT_EQ(mul->index_kind(), PDNode::IndexKind::kOp);
+  ASSERT_EQ(mul_out->index_kind(), PDNode::IndexKind::kOpOutput);
+  ASSERT_EQ(mul_out->index_op_types().count("mul"), 1UL);
+
+  int count = 0;
+  detector(&graph, [&](const GraphPatternDetector::subgraph_t& subgraph,
+                       Graph* g) {
+    EXPECT_EQ(subgraph.at(mul)->Op()->Type(), "mul");
+    EXPECT_EQ(subgraph.at(relu)->inputs.front(), subgraph.at(mul_out));
+    ++count;
+  });
+  EXPECT_EQ(detector.pdnodes2nodes_[mul].size(), 1UL);
+  EXPECT_EQ(detector.pdnodes2nodes_[mul_out].size(), 1UL);
+  EXPECT_EQ(detector.pdnodes2nodes_[relu].size(), 3UL);
+  EXPECT_EQ(count, 1);
+  EXPECT_EQ(graph.Get<size_t>(kPatternMatchCountAttr), 1UL);
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
@@ -0,0 +1,205 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+// A bounded multi-producer multi-consumer queue with the interface of
+// operators::reader::BlockingQueue. Sending to a queue which is not full and
+// receiving from a queue which is not empty take no lock, they are a
+// compare-and-swap and a copy. A thread which has to wait spins a little and
+// then sleeps on a condition variable.
+//
+// The slots are the ones of D. Vyukov's bounded MPMC queue: the sequence
+// number of a slot tells whether the producer or the consumer of a position
+// owns it. A slot just filled and a slot free for the next lap can only be
+// told apart with two slots or more, so a capacity of 1 is rounded up to 2.
+template <typename T>
+class MPMCQueue {
+ public:
+  explicit MPMCQueue(size_t capacity)
+      : capacity_(std::max(capacity, static_cast<size_t>(2))),
+        slots_(new Slot[capacity_]) {
+    PADDLE_ENFORCE_GT(capacity, static_cast<size_t>(0),
+                      "The capacity of a MPMCQueue must be greater than 0.");
+    for (size_t i = 0; i < capacity_; ++i) {
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool Send(T elem) {
+    bool sent = Wait(
+        [&]() -> AttemptResult {
+          if (closed_.load()) return kFailed;
+          return TryPush(&elem) ? kDone : kRetry;
+        },
+        &send_waiters_, &send_cv_);
+    if (!sent) {
+      VLOG(5) << "WARNING: Sending an element to a closed MPMCQueue.";
+      return false;
+    }
+    Notify(&receive_waiters_, &receive_cv_);
+    return true;
+  }
+
+  // Return false once the queue is closed and empty.
+  bool Receive(T* elem) {
+    PADDLE_ENFORCE_NOT_NULL(elem);
+    bool received = Wait(
+        [&]() -> AttemptResult {
+          // The elements sent before the queue was closed are visible.
+          bool closed = closed_.load();
+          if (TryPop(elem)) return kDone;
+          return closed ? kFailed : kRetry;
+        },
+        &receive_waiters_, &receive_cv_);
+    if (!received) {
+      VLOG(3) << "queue is closed! return nothing.";
+      return false;
+    }
+    Notify(&send_waiters_, &send_cv_);
+    return true;
+  }
+
+  void Close() {
+    closed_.store(true);
+    std::lock_guard<std::mutex> guard(mutex_);
+    VLOG(1) << "close queue";
+    send_cv_.notify_all();
+    receive_cv_.notify_all();
+  }
+
+  bool IsClosed() const { return closed_.load(); }
+
+  size_t Cap() const { return capacity_; }
+
+  size_t Size() const {
+    size_t dequeue_pos = dequeue_pos_.load();
+    size_t enqueue_pos = enqueue_pos_.load();
+    return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  enum AttemptResult { kDone, kRetry, kFailed };
+  static constexpr int kSpinTimes = 64;
+
+  bool TryPush(T* elem) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    while (true) {
+      slot = &slots_[pos % capacity_];
+      size_t seq = slot->seq.load(std::memory_order_acquire);
+      auto dif = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+      if (dif == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (dif < 0) {
+        return false;  // full
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->value = std::move(*elem);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop(T* elem) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    while (true) {
+      slot = &slots_[pos % capacity_];
+      size_t seq = slot->seq.load(std::memory_order_acquire);
+      auto dif = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+      if (dif == 0) {
+        if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (dif < 0) {
+        return false;  // empty
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    *elem = std::move(slot->value);
+    slot->seq.store(pos + capacity_, std::memory_order_release);
+    return true;
+  }
+
+  // Run attempt until it is done or failed, return whether it is done.
+  template <typename Attempt>
+  bool Wait(Attempt attempt, std::atomic<int>* waiters,
+            std::condition_variable* cv) {
+    for (int i = 0; i < kSpinTimes; ++i) {
+      AttemptResult ret = attempt();
+      if (ret != kRetry) return ret == kDone;
+      std::this_thread::yield();
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiters->fetch_add(1);
+    // Pairs with the fence of Notify: either the attempt sees the change of
+    // the other side, or the other side sees the waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    AttemptResult ret = attempt();
+    while (ret == kRetry) {
+      cv->wait(lock);
+      ret = attempt();
+    }
+    waiters->fetch_sub(1);
+    return ret == kDone;
+  }
+
+  void Notify(std::atomic<int>* waiters, std::condition_variable* cv) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters->load() > 0) {
+      // The waiter holds the mutex until it sleeps.
+      std::lock_guard<std::mutex> guard(mutex_);
+      cv->notify_one();
+    }
+  }
+
+  const size_t capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<size_t> enqueue_pos_{0};
+  std::atomic<size_t> dequeue_pos_{0};
+  std::atomic<bool> closed_{false};
+
+  std::atomic<int> send_waiters_{0};
+  std::atomic<int> receive_waiters_{0};
+  std::mutex mutex_;
+  std::condition_variable send_cv_;
+  std::condition_variable receive_cv_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,131 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/mpmc_queue.h"
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(MPMCQueue, send_and_receive_in_order) {
+  MPMCQueue<int> q(3);
+  for (int round = 0; round < 4; ++round) {
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_TRUE(q.Send(round * 3 + i));
+    }
+    EXPECT_EQ(q.Size(), 3UL);
+    for (int i = 0; i < 3; ++i) {
+      int v = -1;
+      EXPECT_TRUE(q.Receive(&v));
+      EXPECT_EQ(v, round * 3 + i);
+    }
+    EXPECT_EQ(q.Size(), 0UL);
+  }
+}
+
+TEST(MPMCQueue, capacity_of_one) {
+  MPMCQueue<int> q(1);
+  EXPECT_EQ(q.Cap(), 2UL);
+  for (int i = 0; i < 5; ++i) {
+    int v = -1;
+    EXPECT_TRUE(q.Send(i));
+    EXPECT_TRUE(q.Receive(&v));
+    EXPECT_EQ(v, i);
+  }
+}
+
+TEST(MPMCQueue, close_drains_the_queue) {
+  MPMCQueue<int> q(2);
+  EXPECT_TRUE(q.Send(1));
+  q.Close();
+  EXPECT_TRUE(q.IsClosed());
+  EXPECT_FALSE(q.Send(2));
+  int v = 0;
+  EXPECT_TRUE(q.Receive(&v));
+  EXPECT_EQ(v, 1);
+  EXPECT_FALSE(q.Receive(&v));
+}
+
+TEST(MPMCQueue, blocked_threads_are_woken) {
+  MPMCQueue<int> q(2);
+  int v = 0;
+  std::thread receiver([&] { EXPECT_TRUE(q.Receive(&v)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_TRUE(q.Send(7));
+  receiver.join();
+  EXPECT_EQ(v, 7);
+
+  EXPECT_TRUE(q.Send(8));
+  EXPECT_TRUE(q.Send(9));
+  std::thread sender([&] { EXPECT_TRUE(q.Send(10)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(q.Size(), 2UL);
+  EXPECT_TRUE(q.Receive(&v));
+  EXPECT_EQ(v, 8);
+  sender.join();
+  EXPECT_TRUE(q.Receive(&v));
+  EXPECT_EQ(v, 9);
+  EXPECT_TRUE(q.Receive(&v));
+  EXPECT_EQ(v, 10);
+
+  std::thread closed_receiver([&] { EXPECT_FALSE(q.Receive(&v)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  q.Close();
+  closed_receiver.join();
+}
+
+TEST(MPMCQueue, many_producers_and_consumers) {
+  const int kThreads = 4;
+  const int kNumPerThread = 20000;
+  MPMCQueue<int> q(8);
+  std::atomic<int64_t> sum{0};
+  std::atomic<int> count{0};
+
+  std::vector<std::thread> consumers;
+  for (int i = 0; i < kThreads; ++i) {
+    consumers.emplace_back([&] {
+      int v = 0;
+      while (q.Receive(&v)) {
+        sum += v;
+        ++count;
+      }
+    });
+  }
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kThreads; ++i) {
+    producers.emplace_back([&, i] {
+      for (int j = 0; j < kNumPerThread; ++j) {
+        EXPECT_TRUE(q.Send(i * kNumPerThread + j));
+      }
+    });
+  }
+  for (auto& t : producers) {
+    t.join();
+  }
+  q.Close();
+  for (auto& t : consumers) {
+    t.join();
+  }
+
+  int64_t n = kThreads * kNumPerThread;
+  EXPECT_EQ(count.load(), n);
+  EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -12,11 +12,15 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <string>
 #include <vector>
 #include "paddle/fluid/framework/data_feed_factory.h"
 #include "paddle/fluid/framework/device_worker_factory.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/framework/trainer.h"
+#include "paddle/fluid/platform/device_tracer.h"
 
 namespace paddle {
 namespace framework {
@@ -48,39 +52,260 @@ void MultiTrainer::Initialize(const TrainerDesc& trainer_desc,
 
   // set debug here
   SetDebug(trainer_desc.debug());
+  if (!trainer_desc.metrics_path().empty()) {
+    SetMetricsFile(trainer_desc.metrics_path(),
+                   trainer_desc.metrics_interval_ms());
+  }
+
+  binding_cpu_ = trainer_desc.binding_cpu();
+  if (binding_cpu_) {
+    numa_replica_max_numel_ = trainer_desc.numa_replica_max_numel();
+    numa_sync_interval_ms_ = trainer_desc.numa_sync_interval_ms();
+    PADDLE_ENFORCE_GT(numa_sync_interval_ms_, 0,
+                      "numa_sync_interval_ms should be greater than 0.");
+    numa_nodes_ = platform::GetNumaNodes();
+    thread_nodes_ =
+        platform::AssignThreadsToNumaNodes(thread_num_, numa_nodes_);
+    for (int i = 0; i < thread_num_; ++i) {
+      VLOG(3) << "worker thread " << i << " on NUMA node "
+              << numa_nodes_[thread_nodes_[i]].id;
+    }
+  }
+}
+
+void MultiTrainer::RunOnWorkerNode(int thread_id,
+                                   const std::function<void()>& func) {
+  if (!binding_cpu_) {
+    func();
+    return;
+  }
+  std::thread t([this, thread_id, &func] {
+    platform::BindThreadToCpus(numa_nodes_[thread_nodes_[thread_id]].cpus);
+    func();
+  });
+  t.join();
+}
+
+std::thread MultiTrainer::StartWorkerThread(int thread_id) {
+  DeviceWorker* worker = workers_[thread_id].get();
+  const std::vector<int>* cpus =
+      binding_cpu_ ? &numa_nodes_[thread_nodes_[thread_id]].cpus : nullptr;
+  bool debug = debug_;
+  // The helper threads of the reader are created by the worker thread, and
+  // inherit its CPUs.
+  return std::thread([worker, cpus, debug] {
+    if (cpus != nullptr) {
+      platform::BindThreadToCpus(*cpus);
+    }
+    if (!debug) {
+      worker->TrainFiles();
+    } else {
+      worker->TrainFilesWithProfiler();
+    }
+  });
 }
 
 // call only after all resources are set in current trainer
 void MultiTrainer::InitTrainerEnv(const ProgramDesc& main_program,
                                   const platform::Place& place) {
+  if (binding_cpu_ && numa_replica_max_numel_ > 0 &&
+      platform::is_cpu_place(place)) {
+    InitNumaReplicas(main_program);
+  }
   for (int i = 0; i < thread_num_; ++i) {
     workers_[i]->SetPlace(place);
     workers_[i]->SetReaderPlace(place);
     workers_[i]->SetRootScope(root_scope_);
-    workers_[i]->CreateDeviceResource(main_program);  // Program
-    workers_[i]->BindingDataFeedMemory();
+    if (!replica_scopes_.empty()) {
+      workers_[i]->SetReplicaScope(replica_scopes_[thread_nodes_[i]]);
+    }
+    // The tensors are first touched by a thread on the node of the worker,
+    // so that their pages are allocated there. The workers are created one
+    // after another since they share the root scope.
+    RunOnWorkerNode(i, [&] {
+      workers_[i]->CreateDeviceResource(main_program);  // Program
+      workers_[i]->BindingDataFeedMemory();
+    });
+  }
+  if (binding_cpu_) {
+    for (auto& node : numa_nodes_) {
+      numa_stats_.push_back(platform::GetNumaStat(node.id));
+    }
+  }
+}
+
+void MultiTrainer::InitNumaReplicas(const ProgramDesc& main_program) {
+  std::vector<int> num_threads(numa_nodes_.size(), 0);
+  for (int node : thread_nodes_) {
+    ++num_threads[node];
+  }
+  if (std::count_if(num_threads.begin(), num_threads.end(),
+                    [](int n) { return n > 0; }) < 2) {
+    VLOG(3) << "All the workers are on one NUMA node, no replica is made.";
+    return;
+  }
+  for (auto* var : main_program.Block(0).AllVars()) {
+    if (!var->Persistable() || var->GetType() != proto::VarType::LOD_TENSOR ||
+        std::find(need_merge_var_names_.begin(), need_merge_var_names_.end(),
+                  var->Name()) != need_merge_var_names_.end()) {
+      continue;
+    }
+    Variable* root_var = root_scope_->FindVar(var->Name());
+    if (root_var == nullptr || !root_var->IsType<LoDTensor>()) {
+      continue;
+    }
+    auto& tensor = root_var->Get<LoDTensor>();
+    if (tensor.IsInitialized() && platform::is_cpu_place(tensor.place()) &&
+        tensor.type() == proto::VarType::FP32 &&
+        tensor.numel() <= numa_replica_max_numel_) {
+      replica_var_names_.push_back(var->Name());
+    }
+  }
+  replica_scopes_.resize(numa_nodes_.size(), nullptr);
+  for (size_t node = 0; node < numa_nodes_.size(); ++node) {
+    if (num_threads[node] == 0) {
+      continue;
+    }
+    Scope* scope = &root_scope_->NewScope();
+    replica_scopes_[node] = scope;
+    int thread_id = static_cast<int>(
+        std::find(thread_nodes_.begin(), thread_nodes_.end(),
+                  static_cast<int>(node)) -
+        thread_nodes_.begin());
+    RunOnWorkerNode(thread_id, [&] {
+      for (auto& name : replica_var_names_) {
+        auto& src = root_scope_->FindVar(name)->Get<LoDTensor>();
+        auto* dst = scope->Var(name)->GetMutable<LoDTensor>();
+        TensorCopySync(src, platform::CPUPlace(), dst);
+        dst->set_lod(src.lod());
+      }
+    });
+  }
+  VLOG(3) << "replicate " << replica_var_names_.size()
+          << " parameters on every NUMA node";
+}
+
+// Set the root parameters and all their replicas to the mean of the replicas.
+// Like the Hogwild updates, this takes no lock: an update made while a
+// parameter is averaged may be lost.
+void MultiTrainer::AverageNumaReplicas() {
+  std::vector<float*> replicas;
+  for (auto& name : replica_var_names_) {
+    replicas.clear();
+    for (auto* scope : replica_scopes_) {
+      if (scope != nullptr) {
+        replicas.push_back(
+            scope->FindLocalVar(name)->GetMutable<LoDTensor>()->data<float>());
+      }
+    }
+    auto* root_tensor = root_scope_->FindVar(name)->GetMutable<LoDTensor>();
+    float* root = root_tensor->data<float>();
+    float scale = 1.0f / replicas.size();
+    for (int64_t i = 0; i < root_tensor->numel(); ++i) {
+      float sum = 0;
+      for (float* replica : replicas) {
+        sum += replica[i];
+      }
+      root[i] = sum * scale;
+      for (float* replica : replicas) {
+        replica[i] = root[i];
+      }
+    }
+  }
+}
+
+void MultiTrainer::StartNumaSync() {
+  if (replica_var_names_.empty()) {
+    return;
+  }
+  stop_numa_sync_ = false;
+  numa_sync_thread_ = std::thread([this] {
+    std::unique_lock<std::mutex> lock(numa_sync_mutex_);
+    while (!numa_sync_cv_.wait_for(
+        lock, std::chrono::milliseconds(numa_sync_interval_ms_),
+        [this] { return stop_numa_sync_; })) {
+      AverageNumaReplicas();
+    }
+  });
+}
+
+void MultiTrainer::StopNumaSync() {
+  if (!numa_sync_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(numa_sync_mutex_);
+    stop_numa_sync_ = true;
+  }
+  numa_sync_cv_.notify_all();
+  numa_sync_thread_.join();
+  // The root scope holds the trained parameters.
+  AverageNumaReplicas();
+}
+
+void MultiTrainer::LogNumaStats() const {
+  double sec = (platform::PosixInNsec() - run_start_ns_) * 1e-9;
+  std::vector<WorkerMetricsSnapshot> metrics;
+  GetWorkerMetrics(&metrics);
+  for (size_t node = 0; node < numa_nodes_.size(); ++node) {
+    int64_t num_instances = 0;
+    int num_threads = 0;
+    for (int i = 0; i < thread_num_; ++i) {
+      if (thread_nodes_[i] == static_cast<int>(node)) {
+        num_instances += metrics[i].num_instances;
+        ++num_threads;
+      }
+    }
+    auto stat = platform::GetNumaStat(numa_nodes_[node].id);
+    auto delta = [&](const std::string& name) -> int64_t {
+      auto start = numa_stats_[node].find(name);
+      auto end = stat.find(name);
+      if (start == numa_stats_[node].end() || end == stat.end()) {
+        return 0;
+      }
+      return end->second - start->second;
+    };
+    // numa_miss counts the pages allocated on this node although another
+    // node was preferred, other_node the pages allocated here by a process
+    // running on another node.
+    LOG(INFO) << "NUMA node " << numa_nodes_[node].id << ": " << num_threads
+              << " threads, " << num_instances / sec << " instances/s, "
+              << "numa_hit " << delta("numa_hit") << " numa_miss "
+              << delta("numa_miss") << " other_node " << delta("other_node")
+              << " pages";
   }
 }
 
 void MultiTrainer::Run() {
   VLOG(3) << "Going to run";
+  run_start_ns_ = platform::PosixInNsec();
   for (int thidx = 0; thidx < thread_num_; ++thidx) {
-    if (!debug_) {
-      threads_.push_back(
-          std::thread(&DeviceWorker::TrainFiles, workers_[thidx].get()));
-    } else {
-      threads_.push_back(std::thread(&DeviceWorker::TrainFilesWithProfiler,
-                                     workers_[thidx].get()));
-    }
+    threads_.push_back(StartWorkerThread(thidx));
   }
+  StartNumaSync();
+  StartMetricsReporter();
 }
 
 void MultiTrainer::Finalize() {
   for (auto& th : threads_) {
     th.join();
   }
+  StopNumaSync();
+  StopMetricsReporter();
+  if (binding_cpu_) {
+    LogNumaStats();
+  }
+  replica_scopes_.clear();
   root_scope_->DropKids();
 }
 
+void MultiTrainer::GetWorkerMetrics(
+    std::vector<WorkerMetricsSnapshot>* workers) const {
+  workers->clear();
+  for (auto& worker : workers_) {
+    workers->push_back(worker->GetMetrics().Snapshot());
+  }
+}
+
 }  // end namespace framework
 }  // end namespace paddle
@@ -12,7 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <ThreadPool.h>
+#include <algorithm>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "paddle/fluid/framework/feed_fetch_method.h"
@@ -22,10 +25,19 @@
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/string/pretty_log.h"
 
 namespace paddle {
 namespace framework {
+
+NaiveExecutor::NaiveExecutor(const platform::Place &place) : place_(place) {}
+
+NaiveExecutor::~NaiveExecutor() {
+  // Join the threads before the operators are destroyed.
+  pool_.reset();
+}
+
 void NaiveExecutor::Prepare(Scope *scope, const ProgramDesc &program_desc,
                             int block_id, bool with_feed_fetch_ops) {
   if (!scope) {
@@ -49,12 +61,178 @@ void NaiveExecutor::Run() {
                              "setting the cmake flag ON_INFER=ON if you are "
                              "running Paddle Inference";
 #endif  // PADDLE_ON_INFERENCE
+  if (pool_ != nullptr && checked_transfer_scopes_) {
+    RunParallel();
+    return;
+  }
   for (auto &op : ops_) {
     VLOG(4) << std::this_thread::get_id() << " run "
             << op->DebugStringEx(scope_) << " on scope " << scope_;
     op->SetIsCalledByExecutor(false);
     op->Run(*scope_, place_);
   }
+  if (pool_ != nullptr) {
+    // The first run after EnableInterOpParallelism is sequential, it tells
+    // whether some operators transform their inputs in child scopes.
+    checked_transfer_scopes_ = true;
+    for (auto &op : ops_) {
+      auto *kernel_op = dynamic_cast<OperatorWithKernel *>(op.get());
+      if (kernel_op != nullptr && kernel_op->TransferredData()) {
+        LOG(WARNING) << "The operator " << op->Type() << " transforms its "
+                     << "inputs in a child scope, the operators are run "
+                     << "sequentially";
+        pool_.reset();
+        break;
+      }
+    }
+  }
+}
+
+// Whether the operator runs a sub-block, and so creates child scopes.
+static bool HasSubBlock(const OperatorBase &op) {
+  for (auto &attr : op.Attrs()) {
+    if (attr.second.type() == typeid(BlockDesc *) ||               // NOLINT
+        attr.second.type() == typeid(std::vector<BlockDesc *>)) {  // NOLINT
+      return true;
+    }
+  }
+  return false;
+}
+
+void NaiveExecutor::EnableInterOpParallelism(int num_threads) {
+  pool_.reset();
+  checked_transfer_scopes_ = false;
+  if (num_threads <= 1) {
+    return;
+  }
+  // The scopes do not lock their kids with PADDLE_ON_INFERENCE, so the
+  // operators that create scopes can not run concurrently.
+  for (auto &op : ops_) {
+    if (HasSubBlock(*op)) {
+      LOG(WARNING) << "The operator " << op->Type() << " runs a sub-block, "
+                   << "the operators are run sequentially";
+      return;
+    }
+  }
+  BuildOpDependencies();
+  pool_.reset(new ::ThreadPool(num_threads));
+  VLOG(3) << "NaiveExecutor runs " << ops_.size() << " ops on " << num_threads
+          << " threads, " << bootstrap_ops_.size() << " of them are ready "
+          << "at the start";
+}
+
+void NaiveExecutor::BuildOpDependencies() {
+  const size_t num_ops = ops_.size();
+  pending_ops_.assign(num_ops, std::vector<size_t>());
+  op_deps_.assign(num_ops, 0);
+  bootstrap_ops_.clear();
+  running_deps_.reset(new std::atomic<int>[num_ops]);
+
+  // The last operator that wrote each variable, and the operators that read
+  // the variable after that write.
+  std::unordered_map<std::string, size_t> last_writer;
+  std::unordered_map<std::string, std::vector<size_t>> readers;
+  std::vector<size_t> deps;
+  for (size_t i = 0; i < num_ops; ++i) {
+    auto inputs = ops_[i]->InputVars();
+    auto outputs = ops_[i]->OutputVars(true);
+    deps.clear();
+    for (auto &name : inputs) {
+      auto it = last_writer.find(name);
+      if (it != last_writer.end()) deps.push_back(it->second);
+    }
+    for (auto &name : outputs) {
+      auto it = last_writer.find(name);
+      if (it != last_writer.end()) deps.push_back(it->second);
+      auto &var_readers = readers[name];
+      deps.insert(deps.end(), var_readers.begin(), var_readers.end());
+    }
+    for (auto &name : inputs) {
+      readers[name].push_back(i);
+    }
+    for (auto &name : outputs) {
+      last_writer[name] = i;
+      readers[name].clear();
+    }
+
+    std::sort(deps.begin(), deps.end());
+    deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+    for (size_t dep : deps) {
+      if (dep == i) continue;
+      pending_ops_[dep].push_back(i);
+      ++op_deps_[i];
+    }
+    if (op_deps_[i] == 0) {
+      bootstrap_ops_.push_back(i);
+    }
+  }
+}
+
+void NaiveExecutor::RunParallel() {
+  for (size_t i = 0; i < ops_.size(); ++i) {
+    running_deps_[i] = op_deps_[i];
+  }
+  exception_.Clear();
+  num_completed_ops_ = 0;
+  // The intra-op thread budget is per thread, pass the one of the caller to
+  // the pool threads.
+  int num_intra_op_threads = platform::GetNumThreads();
+  for (size_t op_idx : bootstrap_ops_) {
+    RunOpAsync(op_idx, num_intra_op_threads);
+  }
+  {
+    std::unique_lock<std::mutex> lock(finish_mutex_);
+    finish_cv_.wait(lock, [this] { return remaining_tasks_ == 0; });
+  }
+  if (exception_.IsCaught()) {
+    exception_.ReThrow();
+  }
+  PADDLE_ENFORCE_EQ(num_completed_ops_.load(), ops_.size(),
+                    "Some operators are not run, the dependencies of the "
+                    "operators may contain a cycle");
+}
+
+void NaiveExecutor::RunOpAsync(size_t op_idx, int num_intra_op_threads) {
+  ++remaining_tasks_;
+  pool_->enqueue([this, op_idx, num_intra_op_threads] {
+    if (platform::GetNumThreads() != num_intra_op_threads) {
+      platform::SetNumThreads(num_intra_op_threads);
+    }
+    size_t op_to_run = op_idx;
+    bool has_op = true;
+    while (has_op && !exception_.IsCaught()) {
+      auto &op = ops_[op_to_run];
+      VLOG(4) << std::this_thread::get_id() << " run "
+              << op->DebugStringEx(scope_) << " on scope " << scope_;
+      try {
+        op->SetIsCalledByExecutor(false);
+        op->Run(*scope_, place_);
+      } catch (...) {
+        exception_.Catch(std::current_exception());
+        break;
+      }
+      ++num_completed_ops_;
+
+      // Keep running one of the ready operators on this thread, and hand the
+      // others to the pool.
+      has_op = false;
+      size_t next_op = 0;
+      for (size_t pending_op : pending_ops_[op_to_run]) {
+        if (running_deps_[pending_op].fetch_sub(1) != 1) continue;
+        if (!has_op) {
+          next_op = pending_op;
+          has_op = true;
+        } else {
+          RunOpAsync(pending_op, num_intra_op_threads);
+        }
+      }
+      op_to_run = next_op;
+    }
+    if (--remaining_tasks_ == 0) {
+      std::lock_guard<std::mutex> lock(finish_mutex_);
+      finish_cv_.notify_all();
+    }
+  });
 }
 
 void NaiveExecutor::CreateVariables(const ProgramDesc &desc, int block_id,
@@ -125,6 +303,9 @@ void NaiveExecutor::CleanFeedFetchOps() {
     }
   }
   ops_.swap(ops);
+  if (pool_ != nullptr) {
+    BuildOpDependencies();
+  }
 }
 
 }  // namespace framework
@@ -14,23 +14,34 @@
 
 #pragma once
 
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <vector>
+#include "paddle/fluid/framework/details/exception_holder.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/framework/program_desc.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/platform/device_context.h"
 
+class ThreadPool;
+
 namespace paddle {
 namespace framework {
 
 /*
- * Simple, intuitive and effective. Only single thread is supported, and
- * currently designed for inference.
+ * Simple, intuitive and effective. Currently designed for inference.
+ *
+ * The operators run in program order on the calling thread, unless
+ * EnableInterOpParallelism is called. Then the operators that do not depend
+ * on each other run concurrently on a thread pool.
  */
 class NaiveExecutor {
  public:
-  explicit NaiveExecutor(const platform::Place& place) : place_(place) {}
+  explicit NaiveExecutor(const platform::Place& place);
+  ~NaiveExecutor();
 
   // Create child scope.
   // Create variables.
@@ -44,6 +55,16 @@ class NaiveExecutor {
   void CreateVariables(const ProgramDesc& desc, int block_id, bool persistable,
                        Scope* scope);
 
+  // Run the operators on num_threads threads, each operator starts once all
+  // the earlier operators that write its inputs and outputs, or read its
+  // outputs, are finished. So every variable sees the same reads and writes
+  // as in program order, and the results do not depend on the schedule.
+  // The scopes are not locked with PADDLE_ON_INFERENCE, so the operators
+  // run sequentially if some of them run sub-blocks, or transform their
+  // inputs in child scopes in the first run, e.g. with MKLDNN.
+  // Call it after Prepare, num_threads <= 1 turns the sequential run back on.
+  void EnableInterOpParallelism(int num_threads);
+
   // Run all the operators.
   void Run();
 
@@ -59,10 +80,31 @@ class NaiveExecutor {
                  bool with_feed_fetch_ops);
 
  private:
+  // Build pending_ops_ and op_deps_ from the variables of ops_.
+  void BuildOpDependencies();
+
+  void RunParallel();
+
+  void RunOpAsync(size_t op_idx, int num_intra_op_threads);
+
   const platform::Place place_;
   // Catch the required resource to avoid recreate.
   std::vector<std::unique_ptr<OperatorBase>> ops_;
   Scope* scope_;
+
+  // For the inter-op parallel run, the operators that wait for each
+  // operator, and the number of operators each operator waits for.
+  std::vector<std::vector<size_t>> pending_ops_;
+  std::vector<int> op_deps_;
+  std::vector<size_t> bootstrap_ops_;
+  std::unique_ptr<std::atomic<int>[]> running_deps_;
+  std::atomic<int> remaining_tasks_{0};
+  std::atomic<size_t> num_completed_ops_{0};
+  details::ExceptionHolder exception_;
+  std::mutex finish_mutex_;
+  std::condition_variable finish_cv_;
+  std::unique_ptr<::ThreadPool> pool_;
+  bool checked_transfer_scopes_{false};
 };
 
 }  // namespace framework
@@ -64,7 +64,116 @@ TEST(NaiveExecutor, Basic) {
   }
 }
 
+TEST(NaiveExecutor, InterOpParallelism) {
+  // Two branches a + b -> c and b + b -> d join in e = c + d, then c is
+  // written again by c = e + a, which must wait for the read of c.
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto name : {"a", "b", "c", "d", "e"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto add_op = [&](const std::string& x, const std::string& y,
+                    const std::string& out) {
+    auto* add = main_block->AppendOp();
+    add->SetType("elementwise_add");
+    add->SetInput("X", {x});
+    add->SetInput("Y", {y});
+    add->SetOutput("Out", {out});
+  };
+  add_op("a", "b", "c");
+  add_op("b", "b", "d");
+  add_op("c", "d", "e");
+  add_op("e", "a", "c");
+
+  platform::CPUPlace place;
+  Scope scope;
+  NaiveExecutor exe(place);
+  exe.CreateVariables(program, 0, false, &scope);
+  exe.Prepare(&scope, program, 0, false);
+  exe.EnableInterOpParallelism(4);
+  auto* a_tensor = exe.FindTensor("a");
+  auto* b_tensor = exe.FindTensor("b");
+  a_tensor->Resize({1, 4});
+  b_tensor->Resize({1, 4});
+  auto* a_data = a_tensor->mutable_data<float>(place);
+  auto* b_data = b_tensor->mutable_data<float>(place);
+  for (int i = 0; i < 4; ++i) {
+    a_data[i] = i;
+    b_data[i] = 0.1 * i;
+  }
+
+  for (int repeat = 0; repeat < 10; ++repeat) {
+    exe.Run();
+    auto* c_data = exe.FindTensor("c")->data<float>();
+    auto* e_data = exe.FindTensor("e")->data<float>();
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_NEAR(e_data[i], 1.3 * i, 1e-3);
+      EXPECT_NEAR(c_data[i], 2.3 * i, 1e-3);
+    }
+  }
+}
+
+TEST(NaiveExecutor, InterOpParallelismWithTransferScope) {
+  // The NHWC tensor a is transformed to NCHW in a child scope before the
+  // transpose, while b + b -> d does not depend on it.
+  ProgramDesc program;
+  auto* main_block = program.MutableBlock(0);
+  for (auto name : {"a", "b", "t", "d"}) {
+    main_block->Var(name)->SetType(proto::VarType::LOD_TENSOR);
+  }
+  auto* transpose = main_block->AppendOp();
+  transpose->SetType("transpose");
+  transpose->SetInput("X", {"a"});
+  transpose->SetOutput("Out", {"t"});
+  transpose->SetAttr("axis", std::vector<int>({0, 1, 2, 3}));
+  transpose->SetAttr("data_format", std::string("NCHW"));
+  auto* add = main_block->AppendOp();
+  add->SetType("elementwise_add");
+  add->SetInput("X", {"b"});
+  add->SetInput("Y", {"b"});
+  add->SetOutput("Out", {"d"});
+
+  platform::CPUPlace place;
+  Scope scope;
+  NaiveExecutor exe(place);
+  exe.CreateVariables(program, 0, false, &scope);
+  exe.Prepare(&scope, program, 0, false);
+  exe.EnableInterOpParallelism(4);
+  auto* a_tensor = exe.FindTensor("a");
+  auto* b_tensor = exe.FindTensor("b");
+  a_tensor->Resize({1, 2, 2, 3});
+  a_tensor->set_layout(DataLayout::kNHWC);
+  b_tensor->Resize({1, 4});
+  auto* a_data = a_tensor->mutable_data<float>(place);
+  auto* b_data = b_tensor->mutable_data<float>(place);
+  for (int i = 0; i < 12; ++i) {
+    a_data[i] = i;
+  }
+  for (int i = 0; i < 4; ++i) {
+    b_data[i] = 0.1 * i;
+  }
+
+  for (int repeat = 0; repeat < 10; ++repeat) {
+    exe.Run();
+    auto* t_tensor = exe.FindTensor("t");
+    ASSERT_EQ(t_tensor->dims(), make_ddim({1, 3, 2, 2}));
+    auto* t_data = t_tensor->data<float>();
+    for (int c = 0; c < 3; ++c) {
+      for (int hw = 0; hw < 4; ++hw) {
+        EXPECT_EQ(t_data[c * 4 + hw], a_data[hw * 3 + c]);
+      }
+    }
+    auto* d_data = exe.FindTensor("d")->data<float>();
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_NEAR(d_data[i], 0.2 * i, 1e-3);
+    }
+    // The transfer scopes of the CPU kernels are deleted after each run.
+    EXPECT_TRUE(scope.kids().empty());
+  }
+}
+
 }  // namespace framework
 }  // namespace paddle
 
 USE_OP(elementwise_add);
+USE_OP(transpose);
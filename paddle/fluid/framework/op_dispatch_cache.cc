@@ -0,0 +1,78 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/op_dispatch_cache.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/selected_rows.h"
+#include "paddle/fluid/framework/variable.h"
+
+namespace paddle {
+namespace framework {
+
+bool OpDispatchCache::Signature::operator==(const Signature &other) const {
+  if (kind != other.kind) return false;
+  if (kind != kTensor) return true;
+  return type == other.type && layout == other.layout &&
+         platform::is_same_place(place, other.place);
+}
+
+OpDispatchCache::Signature OpDispatchCache::SignatureOf(const Variable *var) {
+  Signature sig;
+  const Tensor *tensor = nullptr;
+  if (var == nullptr) {
+    return sig;
+  } else if (var->IsType<LoDTensor>()) {
+    tensor = &var->Get<LoDTensor>();
+  } else if (var->IsType<SelectedRows>()) {
+    tensor = &var->Get<SelectedRows>().value();
+  } else {
+    return sig;
+  }
+  if (!tensor->IsInitialized()) {
+    sig.kind = Signature::kUninitialized;
+    return sig;
+  }
+  sig.kind = Signature::kTensor;
+  sig.type = tensor->type();
+  sig.place = tensor->place();
+  sig.layout = tensor->layout();
+  return sig;
+}
+
+bool OpDispatchCache::Hit(const VariableValueMap &inputs) const {
+  if (!recorded_) return false;
+  size_t i = 0;
+  for (auto &pair : inputs) {
+    for (auto *var : pair.second) {
+      if (i == inputs_.size() || !(SignatureOf(var) == inputs_[i])) {
+        return false;
+      }
+      ++i;
+    }
+  }
+  return i == inputs_.size();
+}
+
+void OpDispatchCache::Record(const VariableValueMap &inputs) {
+  inputs_.clear();
+  for (auto &pair : inputs) {
+    for (auto *var : pair.second) {
+      inputs_.push_back(SignatureOf(var));
+    }
+  }
+  recorded_ = true;
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,66 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include "paddle/fluid/framework/data_layout.h"
+#include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/type_defs.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * The dispatch record of an operator, it remembers the data type, place and
+ * layout of the tensors of its inputs in a run whose kernel needed no data
+ * transform. The kernel of an operator is chosen once, and the transforms
+ * PrepareData() decides only depend on the kernel and on these properties, so
+ * when the next run has the same inputs, PrepareData() can be skipped.
+ *
+ * An operator instance is not run by several threads at once, so the record
+ * is not locked.
+ */
+class OpDispatchCache {
+ public:
+  // The properties of an input slot that the data transforms depend on.
+  struct Signature {
+    enum Kind { kNoTensor, kUninitialized, kTensor };
+    Kind kind{kNoTensor};
+    proto::VarType::Type type{proto::VarType::FP32};
+    platform::Place place;
+    DataLayout layout{DataLayout::kAnyLayout};
+
+    bool operator==(const Signature &other) const;
+  };
+
+  // Whether inputs match the record of a run without data transform.
+  bool Hit(const VariableValueMap &inputs) const;
+
+  // Record inputs after a run which needed no data transform.
+  void Record(const VariableValueMap &inputs);
+
+  // Forget the record after a run which transformed some inputs.
+  void Clear() { recorded_ = false; }
+
+ private:
+  static Signature SignatureOf(const Variable *var);
+
+  bool recorded_{false};
+  std::vector<Signature> inputs_;
+};
+
+}  // namespace framework
+}  // namespace paddle
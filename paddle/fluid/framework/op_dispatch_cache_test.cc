@@ -0,0 +1,88 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/op_dispatch_cache.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/variable.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(OpDispatchCache, HitSameInputs) {
+  platform::CPUPlace place;
+  Variable x, y;
+  auto* x_tensor = x.GetMutable<LoDTensor>();
+  x_tensor->Resize(make_ddim({4, 8}));
+  x_tensor->mutable_data<float>(place);
+  y.GetMutable<LoDTensor>();
+  VariableValueMap inputs{{"X", {&x}}, {"Y", {&y}}, {"Z", {nullptr}}};
+
+  OpDispatchCache cache;
+  EXPECT_FALSE(cache.Hit(inputs));
+  cache.Record(inputs);
+  EXPECT_TRUE(cache.Hit(inputs));
+
+  // The shape does not matter.
+  x_tensor->Resize(make_ddim({2, 8}));
+  EXPECT_TRUE(cache.Hit(inputs));
+
+  // Nor the variables, e.g. in a new local scope.
+  Variable new_x;
+  auto* new_x_tensor = new_x.GetMutable<LoDTensor>();
+  new_x_tensor->Resize(make_ddim({4, 8}));
+  new_x_tensor->mutable_data<float>(place);
+  VariableValueMap new_inputs{{"X", {&new_x}}, {"Y", {&y}}, {"Z", {nullptr}}};
+  EXPECT_TRUE(cache.Hit(new_inputs));
+
+  cache.Clear();
+  EXPECT_FALSE(cache.Hit(inputs));
+}
+
+TEST(OpDispatchCache, MissChangedInputs) {
+  platform::CPUPlace place;
+  Variable x, y;
+  auto* x_tensor = x.GetMutable<LoDTensor>();
+  x_tensor->Resize(make_ddim({4, 8}));
+  x_tensor->mutable_data<float>(place);
+  auto* y_tensor = y.GetMutable<LoDTensor>();
+  VariableValueMap inputs{{"X", {&x}}, {"Y", {&y}}};
+
+  OpDispatchCache cache;
+  cache.Record(inputs);
+
+  // Another data type.
+  x_tensor->mutable_data<double>(place);
+  EXPECT_FALSE(cache.Hit(inputs));
+  x_tensor->mutable_data<float>(place);
+  EXPECT_TRUE(cache.Hit(inputs));
+
+  // Another layout.
+  x_tensor->set_layout(DataLayout::kNHWC);
+  EXPECT_FALSE(cache.Hit(inputs));
+  x_tensor->set_layout(DataLayout::kNCHW);
+
+  // An input initialized since.
+  y_tensor->Resize(make_ddim({1}));
+  y_tensor->mutable_data<float>(place);
+  EXPECT_FALSE(cache.Hit(inputs));
+
+  // Another number of inputs.
+  cache.Record(inputs);
+  inputs["X"].push_back(&x);
+  EXPECT_FALSE(cache.Hit(inputs));
+}
+
+}  // namespace framework
+}  // namespace paddle
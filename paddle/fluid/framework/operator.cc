@@ -37,6 +37,14 @@ DEFINE_int32(inner_op_parallelism, 0, "number of threads for inner op");
 DEFINE_bool(fast_check_nan_inf, false,
             "Fast checking NAN/INF after each operation. It will be a little"
             "bit slow, much faster than check_nan_inf");
+DEFINE_bool(cache_infer_shape, false,
+            "Skip the InferShape of an operator when its inputs have the same "
+            "dims and LoD as in its last run, and reuse the output shapes of "
+            "that run. It saves time for models run with fixed input shapes.");
+DEFINE_bool(cache_op_dispatch, false,
+            "Skip the data transform checks of an operator when its inputs "
+            "have the same data types, places and layouts as in its last run, "
+            "which needed no transform.");
 
 namespace paddle {
 namespace framework {
@@ -897,8 +905,27 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
 
   // do data transformScope &transfer_scope;
   std::vector<std::string> transfered_inplace_vars;
-  auto* transfer_scope =
-      PrepareData(scope, *kernel_type_, &transfered_inplace_vars, runtime_ctx);
+  Scope* transfer_scope = nullptr;
+  if (FLAGS_cache_op_dispatch) {
+    if (dispatch_cache_ == nullptr) {
+      dispatch_cache_.reset(new OpDispatchCache());
+    }
+    if (!dispatch_cache_->Hit(runtime_ctx->inputs)) {
+      transfer_scope = PrepareData(scope, *kernel_type_,
+                                   &transfered_inplace_vars, runtime_ctx);
+      // The inputs are replaced by the transformed ones then.
+      if (transfer_scope == nullptr) {
+        dispatch_cache_->Record(runtime_ctx->inputs);
+      } else {
+        dispatch_cache_->Clear();
+      }
+    }
+  } else {
+    transfer_scope = PrepareData(scope, *kernel_type_,
+                                 &transfered_inplace_vars, runtime_ctx);
+  }
+
+  transferred_data_ = transfer_scope != nullptr;
 
   // exec scope is the scope that kernel actually executed on.
   const Scope& exec_scope =
@@ -909,8 +936,13 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   }
 
   if (!all_kernels_must_compute_runtime_shape_) {
-    RuntimeInferShapeContext infer_shape_ctx(*this, exec_scope, *runtime_ctx);
-    this->InferShape(&infer_shape_ctx);
+    if (FLAGS_cache_infer_shape) {
+      CachedRuntimeInferShape(exec_scope, *runtime_ctx);
+    } else {
+      RuntimeInferShapeContext infer_shape_ctx(*this, exec_scope,
+                                               *runtime_ctx);
+      this->InferShape(&infer_shape_ctx);
+    }
   }
   // TODO(panyx0718): ExecutionContext should only depend on RuntimeContext
   // not Scope. Imperative mode only pass inputs and get outputs.
@@ -967,6 +999,23 @@ void OperatorWithKernel::RunImpl(const Scope& scope,
   }
 }
 
+void OperatorWithKernel::CachedRuntimeInferShape(
+    const Scope& scope, const RuntimeContext& ctx) const {
+  if (infer_shape_cache_ == nullptr) {
+    infer_shape_cache_.reset(new InferShapeCache());
+    infer_shape_counter_ = InferShapeCacheStats::Instance().Get(type_);
+  }
+  if (infer_shape_cache_->Apply(ctx.inputs, ctx.outputs)) {
+    infer_shape_counter_->skipped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  infer_shape_cache_->RecordInputs(ctx.inputs);
+  RuntimeInferShapeContext infer_shape_ctx(*this, scope, ctx);
+  this->InferShape(&infer_shape_ctx);
+  infer_shape_cache_->RecordOutputs(ctx.outputs);
+  infer_shape_counter_->inferred.fetch_add(1, std::memory_order_relaxed);
+}
+
 void OperatorWithKernel::ChooseKernel(const RuntimeContext& ctx,
                                       const Scope& scope,
                                       const platform::Place& place) const {
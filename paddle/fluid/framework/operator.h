@@ -28,7 +28,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/attribute.h"
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/framework/framework.pb.h"
+#include "paddle/fluid/framework/infer_shape_cache.h"
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/op_dispatch_cache.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/op_kernel_type.h"
 #include "paddle/fluid/framework/operator_kernel_configs.h"
@@ -469,6 +471,10 @@ class OperatorWithKernel : public OperatorBase {
       const std::string& var_name, const Tensor& tensor,
       const OpKernelType& expected_kernel_type) const;
 
+  // Whether the last run transformed some inputs into a child scope of the
+  // scope it ran on.
+  bool TransferredData() const { return transferred_data_; }
+
  private:
   // indicate kernel DataType by input data. By default all input data must be
   // same.
@@ -495,6 +501,11 @@ class OperatorWithKernel : public OperatorBase {
   void ChooseKernel(const RuntimeContext& ctx, const Scope& scope,
                     const platform::Place& place) const;
 
+  // Run InferShape() unless the inputs have the shapes of the last run, then
+  // set the outputs to the shapes of the last run.
+  void CachedRuntimeInferShape(const Scope& scope,
+                               const RuntimeContext& ctx) const;
+
  protected:
   mutable OpKernelConfigsMap kernel_configs_map_;
   mutable std::unique_ptr<OpKernelType> kernel_type_;
@@ -505,6 +516,10 @@ class OperatorWithKernel : public OperatorBase {
   mutable bool all_kernels_must_compute_runtime_shape_ = false;
   mutable std::mutex cache_update_mutex_;
   mutable bool enable_cache_transfer_scope_ = false;
+  mutable bool transferred_data_ = false;
+  mutable std::unique_ptr<InferShapeCache> infer_shape_cache_;
+  mutable InferShapeCacheStats::Counter* infer_shape_counter_ = nullptr;
+  mutable std::unique_ptr<OpDispatchCache> dispatch_cache_;
 };
 
 extern bool OpSupportGPU(const std::string& op_type);
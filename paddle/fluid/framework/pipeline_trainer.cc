@@ -13,10 +13,16 @@
 // limitations under the License.
 
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
 #include "paddle/fluid/framework/data_feed_factory.h"
 #include "paddle/fluid/framework/device_worker_factory.h"
 #include "paddle/fluid/framework/trainer.h"
 #include "paddle/fluid/framework/trainer_desc.pb.h"
+#include "paddle/fluid/platform/device_tracer.h"
 
 namespace paddle {
 namespace framework {
@@ -41,11 +47,33 @@ void PipelineTrainer::Initialize(const TrainerDesc& trainer_desc,
   VLOG(3) << "section num: " << section_num_;
   VLOG(3) << "sync_steps: " << sync_steps_;
 
+  adaptive_concurrency_ = pipeline_config_.adaptive_concurrency();
+  balance_interval_ms_ = pipeline_config_.balance_interval_ms();
+  int adaptive_threads = 0;
+  if (adaptive_concurrency_) {
+    for (int i = 1; i < section_num_; ++i) {
+      const auto& section_config = pipeline_config_.section_config(i);
+      if (section_config.place() == SectionConfig::CPUPlace) {
+        adaptive_sections_.push_back(i);
+        adaptive_threads += section_config.concurrency();
+      }
+    }
+    if (adaptive_sections_.size() < 2) {
+      VLOG(3) << "adaptive concurrency needs two CPU sections after the "
+                 "first one";
+      adaptive_concurrency_ = false;
+      adaptive_sections_.clear();
+    }
+  }
+  VLOG(3) << "adaptive concurrency: " << adaptive_concurrency_;
+
   workers_.resize(section_num_);
   in_var_names_.resize(section_num_);
   out_var_names_.resize(section_num_);
   worker_count_.resize(section_num_);
   worker_count_mutex_.resize(section_num_);
+  section_stats_.resize(section_num_);
+  section_throttles_.resize(section_num_);
   param_need_sync_.reset(new std::vector<std::string>);
 
   int reader_index = 0;
@@ -60,17 +88,26 @@ void PipelineTrainer::Initialize(const TrainerDesc& trainer_desc,
     out_var_names_[i].reset(new std::vector<std::string>(
         section_config.section_out_var_names().begin(),
         section_config.section_out_var_names().end()));
+    int num_workers = concurrency;
+    if (IsAdaptiveSection(i)) {
+      num_workers =
+          adaptive_threads - static_cast<int>(adaptive_sections_.size()) + 1;
+    }
     worker_count_[i].resize(pipeline_num_);
     worker_count_mutex_[i].resize(pipeline_num_);
     for (int j = 0; j < pipeline_num_; ++j) {
-      worker_count_[i][j] = new int(concurrency);
+      worker_count_[i][j] = new int(num_workers);
       worker_count_mutex_[i][j].reset(new std::mutex);
+      section_stats_[i].emplace_back(new SectionStats);
+      if (IsAdaptiveSection(i)) {
+        section_throttles_[i].emplace_back(new SectionThrottle(concurrency));
+      }
     }
 
     platform::Place place;
     workers_[i].resize(pipeline_num_);
     for (int j = 0; j < pipeline_num_; ++j) {
-      workers_[i][j].resize(concurrency);
+      workers_[i][j].resize(num_workers);
 
       switch (section_config.place()) {
         case SectionConfig::CPUPlace:
@@ -88,7 +125,7 @@ void PipelineTrainer::Initialize(const TrainerDesc& trainer_desc,
                          section_config.place());
       }
 
-      for (int k = 0; k < concurrency; ++k) {
+      for (int k = 0; k < num_workers; ++k) {
         workers_[i][j][k] = DeviceWorkerFactory::CreateDeviceWorker(
             trainer_desc.device_worker_name());
         auto this_worker =
@@ -181,6 +218,10 @@ void PipelineTrainer::InitTrainerEnv(const ProgramDesc& main_program,
                                        ? scope_queues_[0][j].get()
                                        : scope_queues_[i + 1][j].get());
         this_worker->SetVarNames(*in_var_names_[i], *out_var_names_[i]);
+        this_worker->SetSectionStats(section_stats_[i][j].get());
+        if (IsAdaptiveSection(i)) {
+          this_worker->SetSectionThrottle(section_throttles_[i][j].get());
+        }
         if (i != section_num_ - 1) {
           // For data copy in adjacent different place
           this_worker->SetNextSectionPlace(
@@ -230,8 +271,106 @@ void PipelineTrainer::construct_sync_functor() {
   }
 }
 
+bool PipelineTrainer::IsAdaptiveSection(int section_id) const {
+  return std::find(adaptive_sections_.begin(), adaptive_sections_.end(),
+                   section_id) != adaptive_sections_.end();
+}
+
+void PipelineTrainer::BalanceSections() {
+  std::vector<std::vector<std::pair<int64_t, int64_t>>> last(
+      pipeline_num_, std::vector<std::pair<int64_t, int64_t>>(
+                         adaptive_sections_.size(), std::make_pair(0, 0)));
+  std::unique_lock<std::mutex> lock(balance_mutex_);
+  while (!balance_cv_.wait_for(lock,
+                               std::chrono::milliseconds(balance_interval_ms_),
+                               [this] { return stop_balance_; })) {
+    for (int j = 0; j < pipeline_num_; ++j) {
+      BalancePipeline(j, &last[j]);
+    }
+  }
+}
+
+void PipelineTrainer::BalancePipeline(
+    int pipeline_id, std::vector<std::pair<int64_t, int64_t>>* last) {
+  size_t num_sections = adaptive_sections_.size();
+  std::vector<double> batch_us(num_sections);
+  std::vector<int> permits(num_sections);
+  bool all_ran = true;
+  for (size_t s = 0; s < num_sections; ++s) {
+    int i = adaptive_sections_[s];
+    auto* stats = section_stats_[i][pipeline_id].get();
+    int64_t num_batches = stats->num_batches.load();
+    int64_t busy_us = stats->busy_us.load();
+    int64_t new_batches = num_batches - (*last)[s].first;
+    batch_us[s] = static_cast<double>(busy_us - (*last)[s].second) /
+                  std::max<int64_t>(new_batches, 1);
+    permits[s] = section_throttles_[i][pipeline_id]->Permits();
+    all_ran = all_ran && new_batches > 0;
+    (*last)[s] = std::make_pair(num_batches, busy_us);
+  }
+  if (!all_ran) return;
+
+  // The throughput of a section is about its threads over the time of a
+  // batch.
+  auto throughput = [&](size_t s, int threads) -> double {
+    return threads / std::max(batch_us[s], 1.0);
+  };
+  size_t slowest = 0;
+  for (size_t s = 1; s < num_sections; ++s) {
+    if (throughput(s, permits[s]) < throughput(slowest, permits[slowest])) {
+      slowest = s;
+    }
+  }
+  int fastest = -1;
+  for (size_t s = 0; s < num_sections; ++s) {
+    if (s == slowest || permits[s] <= 1) continue;
+    if (fastest < 0 ||
+        throughput(s, permits[s]) > throughput(fastest, permits[fastest])) {
+      fastest = static_cast<int>(s);
+    }
+  }
+  // Only move a thread when the donor stays faster than the slowest section
+  // is now, otherwise the threads would swing between the two.
+  if (fastest < 0 || throughput(fastest, permits[fastest] - 1) <=
+                         throughput(slowest, permits[slowest])) {
+    return;
+  }
+  int from = adaptive_sections_[fastest];
+  int to = adaptive_sections_[slowest];
+  section_throttles_[from][pipeline_id]->SetPermits(permits[fastest] - 1);
+  section_throttles_[to][pipeline_id]->SetPermits(permits[slowest] + 1);
+  VLOG(1) << "pipeline " << pipeline_id << ": move a thread from section "
+          << from << " (" << batch_us[fastest] << " us/batch, "
+          << permits[fastest] << " threads) to section " << to << " ("
+          << batch_us[slowest] << " us/batch, " << permits[slowest]
+          << " threads)";
+}
+
+void PipelineTrainer::LogSectionStats() const {
+  double elapsed_s = (platform::PosixInNsec() - run_start_ns_) * 1e-9;
+  for (int i = 0; i < section_num_; ++i) {
+    for (int j = 0; j < pipeline_num_; ++j) {
+      auto* stats = section_stats_[i][j].get();
+      int64_t num_batches = stats->num_batches.load();
+      std::string threads;
+      if (IsAdaptiveSection(i)) {
+        threads = ", " + std::to_string(section_throttles_[i][j]->Permits()) +
+                  " threads at last";
+      }
+      LOG(INFO) << "pipeline " << j << " section " << i << ": "
+                << num_batches / std::max(elapsed_s, 1e-9) << " batches/s, "
+                << stats->busy_us.load() / std::max<int64_t>(num_batches, 1)
+                << " us/batch busy, " << stats->in_wait_us.load() / 1000
+                << " ms waiting for input, "
+                << stats->out_wait_us.load() / 1000
+                << " ms waiting for output" << threads;
+    }
+  }
+}
+
 void PipelineTrainer::Run() {
   VLOG(3) << "Going to run";
+  run_start_ns_ = platform::PosixInNsec();
   for (int i = 0; i < section_num_; ++i) {
     for (int j = 0; j < pipeline_num_; ++j) {
       for (size_t k = 0; k < workers_[i][j].size(); ++k) {
@@ -245,12 +384,24 @@ void PipelineTrainer::Run() {
       }
     }
   }
+  if (adaptive_concurrency_) {
+    balance_thread_ = std::thread(&PipelineTrainer::BalanceSections, this);
+  }
 }
 
 void PipelineTrainer::Finalize() {
   for (auto& th : section_threads_) {
     th.join();
   }
+  if (balance_thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> guard(balance_mutex_);
+      stop_balance_ = true;
+    }
+    balance_cv_.notify_all();
+    balance_thread_.join();
+  }
+  LogSectionStats();
   for (const auto& var : *param_need_sync_) {
     auto* root_tensor = root_scope_->Var(var)->GetMutable<LoDTensor>();
     // TODO(hutuxian): Add a final all-reduce?
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/program_desc.h"
+#include <atomic>
 #include "paddle/fluid/framework/block_desc.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/version.h"
@@ -92,7 +93,13 @@ ProgramDesc::ProgramDesc(const proto::ProgramDesc &desc) {
   InitFromProto();
 }
 
+uint64_t ProgramDesc::NewId() {
+  static std::atomic<uint64_t> next_id{0};
+  return next_id++;
+}
+
 void ProgramDesc::CopyFrom(const proto::ProgramDesc &desc) {
+  id_ = NewId();
   blocks_.clear();
   desc_ = desc;
   InitFromProto();
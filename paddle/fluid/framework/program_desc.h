@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -83,9 +84,17 @@ class ProgramDesc {
   // This function is used to change or unify the fetch_holder variables' name.
   void SetFetchHolderName(const std::string &fetch_holder_name);
 
+  // An id unique in the process, renewed by CopyFrom. Unlike the address of
+  // the program, it is never shared with a program destroyed before.
+  uint64_t Id() const { return id_; }
+
  private:
   void InitFromProto();
 
+  static uint64_t NewId();
+
+  uint64_t id_{NewId()};
+
   proto::ProgramDesc desc_;
 
   std::vector<std::unique_ptr<BlockDesc>> blocks_;
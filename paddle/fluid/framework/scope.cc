@@ -19,6 +19,8 @@ limitations under the License. */
 #include <set>
 #include <unordered_set>
 #include "glog/logging.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/lod_tensor_array.h"
 #include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/string/printf.h"
 
@@ -105,6 +107,53 @@ bool Scope::HasKid(const Scope* scope) const {
   return it != this->kids_.end();
 }
 
+std::unique_ptr<Scope> Scope::ReleaseKid(Scope* scope) const {
+  {
+    SCOPE_KIDS_WRITER_LOCK
+    auto it = std::find(this->kids_.begin(), this->kids_.end(), scope);
+    PADDLE_ENFORCE(it != this->kids_.end(), "%p Cannot find %p as kid scope",
+                   this, scope);
+    this->kids_.erase(it);
+  }
+  scope->parent_ = nullptr;
+  return std::unique_ptr<Scope>(scope);
+}
+
+Scope& Scope::AdoptKid(std::unique_ptr<Scope>&& scope) const {
+  PADDLE_ENFORCE(scope->parent_ == nullptr,
+                 "Only a scope without parent can be adopted");
+  Scope* child = scope.release();
+  child->parent_ = this;
+  {
+    SCOPE_KIDS_WRITER_LOCK
+    kids_.push_back(child);
+  }
+  return *child;
+}
+
+void Scope::Reset() {
+  DropKids();
+  SCOPE_VARS_WRITER_LOCK
+  for (auto& pair : vars_) {
+    auto* var = pair.second.get();
+    if (var->IsType<LoDTensor>()) {
+      auto* tensor = var->GetMutable<LoDTensor>();
+      // Memory shared with other tensors, e.g. by ShareDataWith, may still
+      // be used by them and is not written again.
+      if (tensor->Holder() != nullptr &&
+          (tensor->Holder().use_count() > 1 || tensor->offset() != 0)) {
+        tensor->clear();
+      }
+      tensor->Resize(make_ddim({0}));
+      tensor->set_lod(LoD());
+    } else if (var->IsType<LoDTensorArray>()) {
+      var->GetMutable<LoDTensorArray>()->clear();
+    } else {
+      var->Clear();
+    }
+  }
+}
+
 std::vector<std::string> Scope::LocalVarNames() const {
   std::vector<std::string> known_vars;
   {
@@ -93,6 +93,19 @@ class Scope {
   /// Find if a scope exists in the kid scopes
   bool HasKid(const Scope* scope) const;
 
+  /// Remove a kid scope from this scope without deleting it. The caller owns
+  /// the returned scope, which has no parent until it is adopted again.
+  std::unique_ptr<Scope> ReleaseKid(Scope* scope) const;
+
+  /// Make a scope returned by ReleaseKid a kid of this scope.
+  Scope& AdoptKid(std::unique_ptr<Scope>&& scope) const;
+
+  /// Drop all kids and clear the local variables for reuse. A LoDTensor keeps
+  /// its type and the memory only it holds, but gets empty dims and LoD, so
+  /// that the next mutable_data of the same size does not allocate. Tensor
+  /// arrays are emptied, the other variables cleared.
+  void Reset();
+
   const std::list<Scope*>& kids() const { return kids_; }
 
   // enumerate all the variables current contains.
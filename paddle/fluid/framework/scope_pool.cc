@@ -14,6 +14,11 @@
 
 #include "paddle/fluid/framework/scope_pool.h"
 #include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/string/printf.h"
+
+DEFINE_bool(reuse_step_scopes, true,
+            "Reuse the step scopes of while and recurrent operators across "
+            "iterations instead of deleting and creating them.");
 
 namespace paddle {
 namespace framework {
@@ -50,5 +55,94 @@ void ScopePool::Clear() {
   scopes_.clear();
 }
 
+// A loop with more steps deletes the scopes above this count.
+static constexpr size_t kMaxIdleStepScopes = 4096;
+// The scopes of a loop not used for this time are deleted.
+static constexpr int kMaxIdleSeconds = 60;
+static constexpr int kEvictIntervalSeconds = 10;
+
+Scope &StepScopePool::LoopScopes::NewScope(const Scope &parent) {
+  if (FLAGS_reuse_step_scopes) {
+    std::unique_ptr<Scope> scope;
+    {
+      std::lock_guard<std::mutex> guard(mtx_);
+      if (!idle_.empty()) {
+        scope = std::move(idle_.back());
+        idle_.pop_back();
+      }
+    }
+    if (scope) {
+      ++pool_->num_reused_;
+      return parent.AdoptKid(std::move(scope));
+    }
+  }
+  ++pool_->num_created_;
+  return parent.NewScope();
+}
+
+void StepScopePool::LoopScopes::DeleteScope(const Scope &parent,
+                                            Scope *scope) {
+  if (!FLAGS_reuse_step_scopes) {
+    parent.DeleteScope(scope);
+    return;
+  }
+  auto released = parent.ReleaseKid(scope);
+  released->Reset();
+  std::lock_guard<std::mutex> guard(mtx_);
+  if (idle_.size() < kMaxIdleStepScopes) {
+    idle_.emplace_back(std::move(released));
+  }
+}
+
+StepScopePool &StepScopePool::Instance() {  // NOLINT
+  static StepScopePool pool;
+  return pool;
+}
+
+std::string StepScopePool::Key(uint64_t program_id,
+                               const std::string &step_scopes_name) {
+  return string::Sprintf("%d/%s", program_id, step_scopes_name);
+}
+
+std::shared_ptr<StepScopePool::LoopScopes> StepScopePool::Get(
+    const std::string &key) {
+  std::lock_guard<std::mutex> guard(mtx_);
+  auto now = Clock::now();
+  if (now - last_evict_ > std::chrono::seconds(kEvictIntervalSeconds)) {
+    EvictIdle(now);
+  }
+  auto &entry = loops_[key];
+  if (entry.scopes == nullptr) {
+    entry.scopes = std::make_shared<LoopScopes>(this);
+  }
+  entry.last_used = now;
+  VLOG(10) << "Step scopes of " << key << ": created " << num_created_
+           << ", reused " << num_reused_;
+  return entry.scopes;
+}
+
+void StepScopePool::EvictIdle(Clock::time_point now) {
+  last_evict_ = now;
+  for (auto it = loops_.begin(); it != loops_.end();) {
+    if (now - it->second.last_used > std::chrono::seconds(kMaxIdleSeconds) &&
+        it->second.scopes.use_count() == 1) {
+      VLOG(3) << "Delete the idle step scopes of " << it->first;
+      it = loops_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+size_t StepScopePool::NumKeys() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  return loops_.size();
+}
+
+void StepScopePool::Clear() {
+  std::lock_guard<std::mutex> guard(mtx_);
+  loops_.clear();
+}
+
 }  // namespace framework
 }  // namespace paddle
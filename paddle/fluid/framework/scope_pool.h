@@ -14,9 +14,16 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
 #include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 #include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/macros.h"
 
 namespace paddle {
 namespace framework {
@@ -42,5 +49,81 @@ class ScopePool {
   std::mutex mtx_;
 };
 
+/*
+ * Recycles the step scopes of while and recurrent operators.
+ *
+ * In training every iteration of a loop runs in a new step scope, which is
+ * deleted with all its variables by the gradient operator. The pool keeps the
+ * released step scopes instead, and hands them out again in the next batch. A
+ * released scope is Reset: it keeps its variables and the memory of their
+ * tensors, so the step block of the next batch finds its variables created
+ * and its tensors allocated.
+ *
+ * The scopes are grouped by loop, see Key(). A loop op gets the LoopScopes of
+ * its key once per run, then takes and returns the scopes of its steps
+ * without touching the pool. The LoopScopes of a key not used for
+ * kMaxIdleSeconds are deleted, so the pool does not keep the scopes of
+ * programs that are not run any more.
+ */
+class StepScopePool {
+ public:
+  // The idle step scopes of one loop, shared by its forward and backward op.
+  class LoopScopes {
+   public:
+    explicit LoopScopes(StepScopePool *pool) : pool_(pool) {}
+
+    // Return an idle scope as a new kid of parent, or create one.
+    Scope &NewScope(const Scope &parent);
+
+    // Remove scope from the kids of parent and keep it for reuse.
+    void DeleteScope(const Scope &parent, Scope *scope);
+
+   private:
+    StepScopePool *pool_;
+    std::vector<std::unique_ptr<Scope>> idle_;
+    std::mutex mtx_;
+
+    DISABLE_COPY_AND_ASSIGN(LoopScopes);
+  };
+
+  static StepScopePool &Instance();  // NOLINT
+
+  // The key of the step scopes of the loop whose step block is in the program
+  // of program_id (ProgramDesc::Id), with the given step scopes variable.
+  static std::string Key(uint64_t program_id,
+                         const std::string &step_scopes_name);
+
+  // Get the scopes of the loop of key, once per run of the loop op.
+  std::shared_ptr<LoopScopes> Get(const std::string &key);
+
+  void Clear();
+
+  size_t NumCreated() const { return num_created_; }
+  size_t NumReused() const { return num_reused_; }
+  // The number of loops in the pool.
+  size_t NumKeys();
+
+ private:
+  StepScopePool() = default;
+
+  using Clock = std::chrono::steady_clock;
+
+  struct Entry {
+    std::shared_ptr<LoopScopes> scopes;
+    Clock::time_point last_used;
+  };
+
+  // Erase the entries not used since before now - kMaxIdleSeconds and not
+  // held by a running op. Run under mtx_ at most once per
+  // kEvictIntervalSeconds.
+  void EvictIdle(Clock::time_point now);
+
+  std::unordered_map<std::string, Entry> loops_;
+  Clock::time_point last_evict_{Clock::now()};
+  std::mutex mtx_;
+  std::atomic<size_t> num_created_{0};
+  std::atomic<size_t> num_reused_{0};
+};
+
 }  // namespace framework
 }  // namespace paddle
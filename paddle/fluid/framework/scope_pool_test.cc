@@ -0,0 +1,106 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/scope_pool.h"
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/lod_tensor_array.h"
+
+DECLARE_bool(reuse_step_scopes);
+
+namespace paddle {
+namespace framework {
+
+TEST(StepScopePool, ReuseReleasedScope) {
+  auto& pool = StepScopePool::Instance();
+  pool.Clear();
+  Scope parent;
+  auto loop = pool.Get(StepScopePool::Key(0, "step_scopes"));
+  platform::CPUPlace place;
+
+  size_t created = pool.NumCreated();
+  Scope& step = loop->NewScope(parent);
+  EXPECT_EQ(pool.NumCreated(), created + 1);
+  EXPECT_TRUE(parent.HasKid(&step));
+  Variable* var = step.Var("x");
+  auto* tensor = var->GetMutable<LoDTensor>();
+  tensor->Resize(make_ddim({2, 3}));
+  tensor->set_lod({{0, 1, 2}});
+  float* data = tensor->mutable_data<float>(place);
+  auto holder = tensor->Holder().get();
+  // A tensor sharing the memory of another one does not keep it.
+  auto* shared = step.Var("y")->GetMutable<LoDTensor>();
+  LoDTensor outside;
+  outside.mutable_data<float>(make_ddim({4}), place);
+  shared->ShareDataWith(outside);
+  step.Var("z")->GetMutable<LoDTensorArray>()->resize(2);
+  step.NewScope();
+
+  loop->DeleteScope(parent, &step);
+  EXPECT_FALSE(parent.HasKid(&step));
+
+  // The scope comes back under another parent, with its variables and the
+  // memory of its tensors, but empty dims and LoD.
+  Scope other_parent;
+  size_t reused = pool.NumReused();
+  Scope& again = loop->NewScope(other_parent);
+  EXPECT_EQ(&again, &step);
+  EXPECT_EQ(pool.NumReused(), reused + 1);
+  EXPECT_EQ(again.parent(), &other_parent);
+  EXPECT_TRUE(other_parent.HasKid(&again));
+  EXPECT_TRUE(again.kids().empty());
+  EXPECT_EQ(again.FindLocalVar("x"), var);
+  EXPECT_TRUE(var->IsType<LoDTensor>());
+  EXPECT_EQ(tensor->numel(), 0);
+  EXPECT_TRUE(tensor->lod().empty());
+  EXPECT_EQ(tensor->Holder().get(), holder);
+  EXPECT_EQ(tensor->mutable_data<float>(make_ddim({3, 2}), place), data);
+  EXPECT_EQ(shared->Holder(), nullptr);
+  EXPECT_TRUE(again.FindLocalVar("z")->Get<LoDTensorArray>().empty());
+
+  // Scopes of another loop are not shared.
+  auto other_loop = pool.Get(StepScopePool::Key(0, "other_step_scopes"));
+  Scope& fresh = other_loop->NewScope(other_parent);
+  EXPECT_NE(&fresh, &again);
+  // Nor are the scopes of the same loop in another program.
+  loop->DeleteScope(other_parent, &again);
+  Scope& other_program =
+      pool.Get(StepScopePool::Key(1, "step_scopes"))->NewScope(other_parent);
+  EXPECT_NE(&other_program, &again);
+  // The same key gives the same loop.
+  EXPECT_EQ(pool.Get(StepScopePool::Key(0, "step_scopes")), loop);
+  EXPECT_EQ(pool.NumKeys(), 3UL);
+  other_parent.DropKids();
+  pool.Clear();
+}
+
+TEST(StepScopePool, Disabled) {
+  auto& pool = StepScopePool::Instance();
+  pool.Clear();
+  FLAGS_reuse_step_scopes = false;
+  Scope parent;
+  auto loop = pool.Get(StepScopePool::Key(0, "step_scopes"));
+  for (int i = 0; i < 3; ++i) {
+    size_t created = pool.NumCreated();
+    Scope& step = loop->NewScope(parent);
+    EXPECT_EQ(pool.NumCreated(), created + 1);
+    loop->DeleteScope(parent, &step);
+    EXPECT_TRUE(parent.kids().empty());
+  }
+  FLAGS_reuse_step_scopes = true;
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -69,3 +69,26 @@ TEST(Scope, GetAllNames) {
 
   EXPECT_STREQ("a", str.c_str());
 }
+
+TEST(Scope, ReleaseAndAdoptKid) {
+  Scope s;
+  Scope& ss = s.NewScope();
+  Variable* v = ss.Var("a");
+  *v->GetMutable<int>() = 1;
+  ss.NewScope();
+
+  auto released = s.ReleaseKid(&ss);
+  EXPECT_FALSE(s.HasKid(&ss));
+  EXPECT_EQ(nullptr, released->parent());
+
+  released->Reset();
+  EXPECT_TRUE(released->kids().empty());
+  EXPECT_EQ(v, released->FindLocalVar("a"));
+  EXPECT_FALSE(v->IsInitialized());
+
+  Scope other;
+  Scope& adopted = other.AdoptKid(std::move(released));
+  EXPECT_EQ(&ss, &adopted);
+  EXPECT_EQ(&other, adopted.parent());
+  EXPECT_TRUE(other.HasKid(&adopted));
+}
@@ -19,6 +19,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/trainer_desc.pb.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/device_tracer.h"
 #include "paddle/fluid/platform/lodtensor_printer.h"
 
 namespace paddle {
@@ -93,6 +94,39 @@ void SyncFunctor::Synchronize() {
   nccl_ctx_map_->WaitAll();
 }
 
+bool SectionThrottle::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this] { return closed_ || running_ < permits_; });
+  if (closed_) {
+    return false;
+  }
+  ++running_;
+  return true;
+}
+
+void SectionThrottle::Release() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  --running_;
+  cv_.notify_one();
+}
+
+void SectionThrottle::Close() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  closed_ = true;
+  cv_.notify_all();
+}
+
+void SectionThrottle::SetPermits(int permits) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  permits_ = permits;
+  cv_.notify_all();
+}
+
+int SectionThrottle::Permits() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return permits_;
+}
+
 std::atomic<int> SectionWorker::cpu_id_(0);
 void SectionWorker::Initialize(const TrainerDesc& trainer_desc) {
   dev_ctx_ = platform::DeviceContextPool::Instance().Get(place_);
@@ -138,15 +172,50 @@ void SectionWorker::AutoSetCPUAffinity(bool reuse) {
   SEC_LOG << "Set " << thread_cpu_id << "th thread affinity to CPU " << proc;
 }
 
+bool SectionWorker::ReceiveScope(Scope** scope) {
+  if (throttle_ != nullptr && !throttle_->Acquire()) {
+    return false;
+  }
+  uint64_t start_ns = platform::PosixInNsec();
+  if (!in_scope_queue_->Receive(scope)) {
+    if (throttle_ != nullptr) {
+      throttle_->Release();
+      // The parked workers of the section have nothing left to do either.
+      throttle_->Close();
+    }
+    return false;
+  }
+  run_start_ns_ = platform::PosixInNsec();
+  if (stats_ != nullptr) {
+    stats_->in_wait_us += (run_start_ns_ - start_ns) / 1000;
+  }
+  return true;
+}
+
+void SectionWorker::SendScope(Scope* scope) {
+  uint64_t start_ns = platform::PosixInNsec();
+  if (throttle_ != nullptr) {
+    throttle_->Release();
+  }
+  out_scope_queue_->Send(scope);
+  if (stats_ != nullptr) {
+    stats_->busy_us += (start_ns - run_start_ns_) / 1000;
+    stats_->out_wait_us += (platform::PosixInNsec() - start_ns) / 1000;
+    ++stats_->num_batches;
+  }
+}
+
 void SectionWorker::TrainFiles() {
   SEC_LOG << "begin section_worker TrainFiles";
-  AutoSetCPUAffinity(true);
+  if (throttle_ == nullptr) {
+    AutoSetCPUAffinity(true);
+  }
 
   int64_t step_cnt = 0;
   int64_t accum_num = 0;
   int batch_size = 0;
   Scope* scope = nullptr;
-  while (in_scope_queue_->Receive(&scope)) {
+  while (ReceiveScope(&scope)) {
     if (device_reader_ != nullptr) {
       device_reader_->AssignFeedVar(*scope);
       batch_size = device_reader_->Next();
@@ -225,7 +294,7 @@ void SectionWorker::TrainFiles() {
       }
     }
 
-    out_scope_queue_->Send(scope);
+    SendScope(scope);
 
     if (sync_func_) {
       (*sync_func_)(scope);
@@ -249,7 +318,9 @@ void SectionWorker::TrainFiles() {
 
 void SectionWorker::TrainFilesWithProfiler() {
   SEC_LOG << "begin section_worker TrainFiles with profiler";
-  AutoSetCPUAffinity(true);
+  if (throttle_ == nullptr) {
+    AutoSetCPUAffinity(true);
+  }
 
   int64_t step_cnt = 0;
   int64_t accum_num = 0;
@@ -275,7 +346,7 @@ void SectionWorker::TrainFilesWithProfiler() {
   platform::Timer timeline;
 
   bool started = false;
-  while (in_scope_queue_->Receive(&scope)) {
+  while (ReceiveScope(&scope)) {
     if (UNLIKELY(!started)) {
       outer_timer.Start();
       started = true;
@@ -367,7 +438,7 @@ void SectionWorker::TrainFilesWithProfiler() {
       trans_timer.Pause();
     }
 
-    out_scope_queue_->Send(scope);
+    SendScope(scope);
 
     if (sync_func_) {
       sync_timer.Resume();
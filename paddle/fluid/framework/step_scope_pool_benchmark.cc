@@ -0,0 +1,122 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <string>
+#include <vector>
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/scope_pool.h"
+#include "paddle/fluid/platform/device_tracer.h"
+
+DECLARE_bool(reuse_step_scopes);
+
+DEFINE_int32(burning, 3, "Burning times.");
+DEFINE_int32(repeat, 20, "Repeat times.");
+DEFINE_int32(seq_len, 100, "The number of steps of the RNN.");
+DEFINE_int32(num_vars, 30, "The number of variables created by every step.");
+DEFINE_int32(hidden_size, 128, "The width of the step tensors.");
+DEFINE_int32(batch_size, 32, "The height of the step tensors.");
+
+namespace paddle {
+namespace framework {
+
+struct StepScopeStat {
+  double us_per_batch{0};
+  size_t scopes_created{0};
+  size_t vars_created{0};
+};
+
+// Run the step scopes of a recurrent op as training does: the forward pass
+// creates one scope per step and fills its variables, the backward pass
+// releases them in reverse order.
+static StepScopeStat BenchStepScopes(bool reuse) {
+  FLAGS_reuse_step_scopes = reuse;
+  auto& pool = StepScopePool::Instance();
+  pool.Clear();
+  Scope parent;
+  auto loop = pool.Get(StepScopePool::Key(0, "step_scopes"));
+  std::vector<std::string> names;
+  for (int i = 0; i < FLAGS_num_vars; ++i) {
+    names.push_back("step_var_" + std::to_string(i));
+  }
+  platform::CPUPlace place;
+  auto dims = make_ddim({FLAGS_batch_size, FLAGS_hidden_size});
+
+  size_t vars_created = 0;
+  std::vector<Scope*> step_scopes;
+  auto run = [&]() {
+    for (int step = 0; step < FLAGS_seq_len; ++step) {
+      Scope& cur = loop->NewScope(parent);
+      step_scopes.push_back(&cur);
+      for (auto& name : names) {
+        if (cur.FindLocalVar(name) == nullptr) ++vars_created;
+        auto* tensor = cur.Var(name)->GetMutable<LoDTensor>();
+        tensor->Resize(dims);
+        tensor->mutable_data<float>(place);
+      }
+    }
+    for (auto it = step_scopes.rbegin(); it != step_scopes.rend(); ++it) {
+      loop->DeleteScope(parent, *it);
+    }
+    step_scopes.clear();
+  };
+
+  for (int i = 0; i < FLAGS_burning; ++i) {
+    run();
+  }
+  size_t scopes_before = pool.NumCreated();
+  vars_created = 0;
+  auto start = platform::PosixInNsec() * 1e-3;
+  for (int i = 0; i < FLAGS_repeat; ++i) {
+    run();
+  }
+  auto end = platform::PosixInNsec() * 1e-3;
+
+  StepScopeStat stat;
+  stat.us_per_batch = static_cast<double>(end - start) / FLAGS_repeat;
+  stat.scopes_created = pool.NumCreated() - scopes_before;
+  stat.vars_created = vars_created;
+  pool.Clear();
+  return stat;
+}
+
+}  // namespace framework
+}  // namespace paddle
+
+// Benchmark the step scopes of a recurrent op with and without reuse.
+// To use this tool, run command: ./step_scope_pool_benchmark [options...]
+// Options:
+//     --burning: the burning time before count
+//     --repeat: the repeat times
+//     --seq_len: the number of steps
+//     --num_vars: the number of variables of every step
+//     --hidden_size: the width of the step tensors
+//     --batch_size: the height of the step tensors
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  namespace framework = paddle::framework;
+
+  LOG(INFO) << "Burning " << FLAGS_burning << " times, Repeat " << FLAGS_repeat
+            << " times, " << FLAGS_seq_len << " steps of " << FLAGS_num_vars
+            << " variables.";
+  for (bool reuse : {false, true}) {
+    auto stat = framework::BenchStepScopes(reuse);
+    LOG(INFO) << (reuse ? "reuse step scopes" : "new step scopes") << ": "
+              << stat.us_per_batch << " us/batch, " << stat.scopes_created
+              << " scopes and " << stat.vars_created
+              << " variables created in " << FLAGS_repeat << " batches";
+  }
+}
@@ -13,11 +13,87 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/framework/trainer.h"
+#include <chrono>  // NOLINT
+#include "paddle/fluid/platform/device_tracer.h"
 
 namespace paddle {
 namespace framework {
 
 void TrainerBase::SetScope(Scope* root_scope) { root_scope_ = root_scope; }
 
+void TrainerBase::SetMetricsCallback(MetricsCallback callback,
+                                     int interval_ms) {
+  PADDLE_ENFORCE_GT(interval_ms, 0,
+                    "The interval of the metrics should be greater than 0.");
+  metrics_callback_ = std::move(callback);
+  metrics_interval_ms_ = interval_ms;
+}
+
+void TrainerBase::SetMetricsFile(const std::string& path, int interval_ms) {
+  auto fout =
+      std::make_shared<std::ofstream>(path, std::ios::out | std::ios::app);
+  PADDLE_ENFORCE(static_cast<bool>(fout->is_open()),
+                 "Cannot open %s to write the metrics", path);
+  SetMetricsCallback(
+      [fout](const TrainerMetrics& metrics) {
+        *fout << metrics.ToJson() << std::endl;
+      },
+      interval_ms);
+}
+
+void TrainerBase::StartMetricsReporter() {
+  if (!metrics_callback_) {
+    return;
+  }
+  metrics_start_ns_ = platform::PosixInNsec();
+  last_report_ns_ = metrics_start_ns_;
+  last_report_batches_ = 0;
+  last_report_instances_ = 0;
+  stop_metrics_ = false;
+  metrics_thread_ = std::thread([this] {
+    std::unique_lock<std::mutex> lock(metrics_mutex_);
+    while (!metrics_cv_.wait_for(
+        lock, std::chrono::milliseconds(metrics_interval_ms_),
+        [this] { return stop_metrics_; })) {
+      ReportMetrics();
+    }
+  });
+}
+
+void TrainerBase::StopMetricsReporter() {
+  if (!metrics_thread_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> guard(metrics_mutex_);
+    stop_metrics_ = true;
+  }
+  metrics_cv_.notify_all();
+  metrics_thread_.join();
+  ReportMetrics();
+}
+
+void TrainerBase::ReportMetrics() {
+  TrainerMetrics metrics;
+  GetWorkerMetrics(&metrics.workers);
+  uint64_t now = platform::PosixInNsec();
+  metrics.elapsed_ns = static_cast<int64_t>(now - metrics_start_ns_);
+  int64_t num_batches = 0;
+  int64_t num_instances = 0;
+  for (auto& worker : metrics.workers) {
+    num_batches += worker.num_batches;
+    num_instances += worker.num_instances;
+  }
+  if (now > last_report_ns_) {
+    double sec = static_cast<double>(now - last_report_ns_) * 1e-9;
+    metrics.batches_per_sec = (num_batches - last_report_batches_) / sec;
+    metrics.instances_per_sec = (num_instances - last_report_instances_) / sec;
+  }
+  last_report_ns_ = now;
+  last_report_batches_ = num_batches;
+  last_report_instances_ = num_instances;
+  metrics_callback_(metrics);
+}
+
 }  // end namespace framework
 }  // end namespace paddle
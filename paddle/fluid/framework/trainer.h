@@ -14,11 +14,15 @@ limitations under the License. */
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
 #include <fstream>
+#include <functional>
+#include <map>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/data_feed.h"
@@ -29,7 +33,9 @@ limitations under the License. */
 #include "paddle/fluid/framework/reader.h"
 #include "paddle/fluid/framework/trainer_desc.pb.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/framework/worker_metrics.h"
 #include "paddle/fluid/operators/reader/blocking_queue.h"
+#include "paddle/fluid/platform/numa_helper.h"
 #include "paddle/fluid/platform/port.h"
 
 namespace paddle {
@@ -51,10 +57,38 @@ class TrainerBase {
   virtual void Run() = 0;
   virtual void Finalize() = 0;
 
+  using MetricsCallback = std::function<void(const TrainerMetrics&)>;
+  // While the trainer runs, call callback with the metrics of its workers
+  // every interval_ms, and a last time when it finishes. Must be set before
+  // Run.
+  void SetMetricsCallback(MetricsCallback callback, int interval_ms);
+  // Append the metrics to the file at path as lines of JSON.
+  void SetMetricsFile(const std::string& path, int interval_ms);
+  // The current metrics of every worker, empty for the trainers keeping none.
+  virtual void GetWorkerMetrics(
+      std::vector<WorkerMetricsSnapshot>* workers) const {}
+
  protected:
+  // Called by Run and Finalize of the trainers keeping metrics, they do
+  // nothing without a metrics callback.
+  void StartMetricsReporter();
+  void StopMetricsReporter();
+  void ReportMetrics();
+
   Scope* root_scope_;
   bool debug_;
   Dataset* dataset_ptr_;
+
+  MetricsCallback metrics_callback_;
+  int metrics_interval_ms_ = 0;
+  std::thread metrics_thread_;
+  std::mutex metrics_mutex_;
+  std::condition_variable metrics_cv_;
+  bool stop_metrics_ = false;
+  uint64_t metrics_start_ns_ = 0;
+  uint64_t last_report_ns_ = 0;
+  int64_t last_report_batches_ = 0;
+  int64_t last_report_instances_ = 0;
 };
 
 // general trainer for async execution
@@ -70,13 +104,45 @@ class MultiTrainer : public TrainerBase {
   virtual void InitOtherEnv(const ProgramDesc& main_program) {}
   virtual void Run();
   virtual void Finalize();
+  virtual void GetWorkerMetrics(
+      std::vector<WorkerMetricsSnapshot>* workers) const;
 
  protected:
+  // Run func on a thread bound to the NUMA node of worker thread_id, or on
+  // the calling thread without binding_cpu.
+  void RunOnWorkerNode(int thread_id, const std::function<void()>& func);
+  std::thread StartWorkerThread(int thread_id);
+  void InitNumaReplicas(const ProgramDesc& main_program);
+  void AverageNumaReplicas();
+  void StartNumaSync();
+  void StopNumaSync();
+  void LogNumaStats() const;
+
   int thread_num_;
   std::vector<std::thread> threads_;
   std::vector<DataFeed*> readers_;
   std::vector<std::shared_ptr<DeviceWorker>> workers_;
   std::vector<std::string> need_merge_var_names_;
+
+  // With binding_cpu, the worker threads are spread over the NUMA nodes and
+  // every worker creates its scope on its node, so that the pages of its
+  // tensors and of the batches of its reader are local. On several nodes,
+  // the small dense parameters can be replicated per node as well.
+  bool binding_cpu_ = false;
+  int64_t numa_replica_max_numel_ = 0;
+  int numa_sync_interval_ms_ = 100;
+  std::vector<platform::NumaNode> numa_nodes_;
+  // The index in numa_nodes_ of the node of every worker.
+  std::vector<int> thread_nodes_;
+  // [node index], nullptr for the nodes without workers.
+  std::vector<Scope*> replica_scopes_;
+  std::vector<std::string> replica_var_names_;
+  std::vector<std::map<std::string, int64_t>> numa_stats_;
+  uint64_t run_start_ns_ = 0;
+  std::thread numa_sync_thread_;
+  std::mutex numa_sync_mutex_;
+  std::condition_variable numa_sync_cv_;
+  bool stop_numa_sync_ = false;
 };
 
 class DistMultiTrainer : public MultiTrainer {
@@ -153,10 +219,37 @@ class PipelineTrainer : public TrainerBase {
 
   std::vector<DataFeed*> readers_;
 
+  // [section_id][pipeline_id]
+  std::vector<std::vector<std::unique_ptr<SectionStats>>> section_stats_;
+  uint64_t run_start_ns_ = 0;
+
+  // With adaptive_concurrency, the CPU sections after the first one share
+  // their threads: each has enough workers to take all the threads but one
+  // per other section, and a SectionThrottle lets only some of them run.
+  // Every balance_interval_ms a thread is moved from the section with the
+  // most spare throughput to the slowest one.
+  bool adaptive_concurrency_ = false;
+  int balance_interval_ms_ = 1000;
+  std::vector<int> adaptive_sections_;
+  // [section_id][pipeline_id], empty for the other sections
+  std::vector<std::vector<std::unique_ptr<SectionThrottle>>>
+      section_throttles_;
+  std::thread balance_thread_;
+  std::mutex balance_mutex_;
+  std::condition_variable balance_cv_;
+  bool stop_balance_ = false;
+
   void InitFirstScopeQueue(ScopeQueue* scope_queue, int pipeline_id,
                            const ProgramDesc& main_program);
   void CopyParameters(const Scope& root_scope, int pipeline_id);
   void construct_sync_functor();
+  bool IsAdaptiveSection(int section_id) const;
+  void BalanceSections();
+  // last holds the number of batches and the busy time of the adaptive
+  // sections of the pipeline at the previous round.
+  void BalancePipeline(int pipeline_id,
+                       std::vector<std::pair<int64_t, int64_t>>* last);
+  void LogSectionStats() const;
 };
 #endif
 }  // namespace framework
@@ -0,0 +1,94 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/worker_metrics.h"
+#include <sstream>
+
+namespace paddle {
+namespace framework {
+
+void WorkerMetricsSnapshot::Add(const WorkerMetricsSnapshot& other) {
+  num_batches += other.num_batches;
+  num_instances += other.num_instances;
+  read_wait_ns += other.read_wait_ns;
+  compute_ns += other.compute_ns;
+  comm_wait_ns += other.comm_wait_ns;
+  for (auto& op : other.op_ns) {
+    op_ns[op.first] += op.second;
+  }
+}
+
+WorkerMetricsSnapshot TrainerMetrics::Total() const {
+  WorkerMetricsSnapshot total;
+  for (auto& worker : workers) {
+    total.Add(worker);
+  }
+  return total;
+}
+
+static void WriteSnapshot(const WorkerMetricsSnapshot& snapshot,
+                          std::ostream* os) {
+  *os << "\"num_batches\":" << snapshot.num_batches
+      << ",\"num_instances\":" << snapshot.num_instances
+      << ",\"read_wait_ns\":" << snapshot.read_wait_ns
+      << ",\"compute_ns\":" << snapshot.compute_ns
+      << ",\"comm_wait_ns\":" << snapshot.comm_wait_ns << ",\"op_ns\":{";
+  bool first = true;
+  for (auto& op : snapshot.op_ns) {
+    *os << (first ? "" : ",") << "\"" << op.first << "\":" << op.second;
+    first = false;
+  }
+  *os << "}";
+}
+
+std::string TrainerMetrics::ToJson() const {
+  std::ostringstream os;
+  os << "{\"elapsed_ns\":" << elapsed_ns
+     << ",\"batches_per_sec\":" << batches_per_sec
+     << ",\"instances_per_sec\":" << instances_per_sec << ",";
+  WriteSnapshot(Total(), &os);
+  os << ",\"workers\":[";
+  for (size_t i = 0; i < workers.size(); ++i) {
+    os << (i == 0 ? "{" : ",{");
+    WriteSnapshot(workers[i], &os);
+    os << "}";
+  }
+  os << "]}";
+  return os.str();
+}
+
+void WorkerMetrics::SetOpTypes(const std::vector<std::string>& op_types) {
+  op_types_ = op_types;
+  op_ns_.reset(new std::atomic<int64_t>[op_types.size()]);
+  for (size_t i = 0; i < op_types.size(); ++i) {
+    op_ns_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+WorkerMetricsSnapshot WorkerMetrics::Snapshot() const {
+  WorkerMetricsSnapshot snapshot;
+  snapshot.num_batches = num_batches_.load(std::memory_order_relaxed);
+  snapshot.num_instances = num_instances_.load(std::memory_order_relaxed);
+  snapshot.read_wait_ns = read_wait_ns_.load(std::memory_order_relaxed);
+  snapshot.comm_wait_ns = comm_wait_ns_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < op_types_.size(); ++i) {
+    int64_t ns = op_ns_[i].load(std::memory_order_relaxed);
+    snapshot.op_ns[op_types_[i]] += ns;
+    snapshot.compute_ns += ns;
+  }
+  return snapshot;
+}
+
+}  // namespace framework
+}  // namespace paddle
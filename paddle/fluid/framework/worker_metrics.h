@@ -0,0 +1,92 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+struct WorkerMetricsSnapshot {
+  int64_t num_batches = 0;
+  int64_t num_instances = 0;
+  // Time spent waiting for the reader to produce a batch.
+  int64_t read_wait_ns = 0;
+  // Time spent running ops, in total and per op type.
+  int64_t compute_ns = 0;
+  std::map<std::string, int64_t> op_ns;
+  // Time spent waiting for pulls and pushes of parameters.
+  int64_t comm_wait_ns = 0;
+
+  void Add(const WorkerMetricsSnapshot& other);
+};
+
+// The metrics of all the workers of a trainer at one point of time.
+struct TrainerMetrics {
+  // Time since the trainer started to run.
+  int64_t elapsed_ns = 0;
+  // The rates of the whole trainer since the previous snapshot.
+  double batches_per_sec = 0;
+  double instances_per_sec = 0;
+  std::vector<WorkerMetricsSnapshot> workers;
+
+  WorkerMetricsSnapshot Total() const;
+  // One line of JSON, the totals followed by the counters of every worker.
+  std::string ToJson() const;
+};
+
+// The stage counters of a DeviceWorker. Only the thread of the worker updates
+// them, with a relaxed load and store rather than an atomic add, so counting
+// costs as much as a plain add and never stalls the training thread; any
+// other thread may take a snapshot at any time.
+class WorkerMetrics {
+ public:
+  WorkerMetrics() {}
+
+  // op_types[i] is the type of the i-th op run by the worker. Must be called
+  // before the worker starts.
+  void SetOpTypes(const std::vector<std::string>& op_types);
+
+  void AddReadWait(int64_t ns) { Add(&read_wait_ns_, ns); }
+  void AddCommWait(int64_t ns) { Add(&comm_wait_ns_, ns); }
+  void AddOpTime(size_t op_idx, int64_t ns) { Add(&op_ns_[op_idx], ns); }
+  void AddBatch(int64_t num_instances) {
+    Add(&num_batches_, 1);
+    Add(&num_instances_, num_instances);
+  }
+
+  WorkerMetricsSnapshot Snapshot() const;
+
+ private:
+  static void Add(std::atomic<int64_t>* counter, int64_t value) {
+    counter->store(counter->load(std::memory_order_relaxed) + value,
+                   std::memory_order_relaxed);
+  }
+
+  std::atomic<int64_t> num_batches_{0};
+  std::atomic<int64_t> num_instances_{0};
+  std::atomic<int64_t> read_wait_ns_{0};
+  std::atomic<int64_t> comm_wait_ns_{0};
+  std::vector<std::string> op_types_;
+  std::unique_ptr<std::atomic<int64_t>[]> op_ns_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,104 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/worker_metrics.h"
+#include <atomic>
+#include <thread>  // NOLINT
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+TEST(WorkerMetrics, snapshot_sums_ops_by_type) {
+  WorkerMetrics metrics;
+  metrics.SetOpTypes({"mul", "relu", "mul"});
+  metrics.AddReadWait(5);
+  metrics.AddOpTime(0, 10);
+  metrics.AddOpTime(1, 20);
+  metrics.AddOpTime(2, 30);
+  metrics.AddCommWait(7);
+  metrics.AddBatch(32);
+  metrics.AddBatch(16);
+
+  auto snapshot = metrics.Snapshot();
+  EXPECT_EQ(snapshot.num_batches, 2);
+  EXPECT_EQ(snapshot.num_instances, 48);
+  EXPECT_EQ(snapshot.read_wait_ns, 5);
+  EXPECT_EQ(snapshot.comm_wait_ns, 7);
+  EXPECT_EQ(snapshot.compute_ns, 60);
+  ASSERT_EQ(snapshot.op_ns.size(), 2UL);
+  EXPECT_EQ(snapshot.op_ns["mul"], 40);
+  EXPECT_EQ(snapshot.op_ns["relu"], 20);
+}
+
+TEST(WorkerMetrics, trainer_metrics_total_and_json) {
+  WorkerMetrics first;
+  first.SetOpTypes({"mul"});
+  first.AddOpTime(0, 3);
+  first.AddBatch(4);
+  WorkerMetrics second;
+  second.SetOpTypes({"mul", "sgd"});
+  second.AddOpTime(0, 5);
+  second.AddOpTime(1, 1);
+  second.AddBatch(2);
+
+  TrainerMetrics metrics;
+  metrics.elapsed_ns = 100;
+  metrics.workers.push_back(first.Snapshot());
+  metrics.workers.push_back(second.Snapshot());
+  auto total = metrics.Total();
+  EXPECT_EQ(total.num_batches, 2);
+  EXPECT_EQ(total.num_instances, 6);
+  EXPECT_EQ(total.compute_ns, 9);
+  EXPECT_EQ(total.op_ns["mul"], 8);
+  EXPECT_EQ(total.op_ns["sgd"], 1);
+
+  EXPECT_EQ(metrics.ToJson(),
+            "{\"elapsed_ns\":100,\"batches_per_sec\":0,"
+            "\"instances_per_sec\":0,\"num_batches\":2,\"num_instances\":6,"
+            "\"read_wait_ns\":0,\"compute_ns\":9,\"comm_wait_ns\":0,"
+            "\"op_ns\":{\"mul\":8,\"sgd\":1},\"workers\":["
+            "{\"num_batches\":1,\"num_instances\":4,\"read_wait_ns\":0,"
+            "\"compute_ns\":3,\"comm_wait_ns\":0,\"op_ns\":{\"mul\":3}},"
+            "{\"num_batches\":1,\"num_instances\":2,\"read_wait_ns\":0,"
+            "\"compute_ns\":6,\"comm_wait_ns\":0,\"op_ns\":{\"mul\":5,"
+            "\"sgd\":1}}]}");
+}
+
+TEST(WorkerMetrics, snapshot_while_counting) {
+  const int kNumBatches = 100000;
+  WorkerMetrics metrics;
+  metrics.SetOpTypes({"mul"});
+  std::atomic<bool> done{false};
+  std::thread worker([&] {
+    for (int i = 0; i < kNumBatches; ++i) {
+      metrics.AddOpTime(0, 1);
+      metrics.AddBatch(1);
+    }
+    done = true;
+  });
+  int64_t last = 0;
+  while (!done) {
+    auto snapshot = metrics.Snapshot();
+    EXPECT_GE(snapshot.num_batches, last);
+    last = snapshot.num_batches;
+  }
+  worker.join();
+  auto snapshot = metrics.Snapshot();
+  EXPECT_EQ(snapshot.num_batches, kNumBatches);
+  EXPECT_EQ(snapshot.op_ns["mul"], kNumBatches);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,150 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/imperative/tracer.h"
+#include "paddle/fluid/platform/device_tracer.h"
+
+DEFINE_int32(burning, 3, "Burning times.");
+DEFINE_int32(repeat, 20, "Repeat times.");
+DEFINE_int32(num_towers, 8, "The number of independent towers.");
+DEFINE_int32(depth, 8, "The number of mul ops of every tower.");
+DEFINE_int32(hidden_size, 256, "The width of the tensors.");
+DEFINE_int32(batch_size, 64, "The height of the tensors.");
+DEFINE_int32(num_threads, 4, "The number of threads of the parallel backward.");
+
+namespace paddle {
+namespace imperative {
+
+using vb_vector = std::vector<std::shared_ptr<VarBase>>;
+
+static std::shared_ptr<VarBase> NewVar(const std::string& name,
+                                       const std::vector<int64_t>& dims) {
+  std::shared_ptr<VarBase> var(new VarBase(true, name));
+  auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim(dims));
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = static_cast<float>(i % 7) * 0.01f;
+  }
+  return var;
+}
+
+// Trace the towers of mul ops summed by elementwise_add ops, which is the
+// shape of multi-tower models, and return the sum.
+static std::shared_ptr<VarBase> TraceTowers(Tracer* tracer,
+                                            const vb_vector& inputs,
+                                            const vb_vector& weights) {
+  platform::CPUPlace place;
+  framework::AttributeMap mul_attrs;
+  mul_attrs["use_mkldnn"] = false;
+  std::shared_ptr<VarBase> sum;
+  size_t counter = 0;
+  for (int i = 0; i < FLAGS_num_towers; ++i) {
+    auto out = inputs[i];
+    for (int j = 0; j < FLAGS_depth; ++j) {
+      std::shared_ptr<VarBase> mul_out(
+          new VarBase(true, "tmp_" + std::to_string(counter++)));
+      tracer->TraceOp(
+          "mul", {{"X", {out}}, {"Y", {weights[i * FLAGS_depth + j]}}},
+          {{"Out", {mul_out}}}, mul_attrs, place, true);
+      out = mul_out;
+    }
+    if (sum == nullptr) {
+      sum = out;
+    } else {
+      std::shared_ptr<VarBase> add_out(
+          new VarBase(true, "tmp_" + std::to_string(counter++)));
+      tracer->TraceOp("elementwise_add", {{"X", {sum}}, {"Y", {out}}},
+                      {{"Out", {add_out}}}, {}, place, true);
+      sum = add_out;
+    }
+  }
+  return sum;
+}
+
+// Return the time of a backward in us.
+static double BenchBackward(size_t num_threads, bool sorted_sum_gradient) {
+  vb_vector inputs;
+  for (int i = 0; i < FLAGS_num_towers; ++i) {
+    inputs.emplace_back(NewVar("x_" + std::to_string(i),
+                               {FLAGS_batch_size, FLAGS_hidden_size}));
+  }
+  vb_vector weights;
+  for (int i = 0; i < FLAGS_num_towers * FLAGS_depth; ++i) {
+    weights.emplace_back(NewVar("w_" + std::to_string(i),
+                                {FLAGS_hidden_size, FLAGS_hidden_size}));
+    weights.back()->SetOverridedStopGradient(false);
+  }
+
+  detail::BackwardStrategy strategy;
+  strategy.sorted_sum_gradient_ = sorted_sum_gradient;
+  strategy.num_threads_ = num_threads;
+  Tracer tracer;
+  double total_us = 0;
+  for (int i = 0; i < FLAGS_burning + FLAGS_repeat; ++i) {
+    auto loss = TraceTowers(&tracer, inputs, weights);
+    for (auto& w : weights) {
+      w->ClearGradient();
+    }
+    auto start = platform::PosixInNsec() * 1e-3;
+    tracer.GetDefaultEngine()->Init(loss.get(), strategy);
+    tracer.GetDefaultEngine()->Execute();
+    auto end = platform::PosixInNsec() * 1e-3;
+    if (i >= FLAGS_burning) {
+      total_us += end - start;
+    }
+  }
+  return total_us / FLAGS_repeat;
+}
+
+}  // namespace imperative
+}  // namespace paddle
+
+// Benchmark the backward of the imperative mode on one and more threads.
+// To use this tool, run command: ./imperative_backward_benchmark [options...]
+// Options:
+//     --burning: the burning time before count
+//     --repeat: the repeat times
+//     --num_towers: the number of independent towers
+//     --depth: the number of mul ops of every tower
+//     --hidden_size: the width of the tensors
+//     --batch_size: the height of the tensors
+//     --num_threads: the number of threads of the parallel backward
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  namespace imperative = paddle::imperative;
+
+  LOG(INFO) << "Burning " << FLAGS_burning << " times, Repeat " << FLAGS_repeat
+            << " times, " << FLAGS_num_towers << " towers of " << FLAGS_depth
+            << " mul ops.";
+  for (bool sorted : {false, true}) {
+    double serial_us = imperative::BenchBackward(1, sorted);
+    double parallel_us = imperative::BenchBackward(FLAGS_num_threads, sorted);
+    LOG(INFO) << (sorted ? "sorted sum" : "eager sum") << ": 1 thread "
+              << serial_us << " us/backward, " << FLAGS_num_threads
+              << " threads " << parallel_us << " us/backward, speedup "
+              << serial_us / parallel_us;
+  }
+}
+
+USE_OP(mul);
+USE_OP(elementwise_add);
@@ -17,6 +17,8 @@
 //
 #pragma once
 
+#include <cstddef>
+
 namespace paddle {
 namespace imperative {
 namespace detail {
@@ -26,6 +28,10 @@ struct BackwardStrategy {
    * gradient, another is sum gradient once they are created */
   // TODO(jiabin): add more Strategy when we support
   bool sorted_sum_gradient_{false};
+  /* The grad ops on CPU whose inputs are ready run on up to num_threads_
+   * threads. The gradients are summed in the order the grad ops finish, unless
+   * sorted_sum_gradient_ is set. */
+  size_t num_threads_{1};
 };
 
 }  // namespace detail
@@ -15,8 +15,12 @@
 #include "paddle/fluid/imperative/engine.h"
 
 #include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <exception>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <queue>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -154,6 +158,8 @@ void BasicEngine::PrepareDeps() {
 
     CheckBackwardInputs(cur_op);
 
+    all_ops_on_cpu_ &= platform::is_cpu_place(cur_op->place());
+
     SetBackwardOutputs(cur_op);
 
     PrepareGradAccumulators(cur_op);
@@ -177,76 +183,158 @@ void BasicEngine::SumGradient(OpBase* op, std::shared_ptr<VarBase> src,
                     "Cannot find gradient of variable %s", dst->Name());
   iter->second->Add(std::move(src), op->id());
 }
-void BasicEngine::Execute() {
-  PrepareDeps();
-  // Start execute Computation graph
-  std::queue<OpBase*> q;
-  for (const auto& init_op : init_ops_) {
-    q.push(init_op);
-  }
-  while (!q.empty()) {
-    OpBase* cur_op = q.front();
-    q.pop();
+void BasicEngine::RunGradOp(OpBase* op) {
+  // Step 1: Run Backward
+  auto& bwd_ins = op->GetInsMap();
+  auto& bwd_outs = op->GetOutsMap();
 
-    // Step 1: Run Backward
-    auto& bwd_ins = cur_op->GetInsMap();
-    auto& bwd_outs = cur_op->GetOutsMap();
-
-    NameVarBaseMap tmp_outs;
-    // A var may be coresponding to several grad var in one op
-    std::unordered_map<VarBase*, std::vector<std::shared_ptr<VarBase>>> var_map;
-    size_t counter = 0;
-    for (auto& bwd_out : bwd_outs) {
-      auto& tmp_var_list = tmp_outs[bwd_out.first];
-      tmp_var_list.reserve(bwd_out.second.size());
-      for (auto& var : bwd_out.second) {
-        auto tmp_var = std::make_shared<VarBase>(
-            false, "Gtmp@" + std::to_string(counter++));  // Do not need grad
-        tmp_var_list.emplace_back(tmp_var);
-        if (var) {
-          var_map[var.get()].emplace_back(std::move(tmp_var));
-          var->ClearGradOps();
-        }
+  NameVarBaseMap tmp_outs;
+  // A var may be coresponding to several grad var in one op
+  std::unordered_map<VarBase*, std::vector<std::shared_ptr<VarBase>>> var_map;
+  size_t counter = 0;
+  for (auto& bwd_out : bwd_outs) {
+    auto& tmp_var_list = tmp_outs[bwd_out.first];
+    tmp_var_list.reserve(bwd_out.second.size());
+    for (auto& var : bwd_out.second) {
+      auto tmp_var = std::make_shared<VarBase>(
+          false, "Gtmp@" + std::to_string(counter++));  // Do not need grad
+      tmp_var_list.emplace_back(tmp_var);
+      if (var) {
+        var_map[var.get()].emplace_back(std::move(tmp_var));
       }
     }
+  }
 
-    VLOG(3) << "Start to execute grad op " << cur_op->Type();
-    RunOp(cur_op, bwd_ins, tmp_outs, cur_op->place());
-    // Step 2: Sum Gradient
-    {
-      platform::RecordEvent record_event("merge_grads");
-      for (auto& var_pair : var_map) {
-        auto* dst_var = var_pair.first;
-        if (dst_var == nullptr) continue;
-        for (auto& src_var : var_pair.second) {
-          VLOG(3) << "Sum gradient of variable " << dst_var->Name()
-                  << " after op " << cur_op->Type();
-          SumGradient(cur_op, std::move(src_var), dst_var);
-        }
+  VLOG(3) << "Start to execute grad op " << op->Type();
+  RunOp(op, bwd_ins, tmp_outs, op->place());
+  // Step 2: Sum Gradient
+  {
+    platform::RecordEvent record_event("merge_grads");
+    for (auto& var_pair : var_map) {
+      auto* dst_var = var_pair.first;
+      if (dst_var == nullptr) continue;
+      for (auto& src_var : var_pair.second) {
+        VLOG(3) << "Sum gradient of variable " << dst_var->Name()
+                << " after op " << op->Type();
+        SumGradient(op, std::move(src_var), dst_var);
       }
     }
+  }
+}
 
-    // Step 3: Collect ready ops
-    for (auto* grad_pending_op : cur_op->GradPendingOps()) {
-      PADDLE_ENFORCE_NOT_NULL(grad_pending_op);
-      auto iter = op_deps_.find(grad_pending_op);
-      if (iter == op_deps_.end()) {
-        continue;
+void BasicEngine::FinishGradOp(OpBase* op, std::vector<OpBase*>* ready_ops) {
+  for (auto& bwd_out : op->GetOutsMap()) {
+    for (auto& var : bwd_out.second) {
+      if (var) {
+        var->ClearGradOps();
       }
+    }
+  }
 
-      VLOG(3) << "Found grad_pending op of " << cur_op->Type();
-      // An Op is ready to go while its deps comes to zero
+  // Step 3: Collect ready ops
+  for (auto* grad_pending_op : op->GradPendingOps()) {
+    PADDLE_ENFORCE_NOT_NULL(grad_pending_op);
+    auto iter = op_deps_.find(grad_pending_op);
+    if (iter == op_deps_.end()) {
+      continue;
+    }
 
-      if (--(iter->second) == 0) {
-        q.push(grad_pending_op);
-        VLOG(3) << "Push grad_pending op " << grad_pending_op->Type()
-                << " into queue";
+    VLOG(3) << "Found grad_pending op of " << op->Type();
+    // An Op is ready to go while its deps comes to zero
+
+    if (--(iter->second) == 0) {
+      ready_ops->emplace_back(grad_pending_op);
+      VLOG(3) << "Push grad_pending op " << grad_pending_op->Type()
+              << " into queue";
+    }
+  }
+
+  // Step 4: Delete op to collect unused variables
+  VLOG(3) << "Remove op after op " << op->Type() << " runs";
+  RemoveOp(op);
+}
+
+void BasicEngine::ExecuteParallel(size_t num_threads) {
+  if (thread_pool_ == nullptr || thread_pool_size_ != num_threads) {
+    thread_pool_.reset(new ::ThreadPool(num_threads));
+    thread_pool_size_ = num_threads;
+  }
+
+  // Guards op_deps_, the grad ops of the engine and of the variables, the
+  // task count and the error. The gradients are guarded by their
+  // accumulators.
+  std::mutex mutex;
+  std::condition_variable cv;
+  size_t num_running_ops = 0;
+  std::exception_ptr error;
+
+  std::function<void(OpBase*)> schedule = [&](OpBase* op) {
+    ++num_running_ops;
+    thread_pool_->enqueue([&, op] {
+      try {
+        RunGradOp(op);
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!error) error = std::current_exception();
+      }
+
+      std::lock_guard<std::mutex> guard(mutex);
+      std::vector<OpBase*> ready_ops;
+      try {
+        FinishGradOp(op, &ready_ops);
+      } catch (...) {
+        if (!error) error = std::current_exception();
+      }
+      // Stop scheduling after an error, and wait for the running ops.
+      if (!error) {
+        for (auto* ready_op : ready_ops) {
+          schedule(ready_op);
+        }
       }
+      if (--num_running_ops == 0) {
+        cv.notify_all();
+      }
+    });
+  };
+
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    for (auto* init_op : init_ops_) {
+      schedule(init_op);
     }
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait(lock, [&] { return num_running_ops == 0; });
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
 
-    // Step 4: Delete op to collect unused variables
-    VLOG(3) << "Remove op after op " << cur_op->Type() << " runs";
-    RemoveOp(cur_op);
+void BasicEngine::Execute() {
+  PrepareDeps();
+  size_t num_threads = std::min<size_t>(
+      backward_strategy_.num_threads_,
+      std::max<size_t>(std::thread::hardware_concurrency(), 1));
+  if (num_threads > 1 && all_ops_on_cpu_) {
+    VLOG(3) << "Run backward on " << num_threads << " threads";
+    ExecuteParallel(num_threads);
+  } else {
+    // Start execute Computation graph
+    std::queue<OpBase*> q;
+    for (const auto& init_op : init_ops_) {
+      q.push(init_op);
+    }
+    std::vector<OpBase*> ready_ops;
+    while (!q.empty()) {
+      OpBase* cur_op = q.front();
+      q.pop();
+      RunGradOp(cur_op);
+      ready_ops.clear();
+      FinishGradOp(cur_op, &ready_ops);
+      for (auto* ready_op : ready_ops) {
+        q.push(ready_op);
+      }
+    }
   }
   VLOG(3) << "Clean properties of BasicEngine";
   CleanEngine();
@@ -21,6 +21,7 @@
 #include <unordered_set>
 #include <utility>
 #include <vector>
+#include "ThreadPool.h"
 #include "paddle/fluid/imperative/backward_strategy.h"
 #include "paddle/fluid/imperative/gradient_accumulator.h"
 #include "paddle/fluid/imperative/layer.h"
@@ -87,12 +88,22 @@ class BasicEngine : public Engine {
 
   void SumGradient(OpBase* op, std::shared_ptr<VarBase> src, VarBase* dst);
 
+  // Run the grad op and sum its outputs into the gradients.
+  void RunGradOp(OpBase* op);
+
+  // Append the grad pending ops which become ready to ready_ops, and release
+  // the op.
+  void FinishGradOp(OpBase* op, std::vector<OpBase*>* ready_ops);
+
+  void ExecuteParallel(size_t num_threads);
+
   // TODO(jiabin): maybe we can optimize the performance of engine by cache the
   // result
   void CleanEngine() {
     init_ops_.clear();
     op_deps_.clear();
     accumulators_.clear();
+    all_ops_on_cpu_ = true;
     Clear();
   }
 
@@ -101,6 +112,10 @@ class BasicEngine : public Engine {
   std::unordered_map<OpBase*, size_t> op_deps_;
   std::unordered_map<VarBase*, std::unique_ptr<GradientAccumulator>>
       accumulators_;
+  bool all_ops_on_cpu_{true};
+
+  std::unique_ptr<::ThreadPool> thread_pool_;
+  size_t thread_pool_size_{0};
 };
 
 }  // namespace imperative
@@ -19,6 +19,10 @@ DEFINE_uint64(dygraph_debug, 0,
               "Debug level of dygraph. This flag is not "
               "open to users");
 
+DEFINE_bool(dygraph_cache_dispatch, false,
+            "Cache the kernel chosen for the ops of dygraph, per op type, "
+            "place, data types and layouts of the inputs and attributes.");
+
 namespace paddle {
 namespace imperative {
 
@@ -26,5 +30,7 @@ bool IsDebugEnabled() { return FLAGS_dygraph_debug != 0; }
 
 uint64_t GetDebugLevel() { return FLAGS_dygraph_debug; }
 
+bool IsDispatchCacheEnabled() { return FLAGS_dygraph_cache_dispatch; }
+
 }  // namespace imperative
 }  // namespace paddle
@@ -104,6 +104,7 @@ void TensorAdd(const framework::Variable& src, framework::Variable* dst) {
 
 void EagerGradientAccumulator::Add(std::shared_ptr<VarBase> var,
                                    size_t trace_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
   auto* dst_var = var_->MutableVar();
   auto place = var->Var().Get<framework::LoDTensor>().place();
   if (!var_->OverridedStopGradient()) {
@@ -138,6 +139,7 @@ void EagerGradientAccumulator::Add(std::shared_ptr<VarBase> var,
 
 void SortedGradientAccumulator::Add(std::shared_ptr<VarBase> var,
                                     size_t trace_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
   auto* dst_var = var_->MutableVar();
   auto place = var->Var().Get<framework::LoDTensor>().place();
   if (!var_->OverridedStopGradient()) {
@@ -15,6 +15,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>  // NOLINT
 #include <utility>
 #include <vector>
 #include "paddle/fluid/imperative/layer.h"
@@ -22,6 +23,7 @@
 namespace paddle {
 namespace imperative {
 
+// Add() may be called by several threads at once.
 class GradientAccumulator {
  public:
   explicit GradientAccumulator(VarBase* var) : var_(var) {}
@@ -37,6 +39,7 @@ class GradientAccumulator {
  protected:
   VarBase* var_;
   size_t ref_cnt_{0};
+  std::mutex mutex_;
 };
 
 class EagerGradientAccumulator : public GradientAccumulator {
@@ -218,6 +218,15 @@ std::shared_ptr<VarBase> VarBase::NewVarBase(const platform::Place& dst_place,
 
   return new_var;
 }
+struct OpBase::RecordedRun {
+  // The prepared op refers to the context of the recorded run.
+  std::unique_ptr<framework::RuntimeContext> ctx;
+  std::unique_ptr<PreparedOp> prepared_op;
+  std::vector<std::pair<framework::proto::VarType::Type,
+                        framework::proto::VarType::Type>>
+      out_types;
+};
+
 // create OpBase from optype
 OpBase::OpBase(size_t id, const std::string& type, const NameVarBaseMap& ins,
                const NameVarBaseMap& outs, framework::AttributeMap attrs,
@@ -245,6 +254,8 @@ OpBase::OpBase(size_t id, const framework::OpDesc& op_desc,
   VLOG(3) << "Construct Op: " << op_desc.Type() << std::endl;
 }
 
+OpBase::~OpBase() { VLOG(3) << "Destruct Op: " << Type() << std::endl; }
+
 void OpBase::Run(const NameVarBaseMap& ins, const NameVarBaseMap& outs) {
   auto* op_kernel = dynamic_cast<framework::OperatorWithKernel*>(op_.get());
   PADDLE_ENFORCE_NOT_NULL(op_kernel, "only support op with kernel");
@@ -274,6 +285,57 @@ void OpBase::Run(const NameVarBaseMap& ins, const NameVarBaseMap& outs) {
   VLOG(4) << LayerDebugString(Type(), ins, outs);
 }
 
+void OpBase::RunAndRecord(const NameVarBaseMap& ins,
+                          const NameVarBaseMap& outs) {
+  auto* op_kernel = dynamic_cast<framework::OperatorWithKernel*>(op_.get());
+  PADDLE_ENFORCE_NOT_NULL(op_kernel, "only support op with kernel");
+  auto& info = op_->Info();
+  if (info.infer_var_type_) {
+    RuntimeInferVarTypeContext infer_var_type_ctx(ins, &outs, op_->Attrs());
+    info.infer_var_type_(&infer_var_type_ctx);
+  }
+
+  recorded_.reset(new RecordedRun());
+  for (auto& var_pair : outs) {
+    for (auto& var : var_pair.second) {
+      InitializeVariable(var->MutableVar(), var->Type());
+      recorded_->out_types.emplace_back(var->Type(), var->DataType());
+    }
+  }
+
+  VLOG(3) << "Running and recording Op " << Type();
+  recorded_->ctx.reset(
+      new framework::RuntimeContext(PrepareRuntimeContext(ins, outs)));
+  recorded_->prepared_op.reset(new PreparedOp(
+      PreparedOp::Prepare(*recorded_->ctx, *op_kernel, place(), ins)));
+  recorded_->prepared_op->Run();
+}
+
+void OpBase::Replay(const NameVarBaseMap& ins, const NameVarBaseMap& outs) {
+  PADDLE_ENFORCE_NOT_NULL(recorded_, "Op %s has no recorded run to replay",
+                          Type());
+  size_t i = 0;
+  for (auto& var_pair : outs) {
+    for (auto& var : var_pair.second) {
+      PADDLE_ENFORCE_LT(i, recorded_->out_types.size(),
+                        "Op %s is replayed with more outputs", Type());
+      var->SetType(recorded_->out_types[i].first);
+      var->SetDataType(recorded_->out_types[i].second);
+      InitializeVariable(var->MutableVar(), var->Type());
+      ++i;
+    }
+  }
+
+  VLOG(3) << "Replaying Op " << Type();
+  auto runtime_ctx = PrepareRuntimeContext(ins, outs);
+  auto& prepared_op = *recorded_->prepared_op;
+  PreparedOp::PrepareData(
+      prepared_op.GetDeviceContext()->GetPlace(), ins,
+      *static_cast<framework::OperatorWithKernel*>(op_.get()),
+      prepared_op.kernel_type());
+  prepared_op.Rebind(runtime_ctx).Run();
+}
+
 void OpBase::ClearBackwardTrace() {
   grad_pending_ops_.clear();
   ins_.clear();
@@ -38,6 +38,7 @@ namespace paddle {
 namespace imperative {
 
 class OpBase;
+class PreparedOp;
 
 class ThreadSafeNameSet {
  public:
@@ -348,7 +349,7 @@ class OpBase : public std::enable_shared_from_this<OpBase> {
   DISABLE_COPY_AND_ASSIGN(OpBase);
 
  public:
-  ~OpBase() { VLOG(3) << "Destruct Op: " << Type() << std::endl; }
+  ~OpBase();
 
   // Developer should not rely on this method to create OpBase.
   // OpBase should be created in Tracer and managed by Tracer totally.
@@ -363,6 +364,15 @@ class OpBase : public std::enable_shared_from_this<OpBase> {
 
   void Run(const NameVarBaseMap& ins, const NameVarBaseMap& outs);
 
+  // Run, and record the chosen kernel and the types of the outputs for
+  // Replay().
+  void RunAndRecord(const NameVarBaseMap& ins, const NameVarBaseMap& outs);
+
+  // Run with the kernel and the output types recorded by RunAndRecord(). The
+  // variables may differ, but the inputs should have the same types, data
+  // types and places as in that run, and the outputs the same types.
+  void Replay(const NameVarBaseMap& ins, const NameVarBaseMap& outs);
+
   const framework::VariableNameMap& InputNameMap() const {
     return op_->Inputs();
   }
@@ -412,9 +422,12 @@ class OpBase : public std::enable_shared_from_this<OpBase> {
   OpBase(size_t id, const framework::OpDesc& op_desc,
          const platform::Place& place);
 
+  struct RecordedRun;
+
   size_t id_;
 
   std::unique_ptr<framework::OperatorBase> op_;
+  std::unique_ptr<RecordedRun> recorded_;
 
   std::vector<std::function<void()>> backward_hooks_;
   platform::Place place_;
@@ -13,11 +13,148 @@
 // limitations under the License.
 
 #include "paddle/fluid/imperative/prepared_operator.h"
+#include <chrono>  // NOLINT
+#include <mutex>   // NOLINT
 #include <sstream>
+#include <unordered_map>
+#include "paddle/fluid/imperative/flags.h"
+#include "paddle/fluid/imperative/profiler.h"
 
 namespace paddle {
 namespace imperative {
 
+namespace {
+
+// The result of the dispatch of an op.
+struct DispatchEntry {
+  framework::OpKernelType kernel_type;
+  const framework::OperatorWithKernel::OpKernelFunc* func;
+  platform::DeviceContext* dev_ctx;
+  // Whether an input is on another place than the kernel, and may need to be
+  // transformed.
+  bool need_prepare_data;
+};
+
+// The dispatch results per op type, keyed by the place, the data types,
+// layouts and places of the inputs, and the integer, boolean and string
+// attributes. The kernel of an op is assumed to never depend on its float
+// and list attributes, nor on the dims of its inputs.
+class DispatchCache {
+ public:
+  static DispatchCache& Instance() {
+    static DispatchCache cache;
+    return cache;
+  }
+
+  // The entries are never erased, so they can be used without the lock.
+  const DispatchEntry* Find(const std::string& op_type,
+                            const std::string& key) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto op_iter = entries_.find(op_type);
+    if (op_iter == entries_.end()) return nullptr;
+    auto iter = op_iter->second.find(key);
+    return iter == op_iter->second.end() ? nullptr : &iter->second;
+  }
+
+  void Insert(const std::string& op_type, const std::string& key,
+              const DispatchEntry& entry) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    entries_[op_type].emplace(key, entry);
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string,
+                     std::unordered_map<std::string, DispatchEntry>>
+      entries_;
+};
+
+void AppendPlace(const platform::Place& place, std::string* key) {
+  key->append(std::to_string(place.which()));
+  if (platform::is_gpu_place(place)) {
+    key->push_back(':');
+    key->append(std::to_string(boost::get<platform::CUDAPlace>(place).device));
+  }
+  key->push_back(';');
+}
+
+std::string DispatchKey(const framework::OperatorWithKernel& op,
+                        const platform::Place& place,
+                        const NameVarBaseMap& ins) {
+  std::string key;
+  AppendPlace(place, &key);
+  for (const auto& name_pair : ins) {
+    key.append(name_pair.first);
+    key.push_back('(');
+    for (const auto& var_base : name_pair.second) {
+      const auto* tensor = GetTensorFromVar(var_base->Var());
+      if (tensor && tensor->IsInitialized()) {
+        key.append(std::to_string(static_cast<int>(tensor->type())));
+        key.push_back(',');
+        key.append(std::to_string(static_cast<int>(tensor->layout())));
+        key.push_back(',');
+        AppendPlace(tensor->place(), &key);
+      } else {
+        key.append("-;");
+      }
+    }
+    key.push_back(')');
+  }
+
+  // The attributes are visited in the order of the op proto, which is the
+  // same for all the ops of a type.
+  const auto& info = op.Info();
+  if (!info.HasOpProtoAndChecker()) return key;
+  const auto& attrs = op.Attrs();
+  for (const auto& attr : info.Proto().attrs()) {
+    auto iter = attrs.find(attr.name());
+    if (iter == attrs.end()) continue;
+    switch (attr.type()) {
+      case framework::proto::AttrType::INT:
+        key.append(std::to_string(boost::get<int>(iter->second)));
+        break;
+      case framework::proto::AttrType::LONG:
+        key.append(std::to_string(boost::get<int64_t>(iter->second)));
+        break;
+      case framework::proto::AttrType::BOOLEAN:
+        key.push_back(boost::get<bool>(iter->second) ? '1' : '0');
+        break;
+      case framework::proto::AttrType::STRING:
+        key.append(boost::get<std::string>(iter->second));
+        break;
+      default:
+        continue;
+    }
+    key.push_back(';');
+  }
+  return key;
+}
+
+class DispatchTimer {
+ public:
+  explicit DispatchTimer(const std::string& op_type)
+      : op_type_(op_type), enabled_(IsOpDispatchStatsEnabled()) {
+    if (enabled_) start_ = std::chrono::steady_clock::now();
+  }
+
+  ~DispatchTimer() {
+    if (!enabled_) return;
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_);
+    RecordOpDispatch(op_type_, cache_hit_, elapsed.count());
+  }
+
+  void SetCacheHit() { cache_hit_ = true; }
+
+ private:
+  const std::string& op_type_;
+  bool enabled_;
+  bool cache_hit_{false};
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace
+
 const framework::Tensor* GetTensorFromVar(const framework::Variable& var) {
   if (var.IsType<framework::LoDTensor>()) {
     return &(var.Get<framework::LoDTensor>());
@@ -60,11 +197,13 @@ void PreparedOp::PrepareData(
 
 PreparedOp::PreparedOp(const framework::OperatorBase& op,
                        const framework::RuntimeContext& ctx,
+                       const framework::OpKernelType& kernel_type,
                        framework::OperatorWithKernel::OpKernelFunc func,
                        platform::DeviceContext* dev_ctx,
                        std::vector<framework::KernelConfig>* kernel_configs)
     : op_(op),
       ctx_(ctx),
+      kernel_type_(kernel_type),
       func_(std::move(func)),
       dev_ctx_(dev_ctx),
       kernel_configs_(kernel_configs) {}
@@ -73,6 +212,22 @@ PreparedOp PreparedOp::Prepare(const framework::RuntimeContext& ctx,
                                const framework::OperatorWithKernel& op,
                                platform::Place place,
                                const NameVarBaseMap& ins) {
+  DispatchTimer timer(op.Type());
+  std::string key;
+  if (IsDispatchCacheEnabled()) {
+    key = DispatchKey(op, place, ins);
+    auto* entry = DispatchCache::Instance().Find(op.Type(), key);
+    if (entry) {
+      timer.SetCacheHit();
+      if (entry->need_prepare_data) {
+        PrepareData(entry->dev_ctx->GetPlace(), ins, op, entry->kernel_type);
+      }
+      // The kernel configs belong to the op.
+      return PreparedOp(op, ctx, entry->kernel_type, *entry->func,
+                        entry->dev_ctx, op.GetKernelConfig(entry->kernel_type));
+    }
+  }
+
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
   auto* dev_ctx = pool.Get(place);
 
@@ -106,8 +261,23 @@ PreparedOp PreparedOp::Prepare(const framework::RuntimeContext& ctx,
     place = dev_ctx->GetPlace();
   }
 
+  if (IsDispatchCacheEnabled()) {
+    bool need_prepare_data = false;
+    for (const auto& name_pair : ins) {
+      for (const auto& var_base : name_pair.second) {
+        const auto* tensor = GetTensorFromVar(var_base->Var());
+        need_prepare_data |= tensor && tensor->IsInitialized() &&
+                             !(tensor->place() == place);
+      }
+    }
+    DispatchCache::Instance().Insert(
+        op.Type(), key, DispatchEntry{expected_kernel_key, &kernel_iter->second,
+                                      dev_ctx, need_prepare_data});
+  }
+
   PrepareData(place, ins, op, expected_kernel_key);
-  return PreparedOp(op, ctx, kernel_iter->second, dev_ctx, kernel_configs);
+  return PreparedOp(op, ctx, expected_kernel_key, kernel_iter->second, dev_ctx,
+                    kernel_configs);
 }
 
 void PreparedOp::Run() {
@@ -38,6 +38,15 @@ class PreparedOp {
 
   void Run();
 
+  // The same kernel bound to the context of another run of the op, whose
+  // inputs have the same types and places.
+  PreparedOp Rebind(const framework::RuntimeContext& ctx) const {
+    return PreparedOp(op_, ctx, kernel_type_, func_, dev_ctx_,
+                      kernel_configs_);
+  }
+
+  const framework::OpKernelType& kernel_type() const { return kernel_type_; }
+
   static void PrepareData(const platform::Place& place,
                           const NameVarBaseMap& ins,
                           const framework::OperatorWithKernel& op,
@@ -46,6 +55,7 @@ class PreparedOp {
  private:
   PreparedOp(const framework::OperatorBase& op,
              const framework::RuntimeContext& ctx,
+             const framework::OpKernelType& kernel_type,
              framework::OperatorWithKernel::OpKernelFunc func,
              platform::DeviceContext* dev_ctx,
              std::vector<framework::KernelConfig>* kernel_configs);
@@ -53,6 +63,7 @@ class PreparedOp {
  private:
   const framework::OperatorBase& op_;
   const framework::RuntimeContext& ctx_;
+  framework::OpKernelType kernel_type_;
   framework::OperatorWithKernel::OpKernelFunc func_;
   platform::DeviceContext* dev_ctx_;
   std::vector<framework::KernelConfig>* kernel_configs_;
@@ -19,6 +19,7 @@
 #endif
 #include <gflags/gflags.h>
 #include <glog/logging.h>
+#include <atomic>
 #include <mutex>   // NOLINT
 #include <thread>  // NOLINT
 
@@ -58,5 +59,36 @@ void StopProfile() {
 #endif
 }
 
+static std::atomic<bool> gOpDispatchStatsEnabled{false};
+static std::mutex gOpDispatchStatsMutex;
+static std::unordered_map<std::string, OpDispatchStats> gOpDispatchStats;
+
+void EnableOpDispatchStats(bool enable) { gOpDispatchStatsEnabled = enable; }
+
+bool IsOpDispatchStatsEnabled() { return gOpDispatchStatsEnabled; }
+
+void RecordOpDispatch(const std::string& op_type, bool cache_hit,
+                      uint64_t elapsed_ns) {
+  std::lock_guard<std::mutex> guard(gOpDispatchStatsMutex);
+  auto& stats = gOpDispatchStats[op_type];
+  if (cache_hit) {
+    ++stats.num_hits;
+    stats.hit_ns += elapsed_ns;
+  } else {
+    ++stats.num_misses;
+    stats.miss_ns += elapsed_ns;
+  }
+}
+
+std::unordered_map<std::string, OpDispatchStats> GetOpDispatchStats() {
+  std::lock_guard<std::mutex> guard(gOpDispatchStatsMutex);
+  return gOpDispatchStats;
+}
+
+void ResetOpDispatchStats() {
+  std::lock_guard<std::mutex> guard(gOpDispatchStatsMutex);
+  gOpDispatchStats.clear();
+}
+
 }  // namespace imperative
 }  // namespace paddle
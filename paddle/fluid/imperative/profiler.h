@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
 namespace paddle {
 namespace imperative {
 
@@ -21,5 +25,28 @@ extern void StartProfile();
 
 extern void StopProfile();
 
+// The dispatch of an op is choosing its kernel and preparing the data of its
+// inputs for the kernel.
+struct OpDispatchStats {
+  uint64_t num_hits{0};
+  uint64_t num_misses{0};
+  // The time spent in the dispatches hitting and missing the dispatch cache,
+  // in nanoseconds. All dispatches miss when the cache is disabled.
+  uint64_t hit_ns{0};
+  uint64_t miss_ns{0};
+};
+
+extern void EnableOpDispatchStats(bool enable);
+
+extern bool IsOpDispatchStatsEnabled();
+
+extern void RecordOpDispatch(const std::string& op_type, bool cache_hit,
+                             uint64_t elapsed_ns);
+
+// The statistics per op type since they were last reset.
+extern std::unordered_map<std::string, OpDispatchStats> GetOpDispatchStats();
+
+extern void ResetOpDispatchStats();
+
 }  // namespace imperative
 }  // namespace paddle
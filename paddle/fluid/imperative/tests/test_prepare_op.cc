@@ -23,8 +23,11 @@
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/imperative/prepared_operator.h"
+#include "paddle/fluid/imperative/profiler.h"
 #include "paddle/fluid/imperative/type_defs.h"
 
+DECLARE_bool(dygraph_cache_dispatch);
+
 namespace imperative = paddle::imperative;
 namespace platform = paddle::platform;
 namespace framework = paddle::framework;
@@ -209,6 +212,49 @@ TEST(test_prepare_op, test_prepare_data_same_place) {
     }
   }
 }
+
+TEST(test_prepare_op, test_prepare_op_dispatch_cache) {
+  FLAGS_dygraph_cache_dispatch = true;
+  EnableOpDispatchStats(true);
+  ResetOpDispatchStats();
+
+  platform::CPUPlace cpu_place;
+  const auto& info = framework::OpInfoMap::Instance().Get("assign");
+  std::vector<framework::OpKernelType> kernel_types;
+  for (int i = 0; i < 3; ++i) {
+    std::shared_ptr<imperative::VarBase> vin(
+        new imperative::VarBase(false, "vin"));
+    std::shared_ptr<imperative::VarBase> vout(
+        new imperative::VarBase(false, "vout"));
+    auto* vin_tensor = vin->MutableVar()->GetMutable<framework::LoDTensor>();
+    vin_tensor->Resize(framework::make_ddim({2, 5}));
+    // The last input has another data type, which is another kernel.
+    if (i < 2) {
+      vin_tensor->mutable_data<float>(cpu_place);
+    } else {
+      vin_tensor->mutable_data<double>(cpu_place);
+    }
+
+    imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, vin))};
+    imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout))};
+    framework::OperatorWithKernel assign_op(
+        "assign", CreateVarNameMap(info, "assign", ins, true),
+        CreateVarNameMap(info, "assign", outs, false), {});
+    framework::RuntimeContext ctx = PrepareRuntimeContext(ins, outs);
+    PreparedOp prepared_op =
+        PreparedOp::Prepare(ctx, assign_op, cpu_place, ins);
+    kernel_types.emplace_back(prepared_op.kernel_type());
+  }
+  ASSERT_EQ(kernel_types[0], kernel_types[1]);
+  ASSERT_EQ(kernel_types[2].data_type_, framework::proto::VarType::FP64);
+
+  auto stats = GetOpDispatchStats();
+  ASSERT_EQ(stats["assign"].num_hits, 1UL);
+  ASSERT_EQ(stats["assign"].num_misses, 2UL);
+
+  EnableOpDispatchStats(false);
+  FLAGS_dygraph_cache_dispatch = false;
+}
 }  // namespace imperative
 }  // namespace paddle
 
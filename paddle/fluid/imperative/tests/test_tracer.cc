@@ -145,6 +145,213 @@ TEST(test_tracer, test_track_backward_input) {
   mul_attr_map["use_mkldnn"] = false;
   ASSERT_ANY_THROW(tracer.TraceOp("mul", ins, outs, mul_attr_map, place, true));
 }
+
+static std::shared_ptr<imperative::VarBase> NewFilledVar(
+    const std::string& name, const std::vector<int64_t>& dims, float value) {
+  std::shared_ptr<imperative::VarBase> var(
+      new imperative::VarBase(true, name));
+  auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim(dims));
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = value;
+  }
+  return var;
+}
+
+TEST(test_tracer, test_capture_and_replay) {
+  imperative::Tracer tracer;
+  tracer.EnableCapture(true);
+  platform::CPUPlace place;
+  framework::AttributeMap mul_attr_map;
+  mul_attr_map["use_mkldnn"] = false;
+
+  // Every step traces mul with new variables, and a different batch size in
+  // the last step.
+  std::vector<int64_t> batch_sizes = {2, 2, 3};
+  for (size_t step = 0; step < batch_sizes.size(); ++step) {
+    tracer.BeginStep();
+    auto x_in = NewFilledVar("x_in_" + std::to_string(step),
+                             {batch_sizes[step], 5}, 2.0);
+    auto y_in = NewFilledVar("y_in_" + std::to_string(step), {5, 2}, 1.0);
+    x_in->SetOverridedStopGradient(false);
+    y_in->SetOverridedStopGradient(false);
+    std::shared_ptr<imperative::VarBase> vout(
+        new imperative::VarBase(true, "vout_" + std::to_string(step)));
+    imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, x_in)),
+                                      var_pair("Y", vb_vector(1, y_in))};
+    imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout))};
+    tracer.TraceOp("mul", ins, outs, mul_attr_map, place, true);
+
+    const auto& out_tensor = vout->Var().Get<framework::LoDTensor>();
+    ASSERT_EQ(out_tensor.dims(), framework::make_ddim({batch_sizes[step], 2}));
+    for (int64_t i = 0; i < out_tensor.numel(); i++) {
+      ASSERT_EQ(out_tensor.data<float>()[i], 10.0);
+    }
+    // The grad op of the replayed op is bound to the new variables.
+    ASSERT_EQ(vout->GradVarBase()->GradOps().size(), 1UL);
+  }
+  ASSERT_EQ(tracer.NumCapturedOps(), 1UL);
+  ASSERT_EQ(tracer.NumReplayedOps(), 2UL);
+
+  // Different attributes are captured again.
+  tracer.BeginStep();
+  auto x_in = NewFilledVar("x_in", {2, 5}, 2.0);
+  auto y_in = NewFilledVar("y_in", {5, 2}, 1.0);
+  std::shared_ptr<imperative::VarBase> vout(
+      new imperative::VarBase(true, "vout"));
+  imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, x_in)),
+                                    var_pair("Y", vb_vector(1, y_in))};
+  imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout))};
+  mul_attr_map["x_num_col_dims"] = 1;
+  tracer.TraceOp("mul", ins, outs, mul_attr_map, place, true);
+  ASSERT_EQ(tracer.NumCapturedOps(), 2UL);
+  ASSERT_EQ(tracer.NumReplayedOps(), 2UL);
+}
+
+TEST(test_tracer, test_capture_only_in_steps) {
+  imperative::Tracer tracer;
+  tracer.EnableCapture(true);
+  platform::CPUPlace place;
+  framework::AttributeMap mul_attr_map;
+  mul_attr_map["use_mkldnn"] = false;
+  auto trace_mul = [&](const std::string& suffix) {
+    auto x_in = NewFilledVar("x_in_" + suffix, {2, 5}, 2.0);
+    auto y_in = NewFilledVar("y_in_" + suffix, {5, 2}, 1.0);
+    std::shared_ptr<imperative::VarBase> vout(
+        new imperative::VarBase(true, "vout_" + suffix));
+    imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, x_in)),
+                                      var_pair("Y", vb_vector(1, y_in))};
+    imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout))};
+    tracer.TraceOp("mul", ins, outs, mul_attr_map, place, true);
+    const auto& out_tensor = vout->Var().Get<framework::LoDTensor>();
+    for (int64_t i = 0; i < out_tensor.numel(); i++) {
+      ASSERT_EQ(out_tensor.data<float>()[i], 10.0);
+    }
+  };
+
+  // Nothing is captured out of a step.
+  for (int i = 0; i < 3; ++i) {
+    trace_mul("no_step_" + std::to_string(i));
+  }
+  ASSERT_EQ(tracer.NumCapturedOps(), 0UL);
+  ASSERT_EQ(tracer.NumReplayedOps(), 0UL);
+
+  tracer.BeginStep();
+  trace_mul("0_0");
+  trace_mul("0_1");
+  tracer.EndStep();
+  ASSERT_EQ(tracer.NumCapturedOps(), 2UL);
+
+  // A shorter step drops the rest of the record.
+  tracer.BeginStep();
+  trace_mul("1_0");
+  tracer.EndStep();
+  trace_mul("after_step");
+  ASSERT_EQ(tracer.NumCapturedOps(), 2UL);
+  ASSERT_EQ(tracer.NumReplayedOps(), 1UL);
+
+  tracer.BeginStep();
+  trace_mul("2_0");
+  trace_mul("2_1");
+  tracer.EndStep();
+  ASSERT_EQ(tracer.NumCapturedOps(), 3UL);
+  ASSERT_EQ(tracer.NumReplayedOps(), 2UL);
+}
+
+// Trace num_towers chains of mul ops, whose results are summed by
+// elementwise_add ops, and run the backward on num_threads threads. Return
+// the gradients of the weights.
+static std::vector<std::vector<float>> RunTowersBackward(int num_towers,
+                                                         int depth,
+                                                         size_t num_threads) {
+  imperative::Tracer tracer;
+  platform::CPUPlace place;
+  framework::AttributeMap mul_attr_map;
+  mul_attr_map["use_mkldnn"] = false;
+  vb_vector weights;
+  std::shared_ptr<imperative::VarBase> sum;
+  for (int i = 0; i < num_towers; ++i) {
+    auto out = NewFilledVar("x_" + std::to_string(i), {4, 8}, 1.0);
+    for (int j = 0; j < depth; ++j) {
+      std::string suffix = std::to_string(i) + "_" + std::to_string(j);
+      auto w = NewFilledVar("w_" + suffix, {8, 8}, 0.1 * (i + j + 1));
+      w->SetOverridedStopGradient(false);
+      weights.emplace_back(w);
+      std::shared_ptr<imperative::VarBase> mul_out(
+          new imperative::VarBase(true, "mul_out_" + suffix));
+      tracer.TraceOp("mul", {var_pair("X", vb_vector(1, out)),
+                             var_pair("Y", vb_vector(1, w))},
+                     {var_pair("Out", vb_vector(1, mul_out))}, mul_attr_map,
+                     place, true);
+      out = mul_out;
+    }
+    if (sum == nullptr) {
+      sum = out;
+    } else {
+      std::shared_ptr<imperative::VarBase> add_out(
+          new imperative::VarBase(true, "add_out_" + std::to_string(i)));
+      tracer.TraceOp("elementwise_add", {var_pair("X", vb_vector(1, sum)),
+                                         var_pair("Y", vb_vector(1, out))},
+                     {var_pair("Out", vb_vector(1, add_out))}, {}, place,
+                     true);
+      sum = add_out;
+    }
+  }
+
+  detail::BackwardStrategy strategy;
+  strategy.sorted_sum_gradient_ = true;
+  strategy.num_threads_ = num_threads;
+  tracer.GetDefaultEngine()->Init(sum.get(), strategy);
+  tracer.GetDefaultEngine()->Execute();
+
+  std::vector<std::vector<float>> grads;
+  for (auto& w : weights) {
+    auto& grad = w->GradVar().Get<framework::LoDTensor>();
+    grads.emplace_back(grad.data<float>(), grad.data<float>() + grad.numel());
+  }
+  return grads;
+}
+
+TEST(test_tracer, test_parallel_backward) {
+  auto serial_grads = RunTowersBackward(4, 3, 1);
+  auto parallel_grads = RunTowersBackward(4, 3, 4);
+  ASSERT_EQ(serial_grads.size(), 12UL);
+  // The gradients are summed in the same order with sorted_sum_gradient.
+  ASSERT_EQ(serial_grads, parallel_grads);
+}
+
+TEST(test_tracer, test_release_no_need_buffer_vars) {
+  imperative::Tracer tracer;
+  platform::CPUPlace place;
+  auto x_in = NewFilledVar("x_in", {2, 5}, 2.0);
+  x_in->SetOverridedStopGradient(false);
+  std::shared_ptr<imperative::VarBase> vout(
+      new imperative::VarBase(true, "vout"));
+  tracer.TraceOp("mean", {var_pair("X", vb_vector(1, x_in))},
+                 {var_pair("Out", vb_vector(1, vout))}, {}, place, true);
+
+  // mean_grad only needs the dims of X.
+  auto grad_ops = vout->GradVarBase()->GradOps();
+  ASSERT_EQ(grad_ops.size(), 1UL);
+  auto& grad_x = grad_ops[0]->GetInsMap().at("X");
+  ASSERT_EQ(grad_x.size(), 1UL);
+  ASSERT_NE(grad_x[0], x_in);
+  auto& grad_x_tensor = grad_x[0]->Var().Get<framework::LoDTensor>();
+  ASSERT_FALSE(grad_x_tensor.IsInitialized());
+  ASSERT_EQ(grad_x_tensor.dims(), framework::make_ddim({2, 5}));
+  ASSERT_EQ(x_in.use_count(), 1);
+
+  detail::BackwardStrategy strategy;
+  tracer.GetDefaultEngine()->Init(vout.get(), strategy);
+  tracer.GetDefaultEngine()->Execute();
+  auto& x_grad = x_in->GradVar().Get<framework::LoDTensor>();
+  ASSERT_EQ(x_grad.dims(), framework::make_ddim({2, 5}));
+  for (int64_t i = 0; i < x_grad.numel(); ++i) {
+    ASSERT_FLOAT_EQ(x_grad.data<float>()[i], 0.1);
+  }
+}
+
 #if defined(PADDLE_WITH_CUDA)
 TEST(test_tracer, test_trace_op_with_multi_device_inputs) {
   // Doing an mul
@@ -191,3 +398,5 @@ TEST(test_tracer, test_trace_op_with_multi_device_inputs) {
 }  // namespace paddle
 
 USE_OP(mul);
+USE_OP(elementwise_add);
+USE_OP(mean);
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include "paddle/fluid/imperative/tracer.h"
+#include <algorithm>
 #include <unordered_set>
 #include <utility>
 #include "paddle/fluid/platform/profiler.h"
@@ -32,6 +33,121 @@ static std::vector<std::unique_ptr<framework::OpDesc>> CreateGradOpDescs(
   }
 }
 
+namespace {
+
+// What decides the kernel, the types of the outputs and the layout of the
+// variables of an op.
+struct VarSignature {
+  framework::proto::VarType::Type type;
+  framework::proto::VarType::Type data_type;
+  bool initialized;
+  platform::Place place;
+  // The position of the first earlier occurrence of the same VarBase in the
+  // inputs and outputs of the op, or -1.
+  int alias;
+
+  bool operator==(const VarSignature& other) const {
+    return type == other.type && data_type == other.data_type &&
+           initialized == other.initialized &&
+           platform::is_same_place(place, other.place) &&
+           alias == other.alias;
+  }
+};
+
+struct OpSignature {
+  std::vector<std::pair<std::string, size_t>> in_slots;
+  std::vector<std::pair<std::string, size_t>> out_slots;
+  std::vector<VarSignature> vars;
+
+  bool operator==(const OpSignature& other) const {
+    return in_slots == other.in_slots && out_slots == other.out_slots &&
+           vars == other.vars;
+  }
+};
+
+const framework::Tensor* GetTensor(const VarBase& var) {
+  if (var.Var().IsType<framework::LoDTensor>()) {
+    return &var.Var().Get<framework::LoDTensor>();
+  } else if (var.Var().IsType<framework::SelectedRows>()) {
+    return &var.Var().Get<framework::SelectedRows>().value();
+  }
+  return nullptr;
+}
+
+void AppendSignature(const NameVarBaseMap& vars,
+                     std::vector<std::pair<std::string, size_t>>* slots,
+                     std::vector<const VarBase*>* visited,
+                     OpSignature* signature) {
+  for (auto& pair : vars) {
+    slots->emplace_back(pair.first, pair.second.size());
+    for (auto& var : pair.second) {
+      VarSignature var_sig;
+      var_sig.type = var->Type();
+      var_sig.data_type = var->DataType();
+      var_sig.initialized = false;
+      auto* tensor = GetTensor(*var);
+      if (tensor && tensor->IsInitialized()) {
+        var_sig.data_type = tensor->type();
+        var_sig.initialized = true;
+        var_sig.place = tensor->place();
+      }
+      auto iter = std::find(visited->begin(), visited->end(), var.get());
+      var_sig.alias = iter == visited->end()
+                          ? -1
+                          : static_cast<int>(iter - visited->begin());
+      visited->emplace_back(var.get());
+      signature->vars.emplace_back(var_sig);
+    }
+  }
+}
+
+OpSignature MakeSignature(const NameVarBaseMap& ins,
+                          const NameVarBaseMap& outs) {
+  OpSignature signature;
+  std::vector<const VarBase*> visited;
+  AppendSignature(ins, &signature.in_slots, &visited, &signature);
+  AppendSignature(outs, &signature.out_slots, &visited, &signature);
+  return signature;
+}
+
+}  // namespace
+
+struct Tracer::TracedOp {
+  std::string type;
+  framework::AttributeMap attrs;
+  platform::Place place;
+  OpSignature signature;
+  // The names of the inputs and outputs when the op was captured, which the
+  // grad op descs refer to.
+  std::vector<std::string> var_names;
+  std::shared_ptr<OpBase> op;
+
+  bool grad_op_descs_created{false};
+  std::vector<std::unique_ptr<framework::OpDesc>> grad_op_descs;
+  std::unordered_map<std::string, std::string> grad_to_var;
+};
+
+Tracer::Tracer() : engine_(new BasicEngine()) {}
+
+Tracer::~Tracer() = default;
+
+// A VarBase holding only the dims and the LoD of a forward variable, for the
+// grad ops which do not need its buffer, so that the buffer is released with
+// the forward variable instead of living until the backward.
+static std::shared_ptr<VarBase> CreateNoBufferVar(
+    const std::shared_ptr<VarBase>& var) {
+  if (!var->Var().IsType<framework::LoDTensor>()) return var;
+  auto& tensor = var->Var().Get<framework::LoDTensor>();
+  auto no_buffer_var = std::make_shared<VarBase>(false, var->Name());
+  no_buffer_var->SetType(var->Type());
+  no_buffer_var->SetDataType(var->DataType());
+  auto* no_buffer_tensor =
+      no_buffer_var->MutableVar()->GetMutable<framework::LoDTensor>();
+  no_buffer_tensor->Resize(tensor.dims());
+  no_buffer_tensor->set_lod(tensor.lod());
+  return no_buffer_var;
+}
+
 static void PassStopGradient(const NameVarBaseMap& outs, bool generate_grad) {
   for (const auto& name_pair : outs) {
     for (const auto& vb : name_pair.second) {
@@ -47,6 +163,14 @@ void Tracer::TraceOp(const std::string& type, const NameVarBaseMap& ins,
                      const platform::Place& place, bool trace_backward) {
   platform::RecordEvent event(type);
   VLOG(1) << "Trace Op: " << type;
+  if (capture_enabled_ && in_step_) {
+    if (!TryReplayOp(type, ins, outs, attrs, place, trace_backward)) {
+      CaptureOp(type, ins, outs, std::move(attrs), place, trace_backward);
+    }
+    ++step_pos_;
+    return;
+  }
+
   size_t op_id = GenerateUniqueId();
   auto op = OpBase::Create(op_id, type, ins, outs, std::move(attrs), place);
   op->Run(ins, outs);
@@ -60,6 +184,109 @@ void Tracer::TraceOp(const std::string& type, const NameVarBaseMap& ins,
   }
 }
 
+void Tracer::EnableCapture(bool enable) {
+  capture_enabled_ = enable;
+  traced_ops_.clear();
+  step_pos_ = 0;
+  in_step_ = false;
+}
+
+void Tracer::EndStep() {
+  if (in_step_ && step_pos_ < traced_ops_.size()) {
+    traced_ops_.resize(step_pos_);
+  }
+  in_step_ = false;
+}
+
+bool Tracer::TryReplayOp(const std::string& type, const NameVarBaseMap& ins,
+                         const NameVarBaseMap& outs,
+                         const framework::AttributeMap& attrs,
+                         const platform::Place& place, bool trace_backward) {
+  if (step_pos_ >= traced_ops_.size()) return false;
+  auto& traced = *traced_ops_[step_pos_];
+  if (traced.type != type || !platform::is_same_place(traced.place, place) ||
+      traced.attrs != attrs ||
+      !(traced.signature == MakeSignature(ins, outs))) {
+    VLOG(3) << "Op " << type << " at " << step_pos_
+            << " differs from the captured one, capture it again";
+    return false;
+  }
+
+  VLOG(3) << "Replay Op: " << type;
+  traced.op->Replay(ins, outs);
+  ++num_replayed_ops_;
+  if (ComputeRequiredGrad(ins, outs, trace_backward)) {
+    TraceCapturedBackward(&traced, ins, outs);
+  } else {
+    VLOG(3) << "No Grad to track for Op: " << type;
+  }
+  return true;
+}
+
+void Tracer::CaptureOp(const std::string& type, const NameVarBaseMap& ins,
+                       const NameVarBaseMap& outs,
+                       framework::AttributeMap attrs,
+                       const platform::Place& place, bool trace_backward) {
+  // The ops after a mismatch are unlikely to match either.
+  traced_ops_.resize(step_pos_);
+
+  std::unique_ptr<TracedOp> traced(new TracedOp());
+  traced->type = type;
+  traced->attrs = attrs;
+  traced->place = place;
+  traced->signature = MakeSignature(ins, outs);
+  for (auto* vars : {&ins, &outs}) {
+    for (auto& pair : *vars) {
+      for (auto& var : pair.second) {
+        traced->var_names.emplace_back(var->Name());
+      }
+    }
+  }
+  traced->op = OpBase::Create(GenerateUniqueId(), type, ins, outs,
+                              std::move(attrs), place);
+  traced->op->RunAndRecord(ins, outs);
+  ++num_captured_ops_;
+
+  if (ComputeRequiredGrad(ins, outs, trace_backward)) {
+    TraceCapturedBackward(traced.get(), ins, outs);
+  } else {
+    VLOG(3) << "No Grad to track for Op: " << type;
+  }
+  traced_ops_.emplace_back(std::move(traced));
+}
+
+void Tracer::TraceCapturedBackward(TracedOp* traced, const NameVarBaseMap& ins,
+                                   const NameVarBaseMap& outs) {
+  auto& fwd_op = *traced->op;
+  if (!traced->grad_op_descs_created) {
+    traced->grad_op_descs = CreateGradOpDescs(
+        fwd_op.Info(),
+        framework::OpDesc(fwd_op.Type(), fwd_op.InputNameMap(),
+                          fwd_op.OutputNameMap(), fwd_op.Attrs()),
+        {}, {}, &traced->grad_to_var);
+    traced->grad_op_descs_created = true;
+  }
+  VLOG(3) << "Create " << traced->grad_op_descs.size()
+          << " grad op desc(s) to op " << fwd_op.Type();
+  if (traced->grad_op_descs.empty()) return;
+
+  // The grad op descs refer to the variables by their names at capture time.
+  std::unordered_map<std::string, const std::shared_ptr<VarBase>*> name_to_var;
+  size_t i = 0;
+  for (auto* vars : {&ins, &outs}) {
+    for (auto& pair : *vars) {
+      for (auto& var : pair.second) {
+        name_to_var[traced->var_names[i++]] = &var;
+      }
+    }
+  }
+
+  // Use a new trace id, so that the gradients are summed in the order of
+  // this step in sorted sum mode.
+  BindGradOps(GenerateUniqueId(), fwd_op, traced->grad_op_descs,
+              traced->grad_to_var, name_to_var);
+}
+
 bool Tracer::ComputeRequiredGrad(const NameVarBaseMap& ins,
                                  const NameVarBaseMap& outs,
                                  bool trace_backward) {
@@ -123,20 +350,33 @@ void Tracer::TraceBackward(const std::shared_ptr<OpBase>& fwd_op,
     }
   }
 
+  // Use trace id to decide the order of gradient sum in sorted sum mode
+  BindGradOps(fwd_op->id(), *fwd_op, grad_op_descs_, grad_to_var, name_to_var);
+}
+
+void Tracer::BindGradOps(
+    size_t trace_id, const OpBase& fwd_op,
+    const std::vector<std::unique_ptr<framework::OpDesc>>& grad_op_descs_,
+    const std::unordered_map<std::string, std::string>& grad_to_var,
+    const std::unordered_map<std::string, const std::shared_ptr<VarBase>*>&
+        name_to_var) {
   // Build backward ins and outs
 
-  for (size_t i = 0; i < grad_op_num; i++) {
+  for (size_t i = 0; i < grad_op_descs_.size(); i++) {
     // Step1: build grad op and add them to engine
-
-    // Use trace id to decide the order of gradient sum in sorted sum mode
-    size_t trace_id = fwd_op->id();
     std::shared_ptr<OpBase> grad_op =
-        OpBase::Create(trace_id, (*(grad_op_descs_[i].get())), fwd_op->place());
+        OpBase::Create(trace_id, (*(grad_op_descs_[i].get())), fwd_op.place());
 
     // this OpBase* is just used to manage op's life time
     engine_->InsertOp(grad_op.get(), grad_op);
 
     std::unordered_set<OpBase*> visited_preceding_ops;
+    std::unordered_set<std::string> no_need_buffer_ins;
+    auto& no_need_buffer_inferer = grad_op->Info().NoNeedBufferVarsInferer();
+    if (no_need_buffer_inferer) {
+      no_need_buffer_ins = no_need_buffer_inferer(
+          grad_op->InputNameMap(), grad_op->OutputNameMap(), grad_op->Attrs());
+    }
     // Step2 : prepare grad_in vars and bind them with grad_op,
     // set inputs' grad_op as current grad_op
     for (const auto& grad_ins : grad_op_descs_[i]->Inputs()) {
@@ -175,12 +415,17 @@ void Tracer::TraceBackward(const std::shared_ptr<OpBase>& fwd_op,
           VLOG(3) << "Add Grad: " << tmp->Name() << " in to Engine";
           bwd_in.emplace_back((*(fwd_var_iter->second))->GradVarBase());
         } else {
-          // If it is a forward var, just add it
+          // If it is a forward var, just add it, or its dims and LoD if the
+          // grad op does not need its buffer
           auto fwd_var_iter = name_to_var.find(grad_in_var_name);
           PADDLE_ENFORCE_EQ(fwd_var_iter != name_to_var.end(), true,
                             "Cannot find forward variable named %s",
                             grad_in_var_name);
-          bwd_in.emplace_back(*(fwd_var_iter->second));
+          if (no_need_buffer_ins.count(grad_ins.first) > 0) {
+            bwd_in.emplace_back(CreateNoBufferVar(*(fwd_var_iter->second)));
+          } else {
+            bwd_in.emplace_back(*(fwd_var_iter->second));
+          }
         }
         VLOG(3) << "Set backward input from fwd var" << grad_ins.first << " of "
                 << grad_op->Type() << " to be "
@@ -199,7 +444,7 @@ void Tracer::TraceBackward(const std::shared_ptr<OpBase>& fwd_op,
         auto iter = grad_to_var.find(grad_out_var_name);
         PADDLE_ENFORCE_EQ(iter != grad_to_var.end(), true,
                           "Cannot find output of input grad %s in op %s",
-                          grad_out_var_name, fwd_op->Type());
+                          grad_out_var_name, fwd_op.Type());
         auto fwd_var_iter = name_to_var.find(iter->second);
         PADDLE_ENFORCE_EQ(fwd_var_iter != name_to_var.end(), true,
                           "Cannot find forward variable named %s",
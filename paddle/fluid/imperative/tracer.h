@@ -32,9 +32,9 @@ class Tracer {
   DISABLE_COPY_AND_ASSIGN(Tracer);
 
  public:
-  Tracer() : engine_(new BasicEngine()) {}
+  Tracer();
 
-  ~Tracer() = default;
+  ~Tracer();
 
   void TraceOp(const std::string& type, const NameVarBaseMap& ins,
                const NameVarBaseMap& outs, framework::AttributeMap attrs,
@@ -48,14 +48,61 @@ class Tracer {
                      const NameVarBaseMap& ins, const NameVarBaseMap& outs);
   Engine* GetDefaultEngine() const { return engine_.get(); }
 
+  // In capture mode the ops traced in a step are recorded, and when the next
+  // step traces the same op at the same position, with inputs and outputs of
+  // the same types, data types and places, the recorded op is replayed
+  // without creating the op, checking its attributes and choosing its kernel
+  // again. A mismatch drops the rest of the record and traces again from
+  // there. Only the ops traced between BeginStep() and EndStep() are
+  // captured, so the record does not grow beyond one step.
+  void EnableCapture(bool enable);
+  bool IsCaptureEnabled() const { return capture_enabled_; }
+  void BeginStep() {
+    step_pos_ = 0;
+    in_step_ = true;
+  }
+  // Drop the recorded ops that this step did not trace.
+  void EndStep();
+
+  size_t NumReplayedOps() const { return num_replayed_ops_; }
+  size_t NumCapturedOps() const { return num_captured_ops_; }
+
  private:
+  struct TracedOp;
+
   static size_t GenerateUniqueId() {
     static std::atomic<size_t> id{0};
     return id.fetch_add(1);
   }
 
+  bool TryReplayOp(const std::string& type, const NameVarBaseMap& ins,
+                   const NameVarBaseMap& outs,
+                   const framework::AttributeMap& attrs,
+                   const platform::Place& place, bool trace_backward);
+
+  void CaptureOp(const std::string& type, const NameVarBaseMap& ins,
+                 const NameVarBaseMap& outs, framework::AttributeMap attrs,
+                 const platform::Place& place, bool trace_backward);
+
+  void TraceCapturedBackward(TracedOp* traced, const NameVarBaseMap& ins,
+                             const NameVarBaseMap& outs);
+
+  void BindGradOps(
+      size_t trace_id, const OpBase& fwd_op,
+      const std::vector<std::unique_ptr<framework::OpDesc>>& grad_op_descs,
+      const std::unordered_map<std::string, std::string>& grad_to_var,
+      const std::unordered_map<std::string, const std::shared_ptr<VarBase>*>&
+          name_to_var);
+
  private:
   std::unique_ptr<Engine> engine_;
+
+  bool capture_enabled_{false};
+  bool in_step_{false};
+  std::vector<std::unique_ptr<TracedOp>> traced_ops_;
+  size_t step_pos_{0};
+  size_t num_replayed_ops_{0};
+  size_t num_captured_ops_{0};
 };
 
 }  // namespace imperative
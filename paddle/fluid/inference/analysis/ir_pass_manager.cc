@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/inference/analysis/ir_pass_manager.h"
+#include <chrono>  // NOLINT
 #include <map>
 #include <memory>
 #include <string>
@@ -22,6 +23,7 @@
 #include <vector>
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
 #include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/graph_pattern_detector.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/inference/analysis/argument.h"
 #include "paddle/fluid/inference/analysis/ir_passes/subgraph_detector.h"
@@ -159,13 +161,32 @@ std::unique_ptr<Graph> IRPassManager::Apply(std::unique_ptr<Graph> graph) {
     return graph;
   }
   PADDLE_ENFORCE(graph.get());
+  auto match_count = [](const Graph &graph) -> size_t {
+    return graph.Has(framework::ir::kPatternMatchCountAttr)
+               ? graph.Get<size_t>(framework::ir::kPatternMatchCountAttr)
+               : 0UL;
+  };
+  double total_ms = 0;
   // Apply all the passes
   for (const auto &pass : passes_) {
-    if (pass->Type() != "graph_viz_pass") {
+    bool log = pass->Type() != "graph_viz_pass";
+    if (log) {
       PrettyLogEndl(Style::H2(), "--- Running IR pass [%s]", pass->Type());
     }
+    size_t matches = match_count(*graph);
+    auto start = std::chrono::steady_clock::now();
     graph.reset(pass->Apply(graph.release()));
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    total_ms += ms;
+    if (log) {
+      PrettyLogEndl(Style::detail(), "---  [%s] took %.3f ms, %d matches",
+                    pass->Type(), ms, match_count(*graph) - matches);
+    }
   }
+  PrettyLogEndl(Style::H2(), "--- %d IR passes took %.3f ms", passes_.size(),
+                total_ms);
   return graph;
 }
 
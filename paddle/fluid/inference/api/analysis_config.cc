@@ -91,6 +91,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
                                   // params_file_ fields.
 
   CP_MEMBER(opt_cache_dir_);
+  CP_MEMBER(optim_model_file_);
   prog_file_ = std::move(other.prog_file_);
   params_file_ = std::move(other.params_file_);
 
@@ -138,6 +139,9 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(specify_input_name_);
 
   CP_MEMBER(cpu_math_library_num_threads_);
+  CP_MEMBER(inter_op_num_threads_);
+  CP_MEMBER(use_gemm_weight_packing_);
+  CP_MEMBER(use_shared_params_);
 
   CP_MEMBER(serialized_info_cache_);
 
@@ -358,6 +362,7 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << model_dir_;
   ss << prog_file_;
   ss << params_file_;
+  ss << optim_model_file_;
 
   ss << use_gpu_;
   ss << device_id_;
@@ -388,6 +393,9 @@ std::string AnalysisConfig::SerializeInfoCache() {
 
   ss << specify_input_name_;
   ss << cpu_math_library_num_threads_;
+  ss << inter_op_num_threads_;
+  ss << use_gemm_weight_packing_;
+  ss << use_shared_params_;
   ss << use_anakin_;
   ss << anakin_min_subgraph_size_;
   return ss.str();
@@ -400,6 +408,12 @@ void AnalysisConfig::SetCpuMathLibraryNumThreads(
   Update();
 }
 
+void AnalysisConfig::SetInterOpNumThreads(int inter_op_num_threads) {
+  inter_op_num_threads_ = inter_op_num_threads;
+
+  Update();
+}
+
 float AnalysisConfig::fraction_of_gpu_memory_for_pool() const {
 #ifdef PADDLE_WITH_CUDA
   // Get the GPU memory details and calculate the fraction of memory for the
@@ -448,6 +462,22 @@ NativeConfig AnalysisConfig::ToNativeConfig() const {
   return config;
 }
 
+void AnalysisConfig::EnableGemmWeightPacking(bool x) {
+#ifdef PADDLE_WITH_MKLML
+  use_gemm_weight_packing_ = x;
+#else
+  LOG(ERROR) << "Please compile with MKLML first to use GEMM weight packing";
+  use_gemm_weight_packing_ = false;
+#endif
+
+  Update();
+}
+
+void AnalysisConfig::EnableSharedParams(bool x) {
+  use_shared_params_ = x;
+  Update();
+}
+
 void AnalysisConfig::SwitchIrDebug(int x) {
   ir_debug_ = x;
   Update();
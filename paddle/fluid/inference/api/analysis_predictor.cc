@@ -31,11 +31,13 @@
 #include "paddle/fluid/framework/version.h"
 #include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/analysis/passes/memory_optimize_pass.h"
+#include "paddle/fluid/inference/api/details/optim_model_file.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/api/paddle_inference_pass.h"
 #include "paddle/fluid/inference/utils/singleton.h"
 #include "paddle/fluid/memory/memcpy.h"
+#include "paddle/fluid/operators/math/packed_weight_cache.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/gpu_info.h"
 #include "paddle/fluid/platform/place.h"
@@ -101,12 +103,17 @@ bool AnalysisPredictor::Init(
   if (!PrepareProgram(program)) {
     return false;
   }
+  if (config_.shared_params_enabled() && !status_is_cloned_) {
+    ShareParameters();
+  }
 
   // Prepare executor, create local variables.
   if (!PrepareExecutor()) {
     return true;
   }
 
+  PrepareGemmWeightPacking();
+
   // Get the feed_target_names and fetch_target_names
   PrepareFeedFetch();
 
@@ -135,7 +142,9 @@ bool AnalysisPredictor::PrepareScope(
 }
 bool AnalysisPredictor::PrepareProgram(
     const std::shared_ptr<framework::ProgramDesc> &program) {
-  if (!program) {
+  if (!program && !config_.optim_model_file().empty()) {
+    if (!LoadOptimModelFile()) return false;
+  } else if (!program) {
     if (!LoadProgramDesc()) return false;
     // If not cloned, the parameters should be loaded.
     // If config_.ir_optim() is True, parameters is loaded in
@@ -180,9 +189,84 @@ bool AnalysisPredictor::PrepareExecutor() {
 
   PADDLE_ENFORCE_NOT_NULL(sub_scope_);
 
+  if (config_.inter_op_num_threads() > 1) {
+    // The GPU kernels share the streams and handles of a device, and the
+    // MKLDNN kernels transform layouts in scopes created at run time.
+    if (config_.use_gpu() || config_.mkldnn_enabled()) {
+      LOG(WARNING) << "Inter-op parallelism only works on CPU without MKLDNN, "
+                      "the operators run one by one";
+    } else {
+      executor_->EnableInterOpParallelism(config_.inter_op_num_threads());
+    }
+  }
+
   return true;
 }
 
+void AnalysisPredictor::ShareParameters() {
+  if (!platform::is_cpu_place(place_)) {
+    LOG(WARNING) << "Only the parameters on CPU can be shared";
+    return;
+  }
+  shared_params_ = std::make_shared<details::SharedParamHandles>();
+  shared_params_->params = details::SharedParamStore::Instance().Share(
+      *inference_program_, scope_.get());
+}
+
+framework::LoDTensor *AnalysisPredictor::MutableParameter(
+    const std::string &name) {
+  auto *var = scope_->FindVar(name);
+  PADDLE_ENFORCE_NOT_NULL(var, "No parameter %s in the predictor", name);
+  auto *tensor = var->GetMutable<framework::LoDTensor>();
+  if (shared_params_ != nullptr) {
+    std::lock_guard<std::mutex> lock(shared_params_->mtx);
+    auto it = shared_params_->params.find(name);
+    if (it != shared_params_->params.end()) {
+      auto *param = it->second.MutableData();
+      if (param->tensor.Holder() != tensor->Holder()) {
+        tensor->ShareDataWith(param->tensor);
+      }
+    }
+  }
+  // The packed form of the parameter is stale once it is written, and a
+  // copied parameter is packed too.
+  if (config_.gemm_weight_packing_enabled() && tensor->IsInitialized() &&
+      platform::is_cpu_place(tensor->place())) {
+    auto &packed_cache = operators::math::PackedWeightCache::Instance();
+    packed_cache.AddWeight(*tensor);
+    packed_cache.Invalidate(*tensor);
+  }
+  return tensor;
+}
+
+void AnalysisPredictor::PrepareGemmWeightPacking() {
+  if (!config_.gemm_weight_packing_enabled()) return;
+  auto &packed_cache = operators::math::PackedWeightCache::Instance();
+  // Drop the packed weights of the predictors that have been destroyed.
+  packed_cache.ReleaseExpired();
+  int num_weights = 0;
+  for (auto *var_desc : inference_program_->Block(0).AllVars()) {
+    if (!IsPersistable(var_desc)) continue;
+    auto *var = scope_->FindVar(var_desc->Name());
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+    auto &tensor = var->Get<framework::LoDTensor>();
+    if (tensor.IsInitialized() && platform::is_cpu_place(tensor.place())) {
+      packed_cache.AddWeight(tensor);
+      ++num_weights;
+    }
+  }
+  VLOG(3) << num_weights << " weights are allowed to be packed";
+  log_packed_weights_ = num_weights > 0;
+}
+
+void AnalysisPredictor::LogPackedWeights() {
+  if (!log_packed_weights_) return;
+  log_packed_weights_ = false;
+  auto &packed_cache = operators::math::PackedWeightCache::Instance();
+  VLOG(3) << packed_cache.Size() << " packed weights take "
+          << packed_cache.MemorySize() << " bytes";
+}
+
 void AnalysisPredictor::MkldnnPreSet(const std::vector<PaddleTensor> &inputs) {
 #ifdef PADDLE_WITH_MKLDNN
   VLOG(2) << "AnalysisPredictor::Run get_cur_mkldnn_session_id="
@@ -240,6 +324,7 @@ bool AnalysisPredictor::Run(const std::vector<PaddleTensor> &inputs,
   // Run the inference program
   // if share variables, we need not create variables
   executor_->Run();
+  LogPackedWeights();
 
   // get fetch variable
   if (!GetFetch(output_data, scope)) {
@@ -630,6 +715,7 @@ std::unique_ptr<ZeroCopyTensor> AnalysisPredictor::GetOutputTensor(
 bool AnalysisPredictor::ZeroCopyRun() {
   paddle::platform::SetNumThreads(config_.cpu_math_library_num_threads());
   executor_->Run();
+  LogPackedWeights();
   // Fix TensorArray reuse not cleaned bug.
   tensor_array_batch_cleaner_.CollectTensorArrays(sub_scope_);
   tensor_array_batch_cleaner_.ResetTensorArray();
@@ -741,6 +827,16 @@ bool AnalysisPredictor::LoadParameters() {
   return true;
 }
 
+bool AnalysisPredictor::LoadOptimModelFile() {
+  inference_program_ = details::LoadOptimModelFile(config_.optim_model_file(),
+                                                   scope_.get(), place_);
+  // The other persistable variables, like RAW ones, are not in the file.
+  executor_->CreateVariables(*inference_program_, 0, true, sub_scope_);
+  LOG(INFO) << "Load the optimized model " << config_.optim_model_file()
+            << ", skip the IR optimization";
+  return true;
+}
+
 #if PADDLE_WITH_TENSORRT
 bool AnalysisPredictor::SaveTrtCalibToDisk() {
   PADDLE_ENFORCE(config_.tensorrt_engine_enabled(),
@@ -809,6 +905,13 @@ AnalysisPredictor::~AnalysisPredictor() {
   if (sub_scope_) {
     scope_->DeleteScope(sub_scope_);
   }
+  if (config_.gemm_weight_packing_enabled()) {
+    // Release the parameters unless other predictors hold them, and then
+    // their packed weights.
+    shared_params_.reset();
+    scope_.reset();
+    operators::math::PackedWeightCache::Instance().ReleaseExpired();
+  }
 
 #if PADDLE_WITH_MKLDNN
   if (mkldnn_quantizer_) {
@@ -821,6 +924,9 @@ AnalysisPredictor::~AnalysisPredictor() {
 std::unique_ptr<PaddlePredictor> AnalysisPredictor::Clone() {
   std::lock_guard<std::mutex> lk(clone_mutex_);
   auto *x = new AnalysisPredictor(config_);
+  // The clone writes the parameters of the shared scope through the same
+  // handles.
+  x->shared_params_ = shared_params_;
   x->Init(scope_, inference_program_);
   return std::unique_ptr<PaddlePredictor>(x);
 }
@@ -899,6 +1005,15 @@ void AnalysisPredictor::SaveOptimModel(const std::string &dir) {
   exe.Run(save_program, scope(), 0, true, true);
 }
 
+void AnalysisPredictor::SaveOptimModelFile(const std::string &path) {
+  // The engines of the subgraphs are built by the passes, and not saved.
+  PADDLE_ENFORCE(
+      !config_.tensorrt_engine_enabled() && !config_.anakin_engine_enabled(),
+      "The optimized model file does not support TensorRT and Anakin "
+      "subgraphs.");
+  details::SaveOptimModelFile(path, program(), *scope());
+}
+
 template <>
 std::unique_ptr<PaddlePredictor> CreatePaddlePredictor<AnalysisConfig>(
     const AnalysisConfig &config) {
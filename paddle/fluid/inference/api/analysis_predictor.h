@@ -17,12 +17,14 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "paddle/fluid/framework/naive_executor.h"
 #include "paddle/fluid/framework/op_compatible_info.h"
 #include "paddle/fluid/inference/analysis/analyzer.h"
 #include "paddle/fluid/inference/api/api_impl.h"
 #include "paddle/fluid/inference/api/details/reset_tensor_array.h"
+#include "paddle/fluid/inference/api/details/shared_param_store.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/string/printf.h"
@@ -91,14 +93,31 @@ class AnalysisPredictor : public PaddlePredictor {
   // save parameters to params
   void SaveOptimModel(const std::string &dir);
 
+  // Save the optimized program and its parameters to a single file, which
+  // AnalysisConfig::SetOptimModelFile loads without running the passes.
+  void SaveOptimModelFile(const std::string &path);
+
+  // Get the parameter name to write. A parameter shared with other predictors
+  // by AnalysisConfig::EnableSharedParams is copied first, so the others keep
+  // its value. The clones share the parameters of this predictor anyway.
+  // Write it before the next run, which packs the GEMM weights of it again.
+  framework::LoDTensor *MutableParameter(const std::string &name);
+
  protected:
   bool PrepareProgram(const std::shared_ptr<framework::ProgramDesc> &program);
   bool PrepareScope(const std::shared_ptr<framework::Scope> &parent_scope);
   bool CreateExecutor();
   bool PrepareExecutor();
+  // Register the persistable parameters to be packed by the GEMM kernels.
+  void PrepareGemmWeightPacking();
+  // Log the packed weights once the first run has packed them.
+  void LogPackedWeights();
+  // Share the identical parameters with the other predictors.
+  void ShareParameters();
 
   bool LoadProgramDesc();
   bool LoadParameters();
+  bool LoadOptimModelFile();
 
   bool SetFeed(const std::vector<PaddleTensor> &input_datas,
                framework::Scope *scope);
@@ -144,6 +163,7 @@ class AnalysisPredictor : public PaddlePredictor {
   platform::Place place_;
   std::shared_ptr<framework::Scope> scope_;
   framework::Scope *sub_scope_{nullptr};
+  bool log_packed_weights_{false};
   std::shared_ptr<framework::ProgramDesc> inference_program_;
   framework::OpCompatibleMap op_compatible_map_;
   std::vector<framework::OpDesc *> feeds_;
@@ -166,6 +186,9 @@ class AnalysisPredictor : public PaddlePredictor {
   // Memory buffer for feed inputs. The temporary LoDTensor will cause serious
   // concurrency problems, wrong results and memory leak, so cache them.
   std::vector<framework::LoDTensor> feed_tensors_;
+  // The handles of the parameters shared by AnalysisConfig::EnableSharedParams,
+  // the same for a predictor and its clones.
+  std::shared_ptr<details::SharedParamHandles> shared_params_;
   details::TensorArrayBatchCleaner tensor_array_batch_cleaner_;
   // A mutex help to make Clone thread safe.
   std::mutex clone_mutex_;
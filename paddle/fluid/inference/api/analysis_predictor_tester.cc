@@ -15,6 +15,7 @@
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <cstdio>
 #include <thread>  // NOLINT
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/tensor.h"
@@ -196,6 +197,100 @@ TEST(AnalysisPredictor, Clone) {
   }
 }
 
+TEST(AnalysisPredictor, optim_model_file) {
+  const std::string path = "analysis_predictor_optim_model_file";
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  std::vector<PaddleTensor> outputs;
+  inference::Timer timer;
+  {
+    AnalysisConfig config;
+    config.SetModel(FLAGS_dirname);
+    config.DisableGpu();
+    timer.tic();
+    auto predictor = CreatePaddlePredictor(config);
+    LOG(INFO) << "create from the model: " << timer.toc() << " ms";
+    ASSERT_TRUE(predictor->Run(inputs, &outputs));
+    static_cast<AnalysisPredictor*>(predictor.get())->SaveOptimModelFile(path);
+  }
+
+  AnalysisConfig config;
+  config.SetOptimModelFile(path);
+  config.DisableGpu();
+  timer.tic();
+  auto predictor = CreatePaddlePredictor(config);
+  LOG(INFO) << "create from the optimized model file: " << timer.toc()
+            << " ms";
+  auto clone = predictor->Clone();
+  for (auto* p : {predictor.get(), clone.get()}) {
+    std::vector<PaddleTensor> file_outputs;
+    ASSERT_TRUE(p->Run(inputs, &file_outputs));
+    ASSERT_EQ(file_outputs.size(), outputs.size());
+    inference::CompareTensor(outputs.front(), file_outputs.front());
+  }
+  std::remove(path.c_str());
+}
+
+TEST(AnalysisPredictor, shared_params) {
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.EnableSharedParams();
+  auto predictor = CreatePaddlePredictor(config);
+  auto other = CreatePaddlePredictor(config);
+  auto* predictor_p = static_cast<AnalysisPredictor*>(predictor.get());
+  auto* other_p = static_cast<AnalysisPredictor*>(other.get());
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+  std::vector<PaddleTensor> outputs, other_outputs;
+  ASSERT_TRUE(predictor->Run(inputs, &outputs));
+  ASSERT_TRUE(other->Run(inputs, &other_outputs));
+  inference::CompareTensor(outputs.front(), other_outputs.front());
+
+  // The parameters are held once.
+  std::string name;
+  for (auto* var : predictor_p->program().Block(0).AllVars()) {
+    if (var->Persistable() &&
+        var->GetType() == framework::proto::VarType::LOD_TENSOR) {
+      name = var->Name();
+      break;
+    }
+  }
+  ASSERT_FALSE(name.empty());
+  auto& param =
+      predictor_p->scope()->FindVar(name)->Get<framework::LoDTensor>();
+  auto& other_param =
+      other_p->scope()->FindVar(name)->Get<framework::LoDTensor>();
+  ASSERT_EQ(param.data<void>(), other_param.data<void>());
+
+  // Writing one copies it first.
+  auto* written = other_p->MutableParameter(name);
+  EXPECT_NE(written->data<void>(), param.data<void>());
+  EXPECT_EQ(written->dims(), param.dims());
+
+  // A clone writes through the handles of its parent, so both of them keep
+  // the one copy of the shared scope. The third predictor holds the parameter
+  // too, so the clone has to copy it.
+  auto third = CreatePaddlePredictor(config);
+  const void* original = param.data<void>();
+  auto clone = predictor->Clone();
+  auto* clone_p = static_cast<AnalysisPredictor*>(clone.get());
+  void* copy = clone_p->MutableParameter(name)->data<void>();
+  EXPECT_NE(copy, original);
+  EXPECT_EQ(predictor_p->MutableParameter(name)->data<void>(), copy);
+  EXPECT_EQ(clone_p->MutableParameter(name)->data<void>(), copy);
+}
+
 // This function is not released yet, will fail on some machine.
 // TODO(Superjomn) Turn on it latter.
 /*
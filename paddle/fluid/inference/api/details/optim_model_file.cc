@@ -0,0 +1,321 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/details/optim_model_file.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace details {
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'D', 'O', 'P', 'T', 'M', 'D', 'L'};
+constexpr uint32_t kVersion = 1;
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_params;
+  uint64_t program_offset;
+  uint64_t program_size;
+  uint64_t index_offset;
+  uint64_t index_size;
+  uint64_t reserved[2];
+};
+static_assert(sizeof(Header) == kOptimModelAlignment,
+              "The header should fill the first aligned block.");
+
+size_t AlignUp(size_t size) {
+  return (size + kOptimModelAlignment - 1) / kOptimModelAlignment *
+         kOptimModelAlignment;
+}
+
+template <typename T>
+void Append(std::string *buf, const T &value) {
+  buf->append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+class IndexReader {
+ public:
+  IndexReader(const char *data, size_t size) : data_(data), size_(size) {}
+
+  template <typename T>
+  T Read() {
+    T value;
+    std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  std::string ReadString() {
+    uint32_t size = Read<uint32_t>();
+    return std::string(Take(size), size);
+  }
+
+ private:
+  const char *Take(size_t size) {
+    PADDLE_ENFORCE_LE(pos_ + size, size_,
+                      "The index of the optimized model file is truncated.");
+    const char *ptr = data_ + pos_;
+    pos_ += size;
+    return ptr;
+  }
+
+  const char *data_;
+  size_t size_;
+  size_t pos_{0};
+};
+
+#ifndef _WIN32
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    PADDLE_ENFORCE_GE(fd, 0, "Cannot open the optimized model file %s", path);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      PADDLE_THROW("Cannot stat the optimized model file %s", path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    // Private writable mapping: the pages are shared with the page cache until
+    // somebody writes them, a stray write never reaches the file.
+    void *ptr = size_ == 0 ? MAP_FAILED
+                           : mmap(nullptr, size_, PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE, fd, 0);
+    close(fd);
+    PADDLE_ENFORCE(ptr != MAP_FAILED, "Cannot map the optimized model file %s",
+                   path);
+    data_ = static_cast<char *>(ptr);
+  }
+
+  ~MappedFile() { munmap(data_, size_); }
+
+  char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  char *data_{nullptr};
+  size_t size_{0};
+};
+#else
+// Without mmap the file is read into memory once, and shared in the same way.
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &path) {
+    std::ifstream fin(path, std::ios::in | std::ios::binary);
+    PADDLE_ENFORCE(static_cast<bool>(fin.is_open()),
+                   "Cannot open the optimized model file %s", path);
+    fin.seekg(0, std::ios::end);
+    size_ = static_cast<size_t>(fin.tellg());
+    fin.seekg(0, std::ios::beg);
+    buffer_.resize(size_ + kOptimModelAlignment);
+    char *base = buffer_.data();
+    data_ = base + (kOptimModelAlignment -
+                    reinterpret_cast<uintptr_t>(base) % kOptimModelAlignment);
+    fin.read(data_, size_);
+  }
+
+  char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  std::vector<char> buffer_;
+  char *data_{nullptr};
+  size_t size_{0};
+};
+#endif
+
+// A parameter living in the mapped file, which stays mapped as long as any
+// of its parameters is held.
+class MappedAllocation : public memory::Allocation {
+ public:
+  MappedAllocation(const std::shared_ptr<MappedFile> &file, size_t offset,
+                   size_t size)
+      : Allocation(file->data() + offset, size, platform::CPUPlace()),
+        file_(file) {}
+
+ private:
+  std::shared_ptr<MappedFile> file_;
+};
+
+}  // namespace
+
+void SaveOptimModelFile(const std::string &path,
+                        const framework::ProgramDesc &program,
+                        const framework::Scope &scope) {
+  std::string program_str;
+  // Proto() only flushes the descs into the proto.
+  auto *proto = const_cast<framework::ProgramDesc &>(program).Proto();
+  PADDLE_ENFORCE(proto->SerializeToString(&program_str),
+                 "Cannot serialize the program.");
+
+  std::vector<std::string> names;
+  std::vector<framework::LoDTensor> tensors;
+  for (auto *var : program.Block(0).AllVars()) {
+    if (!var->Persistable() ||
+        var->GetType() != framework::proto::VarType::LOD_TENSOR) {
+      continue;
+    }
+    auto *scope_var = scope.FindVar(var->Name());
+    if (!scope_var || !scope_var->IsType<framework::LoDTensor>()) continue;
+    auto &tensor = scope_var->Get<framework::LoDTensor>();
+    if (!tensor.IsInitialized()) continue;
+    framework::LoDTensor cpu_tensor;
+    if (platform::is_cpu_place(tensor.place())) {
+      cpu_tensor.ShareDataWith(tensor);
+    } else {
+      framework::TensorCopySync(tensor, platform::CPUPlace(), &cpu_tensor);
+    }
+    cpu_tensor.set_lod(tensor.lod());
+    names.push_back(var->Name());
+    tensors.push_back(cpu_tensor);
+  }
+
+  // The index is built twice, the first time only to know its size.
+  auto build_index = [&](size_t data_offset) -> std::string {
+    std::string index;
+    for (size_t i = 0; i < names.size(); ++i) {
+      auto &tensor = tensors[i];
+      Append(&index, static_cast<uint32_t>(names[i].size()));
+      index.append(names[i]);
+      Append(&index, static_cast<int32_t>(tensor.type()));
+      Append(&index, static_cast<uint32_t>(tensor.dims().size()));
+      for (int d = 0; d < tensor.dims().size(); ++d) {
+        Append(&index, static_cast<int64_t>(tensor.dims()[d]));
+      }
+      Append(&index, static_cast<uint32_t>(tensor.lod().size()));
+      for (auto &level : tensor.lod()) {
+        Append(&index, static_cast<uint64_t>(level.size()));
+        for (size_t offset : level) {
+          Append(&index, static_cast<uint64_t>(offset));
+        }
+      }
+      size_t size = tensor.numel() * framework::SizeOfType(tensor.type());
+      Append(&index, static_cast<uint64_t>(data_offset));
+      Append(&index, static_cast<uint64_t>(size));
+      data_offset = AlignUp(data_offset + size);
+    }
+    return index;
+  };
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.num_params = static_cast<uint32_t>(names.size());
+  header.program_offset = sizeof(Header);
+  header.program_size = program_str.size();
+  header.index_offset = header.program_offset + header.program_size;
+  header.index_size = build_index(0).size();
+  size_t data_offset = AlignUp(header.index_offset + header.index_size);
+  std::string index = build_index(data_offset);
+
+  std::ofstream fout(path, std::ios::out | std::ios::binary);
+  PADDLE_ENFORCE(static_cast<bool>(fout.is_open()), "Cannot open %s to write",
+                 path);
+  fout.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  fout.write(program_str.data(), program_str.size());
+  fout.write(index.data(), index.size());
+  size_t pos = header.index_offset + header.index_size;
+  const std::string padding(kOptimModelAlignment, '\0');
+  for (auto &tensor : tensors) {
+    fout.write(padding.data(), AlignUp(pos) - pos);
+    pos = AlignUp(pos);
+    size_t size = tensor.numel() * framework::SizeOfType(tensor.type());
+    fout.write(static_cast<const char *>(tensor.data<void>()), size);
+    pos += size;
+  }
+  fout.close();
+  PADDLE_ENFORCE(static_cast<bool>(fout), "Failed to write %s", path);
+}
+
+std::unique_ptr<framework::ProgramDesc> LoadOptimModelFile(
+    const std::string &path, framework::Scope *scope,
+    const platform::Place &place) {
+  PADDLE_ENFORCE_NOT_NULL(scope);
+  auto file = std::make_shared<MappedFile>(path);
+  PADDLE_ENFORCE_GE(file->size(), sizeof(Header),
+                    "%s is not an optimized model file.", path);
+  Header header;
+  std::memcpy(&header, file->data(), sizeof(Header));
+  PADDLE_ENFORCE(std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0,
+                 "%s is not an optimized model file.", path);
+  PADDLE_ENFORCE_EQ(header.version, kVersion,
+                    "The version of the optimized model file %s is not "
+                    "supported.",
+                    path);
+  PADDLE_ENFORCE_LE(header.program_offset + header.program_size, file->size(),
+                    "The optimized model file %s is truncated.", path);
+  PADDLE_ENFORCE_LE(header.index_offset + header.index_size, file->size(),
+                    "The optimized model file %s is truncated.", path);
+
+  framework::proto::ProgramDesc proto;
+  PADDLE_ENFORCE(proto.ParseFromArray(file->data() + header.program_offset,
+                                      static_cast<int>(header.program_size)),
+                 "Cannot parse the program of %s", path);
+  std::unique_ptr<framework::ProgramDesc> program(
+      new framework::ProgramDesc(proto));
+
+  IndexReader reader(file->data() + header.index_offset, header.index_size);
+  for (uint32_t i = 0; i < header.num_params; ++i) {
+    std::string name = reader.ReadString();
+    auto type =
+        static_cast<framework::proto::VarType::Type>(reader.Read<int32_t>());
+    std::vector<int64_t> dims(reader.Read<uint32_t>());
+    for (auto &dim : dims) {
+      dim = reader.Read<int64_t>();
+    }
+    framework::LoD lod(reader.Read<uint32_t>());
+    for (auto &level : lod) {
+      level.resize(reader.Read<uint64_t>());
+      for (size_t j = 0; j < level.size(); ++j) {
+        level[j] = reader.Read<uint64_t>();
+      }
+    }
+    uint64_t offset = reader.Read<uint64_t>();
+    uint64_t size = reader.Read<uint64_t>();
+    PADDLE_ENFORCE_LE(offset + size, file->size(),
+                      "The data of %s is out of the optimized model file.",
+                      name);
+
+    framework::Tensor mapped(type);
+    mapped.Resize(framework::make_ddim(dims));
+    PADDLE_ENFORCE_EQ(mapped.numel() * framework::SizeOfType(type), size,
+                      "The data size of %s does not match its shape.", name);
+    mapped.ResetHolder(std::make_shared<MappedAllocation>(file, offset, size));
+    auto *tensor = scope->Var(name)->GetMutable<framework::LoDTensor>();
+    if (platform::is_cpu_place(place)) {
+      tensor->ShareDataWith(mapped);
+    } else {
+      framework::TensorCopySync(mapped, place, tensor);
+    }
+    tensor->set_lod(lod);
+  }
+  return program;
+}
+
+}  // namespace details
+}  // namespace paddle
@@ -0,0 +1,57 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace details {
+
+/*
+ * An optimized model file holds an analyzed program and its parameters, so
+ * that a predictor can start without running the IR passes and deserializing
+ * the parameters one by one.
+ *
+ * Layout, all integers are little endian:
+ *   header     64 bytes, magic "PDOPTMDL", version, the number of parameters,
+ *              offset and size of the program and of the index.
+ *   program    the serialized proto::ProgramDesc.
+ *   index      per parameter: name, data type, dims, LoD, offset and size of
+ *              its data.
+ *   data       the raw data of every parameter, each aligned to 64 bytes.
+ */
+constexpr size_t kOptimModelAlignment = 64;
+
+// Write the program and the persistable LoDTensors of its global block found
+// in scope to path. The tensors may be on any place.
+void SaveOptimModelFile(const std::string &path,
+                        const framework::ProgramDesc &program,
+                        const framework::Scope &scope);
+
+// Load the program of the file at path, and create its parameters in scope.
+// On CPU the parameters are bound to the pages of the file mapped
+// copy-on-write, so they are only read from disk when used, and they are
+// shared by the processes and predictors loading the same file. On other
+// places the parameters are copied from the mapping.
+std::unique_ptr<framework::ProgramDesc> LoadOptimModelFile(
+    const std::string &path, framework::Scope *scope,
+    const platform::Place &place);
+
+}  // namespace details
+}  // namespace paddle
@@ -0,0 +1,141 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/inference/api/details/shared_param_store.h"
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/tensor_util.h"
+
+namespace paddle {
+namespace details {
+
+namespace {
+
+size_t NumBytes(const framework::Tensor &tensor) {
+  return tensor.numel() * framework::SizeOfType(tensor.type());
+}
+
+// FNV-1a of the data, data type and dims.
+uint64_t Hash(const framework::LoDTensor &tensor) {
+  uint64_t hash = 14695981039346656037ULL;
+  auto update = [&hash](const void *data, size_t size) {
+    auto *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i) {
+      hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+  };
+  auto type = static_cast<int>(tensor.type());
+  update(&type, sizeof(type));
+  for (int i = 0; i < tensor.dims().size(); ++i) {
+    int64_t dim = tensor.dims()[i];
+    update(&dim, sizeof(dim));
+  }
+  update(tensor.data<void>(), NumBytes(tensor));
+  return hash;
+}
+
+bool Identical(const framework::LoDTensor &a, const framework::LoDTensor &b) {
+  return a.type() == b.type() && a.dims() == b.dims() && a.lod() == b.lod() &&
+         std::memcmp(a.data<void>(), b.data<void>(), NumBytes(a)) == 0;
+}
+
+}  // namespace
+
+SharedParam::SharedParam(const framework::LoDTensor &tensor) {
+  this->tensor.ShareDataWith(tensor);
+  this->tensor.set_lod(tensor.lod());
+}
+
+SharedParam::SharedParam(const SharedParam &other) {
+  framework::TensorCopySync(other.tensor, other.tensor.place(), &tensor);
+  tensor.set_lod(other.tensor.lod());
+}
+
+SharedParamStore &SharedParamStore::Instance() {
+  static SharedParamStore store;
+  return store;
+}
+
+std::unordered_map<std::string, SharedParamPtr> SharedParamStore::Share(
+    const framework::ProgramDesc &program, framework::Scope *scope) {
+  PADDLE_ENFORCE_NOT_NULL(scope);
+  // Hash the parameters before locking the store, it reads all their bytes.
+  std::vector<std::pair<const framework::VarDesc *, framework::LoDTensor *>>
+      tensors;
+  std::vector<uint64_t> hashes;
+  for (auto *var_desc : program.Block(0).AllVars()) {
+    if (!var_desc->Persistable()) continue;
+    auto *var = scope->FindVar(var_desc->Name());
+    if (var == nullptr || !var->IsType<framework::LoDTensor>()) continue;
+    auto *tensor = var->GetMutable<framework::LoDTensor>();
+    if (!tensor->IsInitialized() || !platform::is_cpu_place(tensor->place())) {
+      continue;
+    }
+    tensors.emplace_back(var_desc, tensor);
+    hashes.push_back(Hash(*tensor));
+  }
+
+  std::unordered_map<std::string, SharedParamPtr> handles;
+  int num_shared = 0;
+  size_t shared_bytes = 0;
+  std::lock_guard<std::mutex> lock(mtx_);
+  ReleaseExpired();
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    auto *tensor = tensors[i].second;
+    std::shared_ptr<SharedParam> param;
+    auto range = params_.equal_range(hashes[i]);
+    for (auto it = range.first; it != range.second && !param; ++it) {
+      auto candidate = it->second.lock();
+      if (candidate && Identical(candidate->tensor, *tensor)) {
+        param = candidate;
+      }
+    }
+    if (param) {
+      if (param->tensor.Holder() != tensor->Holder()) {
+        shared_bytes += NumBytes(*tensor);
+        tensor->ShareDataWith(param->tensor);
+      }
+      ++num_shared;
+    } else {
+      param = std::make_shared<SharedParam>(*tensor);
+      params_.emplace(hashes[i], param);
+    }
+    handles.emplace(tensors[i].first->Name(), SharedParamPtr(param));
+  }
+  LOG(INFO) << "Share " << num_shared << " of " << handles.size()
+            << " parameters with the other predictors, " << shared_bytes
+            << " bytes released";
+  return handles;
+}
+
+size_t SharedParamStore::Size() {
+  std::lock_guard<std::mutex> lock(mtx_);
+  ReleaseExpired();
+  return params_.size();
+}
+
+void SharedParamStore::ReleaseExpired() {
+  for (auto it = params_.begin(); it != params_.end();) {
+    if (it->second.expired()) {
+      it = params_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace details
+}  // namespace paddle
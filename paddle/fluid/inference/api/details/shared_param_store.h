@@ -0,0 +1,84 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include "paddle/fluid/framework/details/cow_ptr.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+
+namespace paddle {
+namespace details {
+
+// A parameter shared by the predictors.
+struct SharedParam {
+  SharedParam() = default;
+  explicit SharedParam(const framework::LoDTensor &tensor);
+  // COWPtr copies a parameter written while it is shared, so the copy is
+  // deep.
+  SharedParam(const SharedParam &other);
+
+  framework::LoDTensor tensor;
+};
+
+// The handle of a predictor to a shared parameter, MutableData() copies the
+// parameter first if other predictors hold it too.
+using SharedParamPtr = framework::details::COWPtr<SharedParam>;
+
+// The handles of the shared parameters of a predictor, by variable name. The
+// clones of a predictor use its scope, so they share its handles too.
+struct SharedParamHandles {
+  std::mutex mtx;
+  std::unordered_map<std::string, SharedParamPtr> params;
+};
+
+/*
+ * A process wide store of the parameters of the predictors, addressed by
+ * their content. Several versions of a model, or models sharing a large
+ * embedding table, then hold the identical parameters once.
+ *
+ * The store only holds weak references, a parameter lives as long as some
+ * predictor holds a handle to it.
+ */
+class SharedParamStore {
+ public:
+  static SharedParamStore &Instance();
+
+  // Replace each initialized CPU LoDTensor among the persistable variables of
+  // the global block of program in scope by an identical parameter of the
+  // store if any, and add the others to the store. Returns the handles by
+  // variable name.
+  std::unordered_map<std::string, SharedParamPtr> Share(
+      const framework::ProgramDesc &program, framework::Scope *scope);
+
+  // The number of parameters alive in the store.
+  size_t Size();
+
+ private:
+  SharedParamStore() = default;
+
+  void ReleaseExpired();
+
+  std::mutex mtx_;
+  std::unordered_multimap<uint64_t, std::weak_ptr<SharedParam>> params_;
+};
+
+}  // namespace details
+}  // namespace paddle
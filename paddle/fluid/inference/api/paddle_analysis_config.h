@@ -67,6 +67,15 @@ struct AnalysisConfig {
   void SetOptimCacheDir(const std::string& opt_cache_dir) {
     opt_cache_dir_ = opt_cache_dir;
   }
+  /** Set the optimized model file saved by
+   * AnalysisPredictor::SaveOptimModelFile. The program and parameters are
+   * loaded from it instead of the model path, and the IR optimization is
+   * skipped.
+   */
+  void SetOptimModelFile(const std::string& x) { optim_model_file_ = x; }
+  /** Get the optimized model file path.
+   */
+  const std::string& optim_model_file() const { return optim_model_file_; }
   /** Get the model directory path.
    */
   const std::string& model_dir() const { return model_dir_; }
@@ -201,6 +210,8 @@ struct AnalysisConfig {
   bool mkldnn_enabled() const { return use_mkldnn_; }
 
   /** Set and get the number of cpu math library threads.
+   *  It is also the intra-op thread budget of the Eigen based CPU kernels,
+   *  which run on a shared Eigen thread pool when it is larger than one.
    */
   void SetCpuMathLibraryNumThreads(int cpu_math_library_num_threads);
   /** An int state telling how many threads are used in the CPU math library.
@@ -209,6 +220,38 @@ struct AnalysisConfig {
     return cpu_math_library_num_threads_;
   }
 
+  /** Set and get the number of threads that run independent operators
+   *  concurrently. The operators keep the order of their reads and writes
+   *  of every variable, so the results are the same as running them one by
+   *  one. Only works on CPU without MKLDNN, the default 1 runs the operators
+   *  in program order on the calling thread.
+   */
+  void SetInterOpNumThreads(int inter_op_num_threads);
+  /** An int state telling how many threads run the operators.
+   */
+  int inter_op_num_threads() const { return inter_op_num_threads_; }
+
+  /** Turn on GEMM weight packing.
+   *  The CPU fc, mul, matmul, fusion_gru and fusion_lstm kernels then use
+   *  MKL packed weights, which are packed once and cached, at the cost of a
+   *  packed copy of each weight. Only works with MKLML.
+   */
+  void EnableGemmWeightPacking(bool x = true);
+  /** A boolean state telling whether GEMM weight packing is enabled.
+   */
+  bool gemm_weight_packing_enabled() const { return use_gemm_weight_packing_; }
+
+  /** Turn on sharing the parameters with the other predictors.
+   *  The CPU parameters are looked up by content in a process wide store
+   *  after loading and optimization, and the identical ones of all the
+   *  predictors with this option are held once. Write a shared parameter
+   *  through AnalysisPredictor::MutableParameter, which copies it first.
+   */
+  void EnableSharedParams(bool x = true);
+  /** A boolean state telling whether the parameters are shared.
+   */
+  bool shared_params_enabled() const { return use_shared_params_; }
+
   /** Transform the AnalysisConfig to NativeConfig.
    */
   NativeConfig ToNativeConfig() const;
@@ -279,6 +322,7 @@ struct AnalysisConfig {
   std::string model_dir_;
   mutable std::string prog_file_;
   mutable std::string params_file_;
+  std::string optim_model_file_;
 
   // GPU related.
   bool use_gpu_{false};
@@ -322,6 +366,9 @@ struct AnalysisConfig {
   bool specify_input_name_{false};
 
   int cpu_math_library_num_threads_{1};
+  int inter_op_num_threads_{1};
+  bool use_gemm_weight_packing_{false};
+  bool use_shared_params_{false};
 
   bool with_profile_{false};
 
@@ -17,6 +17,8 @@ limitations under the License. */
 #include "paddle/fluid/inference/tests/api/tester_helper.h"
 
 DEFINE_bool(disable_mkldnn_fc, false, "Disable usage of MKL-DNN's FC op");
+DEFINE_int32(inter_op_num_threads, 4,
+             "The number of threads running independent operators.");
 
 namespace paddle {
 namespace inference {
@@ -108,6 +110,32 @@ TEST(Analyzer_resnet50, compare_determine) {
                        input_slots_all);
 }
 
+// Compare the result and latency of running the independent operators
+// concurrently, e.g. the branches of the inception blocks of googlenet.
+TEST(Analyzer_resnet50, inter_op_parallelism) {
+  AnalysisConfig cfg;
+  SetConfig(&cfg);
+  AnalysisConfig parallel_cfg;
+  SetConfig(&parallel_cfg);
+  parallel_cfg.SetInterOpNumThreads(FLAGS_inter_op_num_threads);
+
+  std::vector<std::vector<PaddleTensor>> input_slots_all;
+  SetInput(&input_slots_all);
+  std::vector<std::vector<PaddleTensor>> outputs, parallel_outputs;
+  float latency = 0, parallel_latency = 0;
+  TestOneThreadPrediction(
+      reinterpret_cast<const PaddlePredictor::Config *>(&cfg), input_slots_all,
+      &outputs, true, VarType::FP32, &latency);
+  TestOneThreadPrediction(
+      reinterpret_cast<const PaddlePredictor::Config *>(&parallel_cfg),
+      input_slots_all, &parallel_outputs, true, VarType::FP32,
+      &parallel_latency);
+  LOG(INFO) << "sample latency: " << latency << " ms with one inter-op "
+            << "thread, " << parallel_latency << " ms with "
+            << FLAGS_inter_op_num_threads << " inter-op threads";
+  CompareResult(outputs.back(), parallel_outputs.back());
+}
+
 // Save optim model
 TEST(Analyzer_resnet50, save_optim_model) {
   AnalysisConfig cfg;
@@ -13,6 +13,7 @@ limitations under the License. */
 #pragma once
 #include <glog/logging.h>
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -164,15 +165,15 @@ class ActivationKernel
 
     auto x = framework::EigenVector<T>::Flatten(detail::Ref(X));
     auto out = framework::EigenVector<T>::Flatten(detail::Ref(Out));
-    auto* place =
-        context.template device_context<DeviceContext>().eigen_device();
+    auto& dev_ctx = context.template device_context<DeviceContext>();
     Functor functor;
 
     auto attrs = functor.GetAttrs();
     for (auto& attr : attrs) {
       *attr.second = context.Attr<float>(attr.first);
     }
-    functor(*place, x, out);
+    platform::VisitEigenDevice(
+        dev_ctx, std::bind(functor, std::placeholders::_1, x, out));
   }
 };
 
@@ -192,14 +193,15 @@ class ActivationGradKernel
     auto out = framework::EigenVector<T>::Flatten(detail::Ref(Out));
     auto dx = framework::EigenVector<T>::Flatten(detail::Ref(dX));
     auto x = framework::EigenVector<T>::Flatten(detail::Ref(X));
-    auto* place =
-        context.template device_context<DeviceContext>().eigen_device();
+    auto& dev_ctx = context.template device_context<DeviceContext>();
     Functor functor;
     auto attrs = functor.GetAttrs();
     for (auto& attr : attrs) {
       *attr.second = context.Attr<float>(attr.first);
     }
-    functor(*place, x, out, dout, dx);
+    platform::VisitEigenDevice(
+        dev_ctx,
+        std::bind(functor, std::placeholders::_1, x, out, dout, dx));
   }
 };
 
@@ -1606,8 +1608,7 @@ class PowKernel : public framework::OpKernel<typename Functor::ELEMENT_TYPE> {
 
     auto x = framework::EigenVector<T>::Flatten(detail::Ref(X));
     auto out = framework::EigenVector<T>::Flatten(detail::Ref(Out));
-    auto* place =
-        context.template device_context<DeviceContext>().eigen_device();
+    auto& dev_ctx = context.template device_context<DeviceContext>();
     Functor functor;
     auto attrs = functor.GetAttrs();
     for (auto& attr : attrs) {
@@ -1633,7 +1634,8 @@ class PowKernel : public framework::OpKernel<typename Functor::ELEMENT_TYPE> {
         *attr.second = factor[0];
       }
     }
-    functor(*place, x, out);
+    platform::VisitEigenDevice(
+        dev_ctx, std::bind(functor, std::placeholders::_1, x, out));
   }
 };
 
@@ -1653,8 +1655,7 @@ class PowGradKernel
     auto out = framework::EigenVector<T>::Flatten(detail::Ref(Out));
     auto dx = framework::EigenVector<T>::Flatten(detail::Ref(dX));
     auto x = framework::EigenVector<T>::Flatten(detail::Ref(X));
-    auto* place =
-        context.template device_context<DeviceContext>().eigen_device();
+    auto& dev_ctx = context.template device_context<DeviceContext>();
     Functor functor;
     auto attrs = functor.GetAttrs();
     for (auto& attr : attrs) {
@@ -1681,7 +1682,9 @@ class PowGradKernel
         *attr.second = factor[0];
       }
     }
-    functor(*place, x, out, dout, dx);
+    platform::VisitEigenDevice(
+        dev_ctx,
+        std::bind(functor, std::placeholders::_1, x, out, dout, dx));
   }
 };
 }  // namespace operators
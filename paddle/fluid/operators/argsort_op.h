@@ -13,10 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
-#include <algorithm>
-#include <utility>
-#include <vector>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/radix_sort.h"
 
 namespace paddle {
 namespace operators {
@@ -43,36 +41,25 @@ class ArgsortKernel : public framework::OpKernel<T> {
                          : framework::product(framework::slice_ddim(
                                in_dims, axis + 1, in_dims.size()));
 
-    for (int64_t i = 0; i < groups; ++i) {
-      int64_t idx = i;
-      std::vector<int64_t> shape_vec(in_dims.size(), 0);
-      for (int64_t dim = in_dims.size() - 1; dim >= 0; --dim) {
-        if (dim != axis) {
-          shape_vec[dim] = idx % in_dims[dim];
-          idx /= in_dims[dim];
-        }
-      }
-
-      int64_t start_index = shape_vec[0];
-      for (int64_t dim = 0; dim < in_dims.size() - 1; ++dim) {
-        start_index = start_index * in_dims[dim + 1] + shape_vec[dim + 1];
-      }
-
-      std::vector<int64_t> org_index_vec(in_dims[axis], start_index);
-      for (int64_t j = 1; j < in_dims[axis]; ++j) {
-        org_index_vec[j] += j * stride;
-      }
-
-      std::sort(org_index_vec.begin(), org_index_vec.end(),
-                [in_data](const int64_t v1, const int64_t v2) {
-                  return in_data[v1] < in_data[v2];
-                });
-
-      for (size_t j = 0; j < org_index_vec.size(); ++j) {
-        int64_t index = start_index + j * stride;
-        out_data[index] = in_data[org_index_vec[j]];
-        ids_data[index] = (org_index_vec[j] - start_index) / stride;
+    // Group i is the sorted axis at (outer, inner) = (i / stride, i % stride).
+    const int64_t axis_dim = in_dims[axis];
+    auto sort = [&](Eigen::Index first, Eigen::Index last) {
+      for (Eigen::Index i = first; i < last; ++i) {
+        int64_t start_index = i / stride * axis_dim * stride + i % stride;
+        math::RadixArgsort<T>(in_data + start_index, axis_dim, stride,
+                              out_data + start_index, ids_data + start_index);
       }
+    };
+    auto& dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
+    auto* pool_device = dev_ctx.eigen_pool_device();
+    if (pool_device != nullptr && groups > 1) {
+      pool_device->parallelFor(
+          groups,
+          Eigen::TensorOpCost(axis_dim * sizeof(T), axis_dim * sizeof(T),
+                              axis_dim * 8),
+          sort);
+    } else {
+      sort(0, groups);
     }
   }
 };
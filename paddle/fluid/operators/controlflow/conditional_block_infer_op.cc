@@ -59,7 +59,12 @@ class ConditionalBlockInferOp : public ConditionalOp {
 
       framework::Executor exec(dev_place);
       auto *block = Attr<framework::BlockDesc *>("sub_block");
-      exec.Run(*block->Program(), &cur_scope, block->ID(), false);
+      {
+        platform::RecordBlock record_block(block->ID());
+        auto ctx = prepared_ctx_cache_.Acquire(&exec, *block->Program(),
+                                               block->ID());
+        exec.RunPreparedContext(ctx.get(), &cur_scope, false);
+      }
       scope.DeleteScope(scopes->front());
     }
   }
@@ -63,8 +63,10 @@ class ConditionalBlockOp : public ConditionalOp {
       auto *block = Attr<framework::BlockDesc *>("sub_block");
       auto &skip_vars =
           Attr<std::vector<std::string>>(ConditionalOp::kSkipEagerDeletionVars);
-      exec.Run(*block->Program(), &cur_scope, block->ID(), false, true,
-               skip_vars);
+      platform::RecordBlock record_block(block->ID());
+      auto ctx = prepared_ctx_cache_.Acquire(&exec, *block->Program(),
+                                             block->ID(), skip_vars);
+      exec.RunPreparedContext(ctx.get(), &cur_scope, false, true);
     }
   }
 };
@@ -116,8 +118,12 @@ class ConditionalBlockGradOp : public ConditionalOp {
         ins_conds_grads.emplace_back(framework::GradVarName(cond));
       }
 
-      exec.Run(*block->Program(), &cur_scope, block->ID(), false, true,
-               ins_conds_grads);
+      {
+        platform::RecordBlock record_block(block->ID());
+        auto ctx = prepared_ctx_cache_.Acquire(&exec, *block->Program(),
+                                               block->ID(), ins_conds_grads);
+        exec.RunPreparedContext(ctx.get(), &cur_scope, false, true);
+      }
 
       AssignLocalGradientToGlobal(dev_place, cur_scope, ins_conds_grads.data(),
                                   ins.size(), d_ins);
@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/var_type.h"
+#include "paddle/fluid/platform/profiler.h"
 
 namespace paddle {
 namespace operators {
@@ -79,6 +80,9 @@ class ConditionalOp : public framework::OperatorBase {
     }
     return res;
   }
+
+  // The sub-block is prepared once and reused by the following runs.
+  mutable framework::ExecutorPrepareContextCache prepared_ctx_cache_;
 };
 
 class ConditionalBlockOpProtoMaker : public framework::OpProtoAndCheckerMaker {
@@ -17,6 +17,7 @@
 #include "paddle/fluid/framework/lod_tensor_array.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/scope_pool.h"
 #include "paddle/fluid/framework/var_type.h"
 #include "paddle/fluid/operators/controlflow/while_op_helper.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
@@ -70,16 +71,19 @@ class WhileOp : public framework::OperatorBase {
     auto &skip_vars = Attr<std::vector<std::string>>(kSkipEagerDeletionVars);
     VLOG(2) << GetSkipEagerDeletionVarsDebugString(skip_vars);
 
-    auto ctx = executor.Prepare(*program, block->ID(), skip_vars);
+    auto ctx = prepared_ctx_cache_.Acquire(&executor, *program, block->ID(),
+                                           skip_vars);
+    auto scope_pool = framework::StepScopePool::Instance().Get(
+        framework::StepScopePool::Key(program->Id(), Output(kStepScopes)));
     if (!is_test) {
       while (cond.data<bool>()[0]) {
-        auto &current_scope = scope.NewScope();
+        auto &current_scope = scope_pool->NewScope(scope);
         step_scopes->push_back(&current_scope);
         executor.RunPreparedContext(ctx.get(), &current_scope, false, true,
                                     true);
       }
     } else {
-      auto &current_scope = scope.NewScope();
+      auto &current_scope = scope_pool->NewScope(scope);
       executor.CreateVariables(*program, &current_scope, block->ID());
       while (cond.data<bool>()[0]) {
         for (auto &name : current_scope.LocalVarNames()) {
@@ -98,9 +102,12 @@ class WhileOp : public framework::OperatorBase {
         executor.RunPreparedContext(ctx.get(), &current_scope, false, false,
                                     false);
       }
-      scope.DeleteScope(&current_scope);
+      scope_pool->DeleteScope(scope, &current_scope);
     }
   }
+
+  // The step block is prepared once and reused by the following runs.
+  mutable framework::ExecutorPrepareContextCache prepared_ctx_cache_;
 };
 
 class WhileOpMaker : public framework::OpProtoAndCheckerMaker {
@@ -158,10 +165,13 @@ class WhileGradOp : public framework::OperatorBase {
 
     auto &skip_vars = Attr<std::vector<std::string>>(kSkipEagerDeletionVars);
     VLOG(2) << GetSkipEagerDeletionVarsDebugString(skip_vars);
-    auto ctx = executor.Prepare(*program, block->ID(), skip_vars);
+    auto ctx = prepared_ctx_cache_.Acquire(&executor, *program, block->ID(),
+                                           skip_vars);
 
     auto *step_scopes =
         scope.FindVar(Input(kStepScopes))->GetMutable<StepScopeVar>();
+    auto scope_pool = framework::StepScopePool::Instance().Get(
+        framework::StepScopePool::Key(program->Id(), Input(kStepScopes)));
 
     auto outside_og_names = Inputs(framework::GradVarName(kOutputs));
     auto inside_og_names =
@@ -303,10 +313,12 @@ class WhileGradOp : public framework::OperatorBase {
         cur_scope.Rename(new_inside_name, inside_grad_name);
       }
       dev_ctx.Wait();
-      const_cast<framework::Scope &>(scope).DeleteScope(&cur_scope);
+      scope_pool->DeleteScope(scope, &cur_scope);
     }
     step_scopes->clear();
   }
+
+  mutable framework::ExecutorPrepareContextCache prepared_ctx_cache_;
 };
 
 class WhileGradOpDescMaker : public framework::SingleGradOpDescMaker {
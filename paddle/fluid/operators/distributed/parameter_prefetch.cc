@@ -22,6 +22,7 @@
 
 #include "paddle/fluid/operators/distributed/parameter_prefetch.h"
 
+#include "gflags/gflags.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/fluid/framework/selected_rows.h"
@@ -31,6 +32,12 @@
 #include "paddle/fluid/operators/distributed/rpc_client.h"
 #include "paddle/fluid/operators/distributed/variable_response.h"
 #include "paddle/fluid/operators/distributed_ops/send_recv_util.h"
+#include "paddle/fluid/platform/device_tracer.h"
+
+DEFINE_bool(prefetch_next_batch, false,
+            "Prefetch the rows of distributed lookup tables for the ids of "
+            "the next batch while the current one is trained, the rows may "
+            "be one step stale.");
 
 namespace paddle {
 namespace operators {
@@ -80,28 +87,38 @@ static void SplitIdsIntoMultipleVarsBySection(
   }
 }
 
-typedef std::vector<std::pair<std::string, std::string>> TableAndEndpoints;
-
-void prefetch_core(
-    const std::vector<int64_t>& ids, const TableAndEndpoints& tables,
-    const std::vector<int64_t>& height_sections,
-    const framework::ExecutionContext& context, const framework::Scope& scope,
-    std::unordered_map<int64_t, std::vector<float>>* recved_vec_map) {
-  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
-  auto& actual_ctx = *pool.Get(context.GetPlace());
-
-  std::unique_ptr<framework::Scope> local_scope = scope.NewTmpScope();
+struct PrefetchRequest {
+  PrefetchConfig config;
+  std::unique_ptr<framework::Scope> scope;
+  std::vector<std::vector<int64_t>> splited_ids;
+  std::vector<std::string> out_var_names;
+  std::vector<distributed::VarHandlePtr> rets;
+  // The data of the ids tensors it was issued for.
+  std::vector<const void*> ids_data;
+  // The number of steps of the lookup, and the time, when it was issued.
+  int64_t step{0};
+  uint64_t start_ns{0};
+};
+
+static std::unique_ptr<PrefetchRequest> StartPrefetch(
+    const std::vector<int64_t>& ids, const PrefetchConfig& config,
+    const platform::DeviceContext& actual_ctx) {
+  std::unique_ptr<PrefetchRequest> request(new PrefetchRequest);
+  request->config = config;
+  request->scope.reset(new framework::Scope());
+  request->start_ns = platform::PosixInNsec();
+  auto* local_scope = request->scope.get();
 
   std::vector<std::string> in_var_names;
-  std::vector<std::string> out_var_names;
-  for (size_t i = 0; i < tables.size(); ++i) {
-    in_var_names.push_back("prefetch_send@" + tables[i].second);
-    out_var_names.push_back("prefetch_recv@" + tables[i].second);
+  for (auto& endpoint : config.endpoints) {
+    in_var_names.push_back("prefetch_send@" + endpoint);
+    request->out_var_names.push_back("prefetch_recv@" + endpoint);
   }
+  auto& out_var_names = request->out_var_names;
 
-  auto splited_ids = SplitIds(ids, height_sections);
-  SplitIdsIntoMultipleVarsBySection(in_var_names, height_sections, splited_ids,
-                                    local_scope.get());
+  request->splited_ids = SplitIds(ids, config.height_sections);
+  SplitIdsIntoMultipleVarsBySection(in_var_names, config.height_sections,
+                                    request->splited_ids, local_scope);
 
   // create output var in local scope
   for (auto& name : out_var_names) {
@@ -109,34 +126,46 @@ void prefetch_core(
   }
 
   distributed::RPCClient* rpc_client =
-      distributed::RPCClient::GetInstance<RPCCLIENT_T>(
-          context.Attr<int>("trainer_id"));
+      distributed::RPCClient::GetInstance<RPCCLIENT_T>(config.trainer_id);
 
-  std::vector<distributed::VarHandlePtr> rets;
   for (size_t i = 0; i < in_var_names.size(); i++) {
-    if (NeedSend(*local_scope.get(), in_var_names[i])) {
-      VLOG(3) << "sending " << in_var_names[i] << " to " << tables[i].second
-              << " to get " << out_var_names[i] << " back";
-      rets.push_back(rpc_client->AsyncPrefetchVar(
-          tables[i].second, actual_ctx, *local_scope.get(), in_var_names[i],
-          out_var_names[i], tables[i].first));
+    if (NeedSend(*local_scope, in_var_names[i])) {
+      VLOG(3) << "sending " << in_var_names[i] << " to "
+              << config.endpoints[i] << " to get " << out_var_names[i]
+              << " back";
+      request->rets.push_back(rpc_client->AsyncPrefetchVar(
+          config.endpoints[i], actual_ctx, *local_scope, in_var_names[i],
+          out_var_names[i], config.table_names[i]));
     } else {
       VLOG(3) << "don't send no-initialied variable: " << out_var_names[i];
     }
   }
+  return request;
+}
 
-  for (size_t i = 0; i < rets.size(); i++) {
-    PADDLE_ENFORCE(rets[i]->Wait(), "internal error in RPCClient");
+// The variables of a request are written by the RPC client until it is done,
+// so it is waited for even when its rows are not needed any more.
+static void WaitPrefetch(PrefetchRequest* request) {
+  for (size_t i = 0; i < request->rets.size(); i++) {
+    PADDLE_ENFORCE(request->rets[i]->Wait(), "internal error in RPCClient");
   }
+}
 
+static void FinishPrefetch(
+    PrefetchRequest* request,
+    std::unordered_map<int64_t, std::vector<float>>* recved_vec_map) {
+  WaitPrefetch(request);
+
+  auto& out_var_names = request->out_var_names;
+  auto& height_sections = request->config.height_sections;
   PADDLE_ENFORCE_EQ(out_var_names.size(), height_sections.size(), "");
 
   auto abs_sections = ToAbsoluteSection(height_sections);
   for (size_t section_idx = 0; section_idx < out_var_names.size();
        ++section_idx) {
-    auto& ids_in_this_section = splited_ids[section_idx];
+    auto& ids_in_this_section = request->splited_ids[section_idx];
     if (!ids_in_this_section.empty()) {
-      auto& prefetch_out_var = local_scope->Var(out_var_names[section_idx])
+      auto& prefetch_out_var = request->scope->Var(out_var_names[section_idx])
                                    ->Get<framework::LoDTensor>();
       const auto* out_var_data = prefetch_out_var.data<float>();
       auto& dims = prefetch_out_var.dims();
@@ -159,6 +188,217 @@ void prefetch_core(
   }
 }
 
+void prefetch_core(
+    const std::vector<int64_t>& ids, const PrefetchConfig& config,
+    const framework::ExecutionContext& context,
+    std::unordered_map<int64_t, std::vector<float>>* recved_vec_map) {
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  auto& actual_ctx = *pool.Get(context.GetPlace());
+  auto request = StartPrefetch(ids, config, actual_ctx);
+  FinishPrefetch(request.get(), recved_vec_map);
+}
+
+PrefetchPipeline& PrefetchPipeline::Instance() {
+  static PrefetchPipeline* pipeline = new PrefetchPipeline();
+  return *pipeline;
+}
+
+bool PrefetchPipeline::IsEnabled() { return FLAGS_prefetch_next_batch; }
+
+// The ring of batches of the reader reuses the tensors, so a batch is
+// identified by where its ids are, which the feed variables share.
+static std::vector<const void*> IdsData(
+    const std::vector<const framework::LoDTensor*>& ids) {
+  std::vector<const void*> ids_data;
+  for (auto* tensor : ids) {
+    ids_data.push_back(tensor->IsInitialized() ? tensor->data<void>()
+                                               : nullptr);
+  }
+  return ids_data;
+}
+
+PrefetchPipeline::~PrefetchPipeline() {}
+
+void PrefetchPipeline::PrefetchNextBatch(
+    const std::vector<const framework::LoDTensor*>& feed_vars,
+    const std::vector<const framework::LoDTensor*>& ids) {
+  PADDLE_ENFORCE_EQ(feed_vars.size(), ids.size(), "");
+  std::unordered_map<const framework::LoDTensor*, const framework::LoDTensor*>
+      next_ids;
+  for (size_t i = 0; i < feed_vars.size(); ++i) {
+    next_ids[feed_vars[i]] = ids[i];
+  }
+
+  // Only the lookups reading nothing but feed variables can be prefetched.
+  struct ToPrefetch {
+    std::vector<const framework::LoDTensor*> id_vars;
+    PrefetchConfig config;
+    std::vector<int64_t> ids_union;
+    std::vector<const framework::LoDTensor*> ids;
+  };
+  std::vector<ToPrefetch> to_prefetch;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& item : lookups_) {
+      ToPrefetch lookup_ids;
+      bool all_fed = true;
+      for (auto* var : item.first) {
+        auto it = next_ids.find(var);
+        if (it == next_ids.end()) {
+          all_fed = false;
+          break;
+        }
+        auto* id_data = it->second->data<int64_t>();
+        lookup_ids.ids_union.insert(lookup_ids.ids_union.end(), id_data,
+                                    id_data + it->second->numel());
+        lookup_ids.ids.push_back(it->second);
+      }
+      if (all_fed) {
+        lookup_ids.id_vars = item.first;
+        lookup_ids.config = item.second.config;
+        to_prefetch.push_back(std::move(lookup_ids));
+      }
+    }
+  }
+
+  auto& actual_ctx =
+      *platform::DeviceContextPool::Instance().Get(platform::CPUPlace());
+  std::vector<std::unique_ptr<PrefetchRequest>> dropped;
+  for (auto& item : to_prefetch) {
+    auto request = StartPrefetch(item.ids_union, item.config, actual_ctx);
+    request->ids_data = IdsData(item.ids);
+    std::lock_guard<std::mutex> guard(mutex_);
+    // The lookup may be unregistered or reconfigured meanwhile.
+    auto it = lookups_.find(item.id_vars);
+    if (it == lookups_.end() || !(it->second.config == item.config)) {
+      dropped.push_back(std::move(request));
+      continue;
+    }
+    auto* lookup = &it->second;
+    request->step = lookup->num_steps;
+    // The batch being trained and the next one.
+    while (lookup->pending.size() >= 2) {
+      dropped.push_back(std::move(lookup->pending.front()));
+      lookup->pending.pop_front();
+    }
+    lookup->pending.push_back(std::move(request));
+  }
+  for (auto& request : dropped) {
+    WaitPrefetch(request.get());
+  }
+}
+
+void PrefetchPipeline::Fetch(
+    const std::vector<const framework::LoDTensor*>& id_vars,
+    const PrefetchConfig& config, const std::vector<int64_t>& ids,
+    std::unordered_map<int64_t, std::vector<float>>* recved_vec_map) {
+  std::unique_ptr<PrefetchRequest> request;
+  std::vector<std::unique_ptr<PrefetchRequest>> dropped;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto& lookup = lookups_[id_vars];
+    if (!(lookup.config == config)) {
+      lookup.config = config;
+      for (auto& pending : lookup.pending) {
+        dropped.push_back(std::move(pending));
+      }
+      lookup.pending.clear();
+    }
+    // The request of the batch held by id_vars, the ones issued before it
+    // are of batches not looked up. The requests of the next batches stay.
+    auto ids_data = IdsData(id_vars);
+    auto match = std::find_if(
+        lookup.pending.begin(), lookup.pending.end(),
+        [&ids_data](const std::unique_ptr<PrefetchRequest>& pending) {
+          return pending->ids_data == ids_data;
+        });
+    if (match != lookup.pending.end()) {
+      for (auto it = lookup.pending.begin(); it != match; ++it) {
+        dropped.push_back(std::move(*it));
+      }
+      if (lookup.num_steps - (*match)->step <= 1) {
+        request = std::move(*match);
+      } else {
+        dropped.push_back(std::move(*match));
+      }
+      lookup.pending.erase(lookup.pending.begin(), match + 1);
+    }
+    ++lookup.num_steps;
+  }
+  for (auto& stale : dropped) {
+    WaitPrefetch(stale.get());
+  }
+
+  uint64_t wait_start = platform::PosixInNsec();
+  uint64_t overlapped_ns = 0;
+  if (request != nullptr) {
+    overlapped_ns = wait_start - request->start_ns;
+    FinishPrefetch(request.get(), recved_vec_map);
+  }
+  std::vector<int64_t> missing_ids;
+  for (auto id : ids) {
+    if (recved_vec_map->find(id) == recved_vec_map->end()) {
+      missing_ids.push_back(id);
+    }
+  }
+  if (!missing_ids.empty()) {
+    auto& actual_ctx =
+        *platform::DeviceContextPool::Instance().Get(platform::CPUPlace());
+    auto on_demand = StartPrefetch(missing_ids, config, actual_ctx);
+    FinishPrefetch(on_demand.get(), recved_vec_map);
+  }
+  uint64_t exposed_ns = platform::PosixInNsec() - wait_start;
+
+  VLOG(1) << "prefetch pipeline step: "
+          << ids.size() - missing_ids.size() << " ids prefetched, "
+          << missing_ids.size() << " ids on demand, overlapped "
+          << overlapped_ns / 1000 << " us, exposed " << exposed_ns / 1000
+          << " us";
+  std::lock_guard<std::mutex> guard(mutex_);
+  ++stats_.num_steps;
+  stats_.num_prefetched_ids += ids.size() - missing_ids.size();
+  stats_.num_fetched_ids += missing_ids.size();
+  stats_.overlapped_ns += overlapped_ns;
+  stats_.exposed_ns += exposed_ns;
+}
+
+void PrefetchPipeline::Unregister(
+    const std::vector<const framework::LoDTensor*>& feed_vars) {
+  std::vector<std::unique_ptr<PrefetchRequest>> dropped;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto it = lookups_.begin(); it != lookups_.end();) {
+      bool reads_feed_var = std::any_of(
+          it->first.begin(), it->first.end(),
+          [&feed_vars](const framework::LoDTensor* var) {
+            return std::find(feed_vars.begin(), feed_vars.end(), var) !=
+                   feed_vars.end();
+          });
+      if (!reads_feed_var) {
+        ++it;
+        continue;
+      }
+      for (auto& pending : it->second.pending) {
+        dropped.push_back(std::move(pending));
+      }
+      it = lookups_.erase(it);
+    }
+  }
+  for (auto& request : dropped) {
+    WaitPrefetch(request.get());
+  }
+}
+
+PrefetchPipelineStats PrefetchPipeline::GetStats() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return stats_;
+}
+
+void PrefetchPipeline::ResetStats() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  stats_ = PrefetchPipelineStats();
+}
+
 void prefetch(const std::string& id_name, const std::string& out_name,
               const std::string& persistable_var_name, const bool backfill,
               const std::vector<std::string>& table_names,
@@ -197,10 +437,11 @@ void prefetchs(const std::vector<std::string>& id_var_names,
   std::vector<std::vector<int64_t>> ids_group;
   std::vector<int64_t> ids_union;
   std::vector<framework::LoD> ids_lods;
-  TableAndEndpoints tables;
+  std::vector<const framework::LoDTensor*> id_vars;
 
   for (auto& id_name : id_var_names) {
     auto& id_tensor = scope.FindVar(id_name)->Get<framework::LoDTensor>();
+    id_vars.push_back(&id_tensor);
     auto* id_data = id_tensor.data<int64_t>();
     std::vector<int64_t> ids;
 
@@ -215,13 +456,19 @@ void prefetchs(const std::vector<std::string>& id_var_names,
   std::unordered_set<int64_t> s(ids_union.begin(), ids_union.end());
   ids_union.assign(s.begin(), s.end());
 
-  for (int i = 0; i < table_names.size(); i++) {
-    tables.push_back(std::make_pair(table_names[i], endpoints[i]));
-  }
+  PrefetchConfig config;
+  config.table_names = table_names;
+  config.endpoints = endpoints;
+  config.height_sections = height_sections;
+  config.trainer_id = context.Attr<int>("trainer_id");
 
   std::unordered_map<int64_t, std::vector<float>> recved_vec_map;
-  prefetch_core(ids_union, tables, height_sections, context, scope,
-                &recved_vec_map);
+  if (PrefetchPipeline::IsEnabled()) {
+    PrefetchPipeline::Instance().Fetch(id_vars, config, ids_union,
+                                       &recved_vec_map);
+  } else {
+    prefetch_core(ids_union, config, context, &recved_vec_map);
+  }
 
   auto padding_idx = distributed::kNoPadding;
 
@@ -14,7 +14,13 @@
 
 #pragma once
 
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -43,6 +49,87 @@ void prefetch(const std::string& id_name, const std::string& out_name,
               const framework::ExecutionContext& context,
               const framework::Scope& scope);
 
+struct PrefetchRequest;
+
+// How the ids of a distributed lookup table are split and where their rows
+// live.
+struct PrefetchConfig {
+  std::vector<std::string> table_names;
+  std::vector<std::string> endpoints;
+  std::vector<int64_t> height_sections;
+  int trainer_id{0};
+
+  bool operator==(const PrefetchConfig& other) const {
+    return table_names == other.table_names && endpoints == other.endpoints &&
+           height_sections == other.height_sections &&
+           trainer_id == other.trainer_id;
+  }
+};
+
+struct PrefetchPipelineStats {
+  int64_t num_steps{0};
+  // The ids whose rows were prefetched with the previous step, and the ones
+  // requested on demand.
+  int64_t num_prefetched_ids{0};
+  int64_t num_fetched_ids{0};
+  // The time the prefetch requests were in flight while the trainer computed,
+  // and the time the trainer waited for rows.
+  int64_t overlapped_ns{0};
+  int64_t exposed_ns{0};
+};
+
+// With FLAGS_prefetch_next_batch, the reader announces the ids of a batch as
+// soon as it is assembled, which is while the previous batch is trained, and
+// the rows of the ids read by a distributed_lookup_table are requested at
+// once. The lookup of that batch then only waits for what is still in flight.
+// The rows may miss the update of the step during which they were requested,
+// a request older than that is dropped.
+//
+// The lookups are identified by the tensors of their ids variables, which
+// are the feed variables the reader writes. A lookup only takes the rows
+// requested for the tensors its ids variables share, as the feed variables
+// do on CPU, and drops the requests of the batches before.
+class PrefetchPipeline {
+ public:
+  static PrefetchPipeline& Instance();
+  static bool IsEnabled();
+
+  ~PrefetchPipeline();
+
+  // Called by the reader: feed_vars[i] is going to hold ids[i].
+  void PrefetchNextBatch(
+      const std::vector<const framework::LoDTensor*>& feed_vars,
+      const std::vector<const framework::LoDTensor*>& ids);
+
+  // Called by the lookup: fill recved_vec_map with the rows of ids, which
+  // are the ids held by id_vars now. The rows prefetched for them are taken,
+  // the others are requested and waited for.
+  void Fetch(const std::vector<const framework::LoDTensor*>& id_vars,
+             const PrefetchConfig& config, const std::vector<int64_t>& ids,
+             std::unordered_map<int64_t, std::vector<float>>* recved_vec_map);
+
+  // Called by the reader when its feed variables are released or assigned
+  // again: forget the lookups reading them, and their requests.
+  void Unregister(const std::vector<const framework::LoDTensor*>& feed_vars);
+
+  PrefetchPipelineStats GetStats();
+  void ResetStats();
+
+ private:
+  struct Lookup {
+    PrefetchConfig config;
+    // The number of Fetch calls, a request is tagged with it.
+    int64_t num_steps{0};
+    std::deque<std::unique_ptr<PrefetchRequest>> pending;
+  };
+
+  PrefetchPipeline() = default;
+
+  std::mutex mutex_;
+  std::map<std::vector<const framework::LoDTensor*>, Lookup> lookups_;
+  PrefetchPipelineStats stats_;
+};
+
 };  // namespace distributed
 };  // namespace operators
 };  // namespace paddle
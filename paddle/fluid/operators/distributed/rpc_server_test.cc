@@ -25,6 +25,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/operator.h"
 
 #include "paddle/fluid/operators/distributed/distributed.h"
+#include "paddle/fluid/operators/distributed/parameter_prefetch.h"
 #include "paddle/fluid/operators/distributed/request_handler_impl.h"
 #include "paddle/fluid/operators/distributed/rpc_client.h"
 #include "paddle/fluid/operators/distributed/rpc_server.h"
@@ -34,6 +35,9 @@ namespace platform = paddle::platform;
 namespace distributed = paddle::operators::distributed;
 
 USE_NO_KERNEL_OP(lookup_sparse_table);
+USE_OP(lookup_table);
+
+DECLARE_bool(prefetch_next_batch);
 
 std::unique_ptr<distributed::RPCServer> g_rpc_service;
 std::unique_ptr<distributed::RequestHandler> g_req_handler;
@@ -166,6 +170,147 @@ TEST(PREFETCH, CPU) {
   g_req_handler.reset(nullptr);
 }
 
+static void SetIds(framework::LoDTensor* tensor,
+                   const std::vector<int64_t>& ids) {
+  auto* data = tensor->mutable_data<int64_t>(
+      framework::make_ddim({static_cast<int64_t>(ids.size()), 1}),
+      platform::CPUPlace());
+  std::copy(ids.begin(), ids.end(), data);
+}
+
+static void CheckRows(
+    const std::unordered_map<int64_t, std::vector<float>>& rows,
+    const std::vector<int64_t>& ids) {
+  for (auto id : ids) {
+    auto it = rows.find(id);
+    ASSERT_NE(it, rows.end());
+    ASSERT_EQ(it->second.size(), 10UL);
+    for (auto value : it->second) {
+      EXPECT_EQ(value, static_cast<float>(id));
+    }
+  }
+}
+
+TEST(PREFETCH_PIPELINE, CPU) {
+  setenv("http_proxy", "", 1);
+  setenv("https_proxy", "", 1);
+  g_req_handler.reset(new distributed::RequestPrefetchHandler(true));
+  g_rpc_service.reset(new RPCSERVER_T("127.0.0.1:0", 1));
+
+  std::thread server_thread(StartServer, distributed::kRequestPrefetch);
+  g_rpc_service->WaitServerReady();
+
+  int port = g_rpc_service->GetSelectedPort();
+  std::string ep = paddle::string::Sprintf("127.0.0.1:%d", port);
+
+  FLAGS_prefetch_next_batch = true;
+  auto& pipeline = distributed::PrefetchPipeline::Instance();
+  pipeline.ResetStats();
+  {
+    distributed::PrefetchConfig config;
+    config.table_names = {"w"};
+    config.endpoints = {ep};
+    config.height_sections = {10};
+    // The feed variable of the ids, which shares the tensor of the batch.
+    framework::LoDTensor feed_var;
+    std::vector<const framework::LoDTensor*> id_vars{&feed_var};
+
+    // Nothing is prefetched before the lookup is known.
+    std::unordered_map<int64_t, std::vector<float>> rows;
+    pipeline.Fetch(id_vars, config, {1, 3}, &rows);
+    CheckRows(rows, {1, 3});
+
+    framework::LoDTensor next_ids;
+    SetIds(&next_ids, {2, 4, 6});
+    pipeline.PrefetchNextBatch({&feed_var}, {&next_ids});
+    feed_var.ShareDataWith(next_ids);
+    rows.clear();
+    // 8 was not announced, it is requested on demand.
+    pipeline.Fetch(id_vars, config, {2, 4, 6, 8}, &rows);
+    CheckRows(rows, {2, 4, 6, 8});
+
+    auto stats = pipeline.GetStats();
+    EXPECT_EQ(stats.num_steps, 2);
+    EXPECT_EQ(stats.num_prefetched_ids, 3);
+    EXPECT_EQ(stats.num_fetched_ids, 3);
+    EXPECT_GT(stats.overlapped_ns, 0);
+    EXPECT_GT(stats.exposed_ns, 0);
+    pipeline.Unregister({&feed_var});
+  }
+  FLAGS_prefetch_next_batch = false;
+
+  g_rpc_service->ShutDown();
+  server_thread.join();
+  g_rpc_service.reset(nullptr);
+  g_req_handler.reset(nullptr);
+}
+
+TEST(PREFETCH_PIPELINE, DataFeedOrder) {
+  setenv("http_proxy", "", 1);
+  setenv("https_proxy", "", 1);
+  g_req_handler.reset(new distributed::RequestPrefetchHandler(true));
+  g_rpc_service.reset(new RPCSERVER_T("127.0.0.1:0", 1));
+
+  std::thread server_thread(StartServer, distributed::kRequestPrefetch);
+  g_rpc_service->WaitServerReady();
+
+  int port = g_rpc_service->GetSelectedPort();
+  std::string ep = paddle::string::Sprintf("127.0.0.1:%d", port);
+
+  FLAGS_prefetch_next_batch = true;
+  auto& pipeline = distributed::PrefetchPipeline::Instance();
+  pipeline.ResetStats();
+  {
+    distributed::PrefetchConfig config;
+    config.table_names = {"w"};
+    config.endpoints = {ep};
+    config.height_sections = {10};
+    framework::LoDTensor feed_var;
+    std::vector<const framework::LoDTensor*> id_vars{&feed_var};
+    // Like the reader, batch i is written into batches[i % 2], and batch
+    // i + 1 is announced when batch i is fed, before batch i is looked up.
+    framework::LoDTensor batches[2];
+    std::vector<std::vector<int64_t>> ids{
+        {0, 1}, {2, 3}, {4, 5}, {6, 7}, {8, 9}};
+    SetIds(&batches[0], ids[0]);
+    std::unordered_map<int64_t, std::vector<float>> rows;
+    for (size_t i = 0; i + 1 < ids.size(); ++i) {
+      feed_var.ShareDataWith(batches[i % 2]);
+      SetIds(&batches[(i + 1) % 2], ids[i + 1]);
+      pipeline.PrefetchNextBatch({&feed_var}, {&batches[(i + 1) % 2]});
+      rows.clear();
+      pipeline.Fetch(id_vars, config, ids[i], &rows);
+      CheckRows(rows, ids[i]);
+    }
+
+    // The lookup is only known after batch 0, so batches 0 and 1 are
+    // requested on demand. Batch 1 must not take the rows of batch 2.
+    auto stats = pipeline.GetStats();
+    EXPECT_EQ(stats.num_steps, 4);
+    EXPECT_EQ(stats.num_prefetched_ids, 4);
+    EXPECT_EQ(stats.num_fetched_ids, 4);
+
+    // Nothing is prefetched for an unregistered lookup.
+    pipeline.Unregister({&feed_var});
+    SetIds(&batches[0], ids[4]);
+    pipeline.PrefetchNextBatch({&feed_var}, {&batches[0]});
+    feed_var.ShareDataWith(batches[0]);
+    rows.clear();
+    pipeline.Fetch(id_vars, config, ids[4], &rows);
+    CheckRows(rows, ids[4]);
+    stats = pipeline.GetStats();
+    EXPECT_EQ(stats.num_prefetched_ids, 4);
+    EXPECT_EQ(stats.num_fetched_ids, 6);
+    pipeline.Unregister({&feed_var});
+  }
+  FLAGS_prefetch_next_batch = false;
+
+  g_rpc_service->ShutDown();
+  server_thread.join();
+  g_rpc_service.reset(nullptr);
+  g_req_handler.reset(nullptr);
+}
+
 TEST(COMPLETE, CPU) {
   setenv("http_proxy", "", 1);
   setenv("https_proxy", "", 1);
@@ -18,6 +18,7 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/fc.h"
+#include "paddle/fluid/operators/math/packed_weight_cache.h"
 
 namespace paddle {
 namespace operators {
@@ -80,7 +81,8 @@ class FCOpKernel : public framework::OpKernel<T> {
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
     math::FCFunctor<DeviceContext, T> fc;
     fc(dev_ctx, M, w_dims[1], w_dims[0], input_data, w_data, output_data,
-       bias ? bias->data<T>() : NULL, with_relu);
+       bias ? bias->data<T>() : NULL, with_relu,
+       math::GetPackedWeight<T>(dev_ctx, *w, w_dims[1], w_dims[0]));
   }
 };
 
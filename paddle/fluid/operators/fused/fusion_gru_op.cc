@@ -18,6 +18,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/fc.h"
+#include "paddle/fluid/operators/math/packed_weight_cache.h"
 #include "paddle/fluid/operators/math/sequence2batch.h"
 
 namespace paddle {
@@ -221,9 +222,15 @@ class FusionGRUKernel : public framework::OpKernel<T> {
     auto blas = math::GetBlas<DeviceContext, T>(ctx);
 
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    auto& packed_cache = math::PackedWeightCache::Instance();
+    const T* packed_wx_data = math::GetPackedWeight<T>(dev_ctx, *wx, D3, M);
+    const T* packed_wh_data =
+        packed_cache.Get<T>(dev_ctx, *wh, wh_data, D2, D, D2);
+    const T* packed_wh_state_data =
+        packed_cache.Get<T>(dev_ctx, *wh, wh_state_data, D, D, D);
     math::FCFunctor<DeviceContext, T> fc;
     fc(dev_ctx, total_T, D3, M, x_data, wx_data, xx_data,
-       bias ? bias->data<T>() : nullptr);
+       bias ? bias->data<T>() : nullptr, false, packed_wx_data);
 
     int xx_offset = D3;
     int gate_offset = D;
@@ -255,17 +262,28 @@ class FusionGRUKernel : public framework::OpKernel<T> {
       }
       for (int step = tstart; step < seq_len; ++step) {
         // gemm prev * (Wu + Wr)
-        blas.GEMM(CblasNoTrans, CblasNoTrans, 1, D2, D, static_cast<T>(1),
-                  prev_hidden_data, D, wh_data, D2, static_cast<T>(1), xx_data,
-                  D3);
+        if (packed_wh_data) {
+          math::PackedGEMM<T>(dev_ctx, 1, D2, D, prev_hidden_data, D,
+                              packed_wh_data, static_cast<T>(1), xx_data, D3);
+        } else {
+          blas.GEMM(CblasNoTrans, CblasNoTrans, 1, D2, D, static_cast<T>(1),
+                    prev_hidden_data, D, wh_data, D2, static_cast<T>(1),
+                    xx_data, D3);
+        }
         one_step.gates = xx_data;
         one_step.ht_1 = prev_hidden_data;
         one_step.ht = hidden_out_data;
         ComputeHtPart1(&one_step, &attr);
         // gemm rt * Ws
-        blas.GEMM(CblasNoTrans, CblasNoTrans, 1, D, D, static_cast<T>(1),
-                  hidden_out_data, D, wh_state_data, D, static_cast<T>(1),
-                  xx_data + D2, D3);
+        if (packed_wh_state_data) {
+          math::PackedGEMM<T>(dev_ctx, 1, D, D, hidden_out_data, D,
+                              packed_wh_state_data, static_cast<T>(1),
+                              xx_data + D2, D3);
+        } else {
+          blas.GEMM(CblasNoTrans, CblasNoTrans, 1, D, D, static_cast<T>(1),
+                    hidden_out_data, D, wh_state_data, D, static_cast<T>(1),
+                    xx_data + D2, D3);
+        }
         ComputeHtPart2(&one_step, &attr);
         // save prev
         prev_hidden_data = hidden_out_data;
@@ -293,16 +311,17 @@ class FusionGRUKernel : public framework::OpKernel<T> {
     auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
     math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
 
+    const T* packed_wx_data = math::GetPackedWeight<T>(dev_ctx, *wx, D3, M);
     math::FCFunctor<DeviceContext, T> fc;
     if (M > D3) {
       fc(dev_ctx, total_T, D3, M, x_data, wx_data, xx_data,
-         bias ? bias->data<T>() : nullptr);
+         bias ? bias->data<T>() : nullptr, false, packed_wx_data);
       to_batch(dev_ctx, *xx, batched_input, true, is_reverse);
     } else {
       to_batch(dev_ctx, *x, xx, true, is_reverse);
       batched_input->set_lod(xx->lod());
       fc(dev_ctx, total_T, D3, M, xx_data, wx_data, batched_input_data,
-         bias ? bias->data<T>() : nullptr);
+         bias ? bias->data<T>() : nullptr, false, packed_wx_data);
     }
 
     auto batched_lod = batched_input->lod();
@@ -340,6 +359,11 @@ class FusionGRUKernel : public framework::OpKernel<T> {
     }
     // Then start from next
     const T* wh_state_data = wh_data + D * D2;
+    auto& packed_cache = math::PackedWeightCache::Instance();
+    const T* packed_wh_data =
+        packed_cache.Get<T>(dev_ctx, *wh, wh_data, D2, D, D2);
+    const T* packed_wh_state_data =
+        packed_cache.Get<T>(dev_ctx, *wh, wh_state_data, D, D, D);
     const auto& batch_starts = batched_lod[0];
     const int max_seq_len = batch_starts.size() - 1;
     batched_input_data = batched_input_data + tstart * max_bs * D3;
@@ -347,9 +371,15 @@ class FusionGRUKernel : public framework::OpKernel<T> {
     for (int step = tstart; step < max_seq_len; ++step) {
       const int cur_bs = batch_starts[step + 1] - batch_starts[step];
       // gemm prev * (Wu + Wr)
-      blas.GEMM(CblasNoTrans, CblasNoTrans, cur_bs, D2, D, static_cast<T>(1),
-                prev_hidden_data, D, wh_data, D2, static_cast<T>(1),
-                batched_input_data, D3);
+      if (packed_wh_data) {
+        math::PackedGEMM<T>(dev_ctx, cur_bs, D2, D, prev_hidden_data, D,
+                            packed_wh_data, static_cast<T>(1),
+                            batched_input_data, D3);
+      } else {
+        blas.GEMM(CblasNoTrans, CblasNoTrans, cur_bs, D2, D, static_cast<T>(1),
+                  prev_hidden_data, D, wh_data, D2, static_cast<T>(1),
+                  batched_input_data, D3);
+      }
 
       T* cur_batched_data = batched_input_data;
       T* cur_out_data = batched_out_data;
@@ -367,9 +397,15 @@ class FusionGRUKernel : public framework::OpKernel<T> {
 
       cur_batched_data = batched_input_data;
       cur_out_data = batched_out_data;
-      blas.GEMM(CblasNoTrans, CblasNoTrans, cur_bs, D, D, static_cast<T>(1),
-                cur_out_data, D, wh_state_data, D, static_cast<T>(1),
-                cur_batched_data + D2, D3);
+      if (packed_wh_state_data) {
+        math::PackedGEMM<T>(dev_ctx, cur_bs, D, D, cur_out_data, D,
+                            packed_wh_state_data, static_cast<T>(1),
+                            cur_batched_data + D2, D3);
+      } else {
+        blas.GEMM(CblasNoTrans, CblasNoTrans, cur_bs, D, D, static_cast<T>(1),
+                  cur_out_data, D, wh_state_data, D, static_cast<T>(1),
+                  cur_batched_data + D2, D3);
+      }
 
       cur_prev_hidden_data = prev_hidden_data;
       for (int i = 0; i < cur_bs; ++i) {
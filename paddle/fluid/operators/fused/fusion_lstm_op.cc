@@ -17,6 +17,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/fc.h"
+#include "paddle/fluid/operators/math/packed_weight_cache.h"
 #include "paddle/fluid/operators/math/sequence2batch.h"
 
 namespace paddle {
@@ -264,10 +265,15 @@ class FuisonLSTMKernel : public framework::OpKernel<T> {
       jit::KernelFuncs<jit::LSTMCtHtTuple<T>, platform::CPUPlace>::Cache().At( \
           attr)
 
-// Wh GEMM
+// Wh GEMM, with the packed Wh if it is available
 #define GEMM_WH_ADDON(bs, prev, out)                                           \
-  blas.GEMM(CblasNoTrans, CblasNoTrans, bs, D4, D, static_cast<T>(1), prev, D, \
-            wh_data, D4, static_cast<T>(1), out, D4)
+  if (packed_wh_data) {                                                        \
+    math::PackedGEMM<T>(dev_ctx, bs, D4, D, prev, D, packed_wh_data,           \
+                        static_cast<T>(1), out, D4);                           \
+  } else {                                                                     \
+    blas.GEMM(CblasNoTrans, CblasNoTrans, bs, D4, D, static_cast<T>(1), prev,  \
+              D, wh_data, D4, static_cast<T>(1), out, D4);                     \
+  }
 
   void SeqCompute(const framework::ExecutionContext& ctx) const {
     INIT_BASE_DEFINES;
@@ -283,8 +289,11 @@ class FuisonLSTMKernel : public framework::OpKernel<T> {
     auto blas = math::GetBlas<DeviceContext, T>(ctx);
 
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    const T* packed_wx_data = math::GetPackedWeight<T>(dev_ctx, *wx, D4, M);
+    const T* packed_wh_data = math::GetPackedWeight<T>(dev_ctx, *wh, D4, D);
     math::FCFunctor<DeviceContext, T> fc;
-    fc(dev_ctx, total_T, D4, M, x_data, wx_data, xx_data, bias->data<T>());
+    fc(dev_ctx, total_T, D4, M, x_data, wx_data, xx_data, bias->data<T>(),
+       false, packed_wx_data);
 
     int xx_offset = D4;
     int gate_offset = D;
@@ -361,15 +370,18 @@ class FuisonLSTMKernel : public framework::OpKernel<T> {
     math::LoDTensor2BatchFunctor<DeviceContext, T> to_batch;
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
     auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
+    const T* packed_wx_data = math::GetPackedWeight<T>(dev_ctx, *wx, D4, M);
+    const T* packed_wh_data = math::GetPackedWeight<T>(dev_ctx, *wh, D4, D);
     math::FCFunctor<DeviceContext, T> fc;
     if (M > D4) {
-      fc(dev_ctx, x_dims[0], D4, M, x_data, wx_data, xx_data, bias->data<T>());
+      fc(dev_ctx, x_dims[0], D4, M, x_data, wx_data, xx_data, bias->data<T>(),
+         false, packed_wx_data);
       to_batch(dev_ctx, *xx, batched_input, true, is_reverse);
     } else {
       to_batch(dev_ctx, *x, xx, true, is_reverse);
       batched_input->set_lod(xx->lod());
       fc(dev_ctx, x_dims[0], D4, M, xx_data, wx_data, batched_input_data,
-         bias->data<T>());
+         bias->data<T>(), false, packed_wx_data);
     }
 
     auto batched_lod = batched_input->lod();
@@ -14,7 +14,9 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/beam_search.h"
 #include <algorithm>
-#include <map>
+#include <numeric>
+#include <string>
+#include <vector>
 
 namespace paddle {
 namespace operators {
@@ -35,24 +37,53 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
     auto abs_lod = framework::ToAbsOffset(scores->lod());
     auto &high_level = abs_lod[level];
 
-    auto items = SelectTopBeamSizeItems(pre_ids, pre_scores, ids, scores, level,
-                                        beam_size, end_id, is_accumulated);
-    auto selected_items = ToMap(items, high_level.back());
+    size_t num_seqs = scores->NumElements(level);
+    size_t seq_width = 1;
+    for (int i = 1; i < scores->dims().size(); i++) {
+      seq_width *= scores->dims()[i];
+    }
+
+    // The candidate buffer is reused across calls of the same thread, so the
+    // selection does not allocate once it has grown to the largest batch.
+    Workspace *workspace = GetWorkspace();
+    workspace->Reset(num_seqs, beam_size);
+
+    // Every source sentence selects its top beam_size items into its own slice
+    // of the workspace, so the sources are independent of each other.
+    auto select = [&](Eigen::Index first, Eigen::Index last) {
+      for (Eigen::Index seq_id = first; seq_id < last; ++seq_id) {
+        SelectTopBeamSizeItems(pre_ids, pre_scores, ids, scores, abs_lod[level],
+                               seq_id, seq_width, beam_size, end_id,
+                               is_accumulated, workspace);
+        PruneEndBeams(pre_ids, seq_id, beam_size, end_id, workspace);
+      }
+    };
+    auto *pool_device = context.eigen_pool_device();
+    if (pool_device != nullptr && num_seqs > 1) {
+      double num_candidates =
+          static_cast<double>(high_level.back()) * seq_width / num_seqs;
+      Eigen::TensorOpCost cost(num_candidates * sizeof(float), 0,
+                               num_candidates * (is_accumulated ? 2 : 20));
+      pool_device->parallelFor(static_cast<Eigen::Index>(num_seqs), cost,
+                               select);
+    } else {
+      select(0, static_cast<Eigen::Index>(num_seqs));
+    }
+
     if (FLAGS_v == 3) {
       VLOG(3) << "selected_items:";
-      for (size_t i = 0; i < selected_items.size(); ++i) {
-        VLOG(3) << "offset: " << i;
-        for (auto &item : selected_items[i]) {
-          VLOG(3) << item.ToString();
+      for (size_t seq_id = 0; seq_id < num_seqs; ++seq_id) {
+        VLOG(3) << "source: " << seq_id;
+        const Item *items = workspace->items.data() + seq_id * beam_size;
+        for (size_t i = 0; i < workspace->sizes[seq_id]; ++i) {
+          VLOG(3) << items[i].ToString();
         }
       }
     }
 
-    PruneEndBeams(pre_ids, abs_lod, &selected_items, level, end_id);
     // calculate the output tensor's height
-    size_t num_instances = std::accumulate(
-        std::begin(selected_items), std::end(selected_items), 0,
-        [](size_t a, std::vector<Item> &b) { return a + b.size(); });
+    size_t num_instances = std::accumulate(workspace->sizes.begin(),
+                                           workspace->sizes.end(), size_t(0));
     // the output tensor shape should be [num_instances, 1]
     auto dims = framework::make_ddim(
         std::vector<int64_t>({static_cast<int>(num_instances), 1}));
@@ -66,18 +97,27 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
                   {static_cast<int64_t>(num_instances)}, platform::CPUPlace())
             : nullptr;
 
-    // fill in data
+    // Fill in data, the low level lod and the parent index in a single pass.
+    // Items of a source are ordered by offset, so every prefix collects its
+    // items in one run.
     std::vector<size_t> low_level;
+    low_level.reserve(high_level.back() + 1);
     size_t low_offset = 0;
-    for (auto &items : selected_items) {
-      low_level.push_back(low_offset);
-      for (auto &item : items) {
-        if (parent_idx) {
-          parent_idx_data[low_offset] = static_cast<int>(low_level.size() - 1);
+    for (size_t seq_id = 0; seq_id < num_seqs; ++seq_id) {
+      const Item *items = workspace->items.data() + seq_id * beam_size;
+      const size_t num_items = workspace->sizes[seq_id];
+      size_t i = 0;
+      for (size_t offset = high_level[seq_id]; offset < high_level[seq_id + 1];
+           ++offset) {
+        low_level.push_back(low_offset);
+        for (; i < num_items && items[i].offset == offset; ++i) {
+          if (parent_idx) {
+            parent_idx_data[low_offset] = static_cast<int>(offset);
+          }
+          selected_ids_data[low_offset] = items[i].id;
+          selected_scores_data[low_offset] = items[i].score;
+          low_offset++;
         }
-        selected_ids_data[low_offset] = item.id;
-        selected_scores_data[low_offset] = item.score;
-        low_offset++;
       }
     }
     low_level.push_back(low_offset);
@@ -120,7 +160,7 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
       score = in.score;
     }
 
-    std::string ToString() {
+    std::string ToString() const {
       std::ostringstream os;
       os << "{";
       os << "offset: " << offset << ", ";
@@ -133,149 +173,125 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
 
  protected:
   /*
-   * Prune the source sentences all branchs finished, and it is optional.
-   * Pruning must one step later than finishing (thus pre_ids is needed here),
-   * since the end tokens must be writed out.
+   * The preallocated candidate buffer. The source seq_id owns the items in
+   * [seq_id * beam_size, seq_id * beam_size + sizes[seq_id]).
    */
-  void PruneEndBeams(const framework::LoDTensor *pre_ids,
-                     const framework::LoD &abs_lod,
-                     std::vector<std::vector<Item>> *items, size_t lod_level,
-                     int end_id) {
-    auto *pre_ids_data = pre_ids->data<int64_t>();
-    auto &high_level = abs_lod[lod_level];
-    for (size_t src_idx = 0; src_idx < high_level.size() - 1; ++src_idx) {
-      size_t src_prefix_start = high_level[src_idx];
-      size_t src_prefix_end = high_level[src_idx + 1];
-      bool finish_flag = true;
-      for (size_t offset = src_prefix_start; offset < src_prefix_end;
-           offset++) {
-        for (auto &item : items->at(offset)) {
-          if (item.id != static_cast<size_t>(end_id) ||
-              pre_ids_data[offset] != end_id) {
-            finish_flag = false;
-            break;
-          }
-        }
-        if (!finish_flag) break;
-      }
-      if (finish_flag) {  // all branchs of the beam (source sentence) end and
-                          // prune this beam
-        for (size_t offset = src_prefix_start; offset < src_prefix_end;
-             offset++)
-          items->at(offset).clear();
+  struct Workspace {
+    std::vector<Item> items;
+    std::vector<size_t> sizes;
+
+    void Reset(size_t num_seqs, size_t beam_size) {
+      if (items.size() < num_seqs * beam_size) {
+        items.resize(num_seqs * beam_size);
       }
+      sizes.assign(num_seqs, 0);
     }
+  };
+
+  static Workspace *GetWorkspace() {
+    static thread_local Workspace workspace;
+    return &workspace;
   }
 
+  // The comparator making the smallest item the top of the heap.
+  static bool GreaterItem(const Item &a, const Item &b) { return b < a; }
+
   /*
-   * Transform the items into a map whose key is offset, value is the items.
-   * NOTE low performance.
+   * Push the item into the fixed-capacity min-heap of a source. Once the heap
+   * is full, an item smaller than the top is rejected in O(1).
    */
-  std::vector<std::vector<Item>> ToMap(
-      const std::vector<std::vector<Item>> &items, size_t element_num) {
-    std::vector<std::vector<Item>> result;
-    result.resize(element_num);
-    for (auto &entries : items) {
-      for (const auto &item : entries) {
-        result[item.offset].push_back(item);
-      }
+  static void Insert(Item *heap, size_t *size, const Item &item,
+                     size_t beam_size) {
+    if (*size < beam_size) {
+      heap[(*size)++] = item;
+      std::push_heap(heap, heap + *size, GreaterItem);
+    } else if (!(item < heap[0])) {
+      std::pop_heap(heap, heap + beam_size, GreaterItem);
+      heap[beam_size - 1] = item;
+      std::push_heap(heap, heap + beam_size, GreaterItem);
     }
-    return result;
   }
 
-  void Insert(std::vector<Item> *top_beam_ptr, const Item &item,
-              size_t beam_size) {
-    std::vector<Item> &top_beam = *top_beam_ptr;
-
-    size_t num_beams = top_beam.size();
-    if (num_beams < beam_size) {
-      top_beam.resize(num_beams + 1);
-      num_beams++;
-    } else {
-      if (item < top_beam[beam_size - 1]) {
-        return;
-      }
-    }
-
-    for (int k = static_cast<int>(num_beams) - 2; k >= 0; --k) {
-      if (top_beam[k] < item) {
-        top_beam[k + 1] = top_beam[k];
-      } else {
-        top_beam[k + 1] = item;
+  /*
+   * Prune the source sentences all branchs finished, and it is optional.
+   * Pruning must one step later than finishing (thus pre_ids is needed here),
+   * since the end tokens must be writed out.
+   */
+  void PruneEndBeams(const framework::LoDTensor *pre_ids, size_t seq_id,
+                     size_t beam_size, int end_id, Workspace *workspace) {
+    auto *pre_ids_data = pre_ids->data<int64_t>();
+    const Item *items = workspace->items.data() + seq_id * beam_size;
+    size_t &num_items = workspace->sizes[seq_id];
+    for (size_t i = 0; i < num_items; ++i) {
+      if (items[i].id != static_cast<size_t>(end_id) ||
+          pre_ids_data[items[i].offset] != end_id) {
         return;
       }
     }
-    top_beam[0] = item;
+    // all branchs of the beam (source sentence) end and prune this beam
+    num_items = 0;
   }
 
   /*
-   * For each source, select top beam_size records.
+   * For the source seq_id, select top beam_size records, ordered by offset and
+   * then by descending score.
    */
-  std::vector<std::vector<Item>> SelectTopBeamSizeItems(
-      const framework::LoDTensor *pre_ids,
-      const framework::LoDTensor *pre_scores, const framework::LoDTensor *ids,
-      const framework::LoDTensor *scores, size_t lod_level, size_t beam_size,
-      int end_id, bool is_accumulated) {
-    std::vector<std::vector<Item>> result;
-
-    // find the current candidates
-    auto abs_lod = framework::ToAbsOffset(scores->lod());
-
+  void SelectTopBeamSizeItems(const framework::LoDTensor *pre_ids,
+                              const framework::LoDTensor *pre_scores,
+                              const framework::LoDTensor *ids,
+                              const framework::LoDTensor *scores,
+                              const std::vector<size_t> &seq_offsets,
+                              size_t seq_id, size_t seq_width,
+                              size_t beam_size, int end_id,
+                              bool is_accumulated, Workspace *workspace) {
     auto *pre_ids_data = pre_ids->data<int64_t>();
     auto *pre_scores_data = pre_scores->data<float>();
 
     auto *ids_data = ids ? ids->data<int64_t>() : nullptr;
     auto *scores_data = scores->data<float>();
 
-    size_t num_seqs = scores->NumElements(lod_level);
-    size_t seq_width = 1;
-    for (int i = 1; i < scores->dims().size(); i++) {
-      seq_width *= scores->dims()[i];
-    }
-
-    for (size_t seq_id = 0; seq_id < num_seqs; ++seq_id) {
-      size_t seq_offset_start = abs_lod[lod_level][seq_id];
-      size_t seq_offset_end = abs_lod[lod_level][seq_id + 1];
-
-      std::vector<Item> top_beam;
-      top_beam.reserve(beam_size);
-
-      for (size_t offset = seq_offset_start; offset < seq_offset_end;
-           ++offset) {
-        auto pre_id = pre_ids_data[offset];
-        auto pre_score = pre_scores_data[offset];
-        if (pre_id == end_id) {
-          // Allocate all probability mass to end_id for finished branchs and
-          // the other candidate ids can be ignored.
-          Item item(offset, end_id, pre_score);
-          Insert(&top_beam, item, beam_size);
-        } else {
-          size_t index = offset * seq_width;
-          for (size_t d = 0; d < seq_width; d++, index++) {
-            int64_t id = ids_data ? ids_data[index] : static_cast<int64_t>(d);
-            float score = is_accumulated
-                              ? scores_data[index]
-                              : pre_score + std::log(scores_data[index]);
-            Item item(offset, id, score);
-            Insert(&top_beam, item, beam_size);
+    Item *top_beam = workspace->items.data() + seq_id * beam_size;
+    size_t &num_beams = workspace->sizes[seq_id];
+
+    size_t seq_offset_start = seq_offsets[seq_id];
+    size_t seq_offset_end = seq_offsets[seq_id + 1];
+    for (size_t offset = seq_offset_start; offset < seq_offset_end; ++offset) {
+      auto pre_id = pre_ids_data[offset];
+      auto pre_score = pre_scores_data[offset];
+      if (pre_id == end_id) {
+        // Allocate all probability mass to end_id for finished branchs and
+        // the other candidate ids can be ignored.
+        Item item(offset, end_id, pre_score);
+        Insert(top_beam, &num_beams, item, beam_size);
+      } else {
+        size_t index = offset * seq_width;
+        for (size_t d = 0; d < seq_width; d++, index++) {
+          float score = is_accumulated
+                            ? scores_data[index]
+                            : pre_score + std::log(scores_data[index]);
+          // Most candidates are below the current threshold, skip them before
+          // building the item.
+          if (num_beams == beam_size && score < top_beam[0].score) {
+            continue;
           }
+          int64_t id = ids_data ? ids_data[index] : static_cast<int64_t>(d);
+          Item item(offset, id, score);
+          Insert(top_beam, &num_beams, item, beam_size);
         }
       }
-
-      result.emplace_back(top_beam);
     }
 
-    if (FLAGS_v == 3) {
-      VLOG(3) << "SelectTopBeamSizeItems result size " << result.size();
-      for (auto &items : result) {
-        VLOG(3) << "item set:";
-        for (auto &item : items) {
-          VLOG(3) << item.ToString();
-        }
+    // Sort the heap descending, then stably by offset, which is the order the
+    // items are written out.
+    std::sort_heap(top_beam, top_beam + num_beams, GreaterItem);
+    for (size_t i = 1; i < num_beams; ++i) {
+      Item item = top_beam[i];
+      size_t j = i;
+      for (; j > 0 && top_beam[j - 1].offset > item.offset; --j) {
+        top_beam[j] = top_beam[j - 1];
       }
+      top_beam[j] = item;
     }
-
-    return result;
   }
 };
 
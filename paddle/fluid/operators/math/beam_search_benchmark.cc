@@ -0,0 +1,123 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+#include "paddle/fluid/operators/math/beam_search.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/device_tracer.h"
+
+DEFINE_int32(burning, 3, "Burning times.");
+DEFINE_int32(repeat, 20, "Repeat times.");
+DEFINE_int32(num_seqs, 16, "The number of source sentences in a batch.");
+DEFINE_string(beam_sizes, "4,8,16,32,64", "The beam sizes would be tested.");
+DEFINE_string(vocab_sizes, "1000,10000,30000,100000",
+              "The vocabulary sizes would be tested.");
+DEFINE_int32(num_threads, 1, "The number of intra-op threads.");
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+static std::vector<int> ParseSizes(const std::string& str) {
+  std::vector<int> sizes;
+  std::istringstream is(str);
+  std::string item;
+  while (std::getline(is, item, ',')) {
+    sizes.push_back(std::stoi(item));
+  }
+  return sizes;
+}
+
+// Run one decoding step of beam_size prefixes for every source sentence, the
+// scores are accumulated so the whole vocabulary is scanned per prefix.
+static double BenchBeamSearch(const platform::CPUDeviceContext& context,
+                              int beam_size, int vocab_size) {
+  const int64_t num_offsets = static_cast<int64_t>(FLAGS_num_seqs) * beam_size;
+  std::vector<size_t> level0, level1;
+  for (int i = 0; i <= FLAGS_num_seqs; ++i) level0.push_back(i * beam_size);
+  for (int64_t i = 0; i <= num_offsets; ++i) level1.push_back(i);
+
+  platform::CPUPlace place;
+  framework::LoDTensor scores, pre_ids, pre_scores;
+  scores.set_lod(framework::LoD({level0, level1}));
+  scores.Resize(framework::make_ddim({num_offsets, vocab_size}));
+  pre_ids.Resize(framework::make_ddim({num_offsets, 1}));
+  pre_scores.Resize(framework::make_ddim({num_offsets, 1}));
+  auto* scores_data = scores.mutable_data<float>(place);
+  auto* pre_ids_data = pre_ids.mutable_data<int64_t>(place);
+  auto* pre_scores_data = pre_scores.mutable_data<float>(place);
+
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<float> dist(-20.f, 0.f);
+  for (int64_t i = 0; i < scores.numel(); ++i) scores_data[i] = dist(rng);
+  for (int64_t i = 0; i < num_offsets; ++i) {
+    pre_ids_data[i] = i + 1;
+    pre_scores_data[i] = dist(rng);
+  }
+
+  framework::LoDTensor selected_ids, selected_scores;
+  framework::Tensor parent_idx;
+  BeamSearchFunctor<platform::CPUDeviceContext, float> beamsearch;
+  auto run = [&]() {
+    beamsearch(context, &pre_ids, &pre_scores, nullptr, &scores, &selected_ids,
+               &selected_scores, &parent_idx, 0, beam_size, 0, true);
+  };
+  for (int i = 0; i < FLAGS_burning; ++i) {
+    run();
+  }
+  auto start = platform::PosixInNsec() * 1e-3;
+  for (int i = 0; i < FLAGS_repeat; ++i) {
+    run();
+  }
+  auto end = platform::PosixInNsec() * 1e-3;
+  return static_cast<double>(end - start) / FLAGS_repeat;
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
+
+// Benchmark the CPU beam search over beam sizes and vocabulary sizes.
+// To use this tool, run command: ./beam_search_benchmark [options...]
+// Options:
+//     --burning: the burning time before count
+//     --repeat: the repeat times
+//     --num_seqs: the number of source sentences
+//     --beam_sizes: the comma separated beam sizes
+//     --vocab_sizes: the comma separated vocabulary sizes
+//     --num_threads: the number of intra-op threads
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  namespace math = paddle::operators::math;
+
+  paddle::platform::SetNumThreads(FLAGS_num_threads);
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  LOG(INFO) << "Burning " << FLAGS_burning << " times, Repeat " << FLAGS_repeat
+            << " times, " << FLAGS_num_seqs << " sources, "
+            << FLAGS_num_threads << " threads.";
+  for (int vocab_size : math::ParseSizes(FLAGS_vocab_sizes)) {
+    for (int beam_size : math::ParseSizes(FLAGS_beam_sizes)) {
+      double us = math::BenchBeamSearch(context, beam_size, vocab_size);
+      LOG(INFO) << "beam_size " << beam_size << ", vocab_size " << vocab_size
+                << ": " << us << " us/step";
+    }
+  }
+}
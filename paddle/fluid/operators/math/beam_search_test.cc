@@ -14,7 +14,11 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/beam_search.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <tuple>
 #include <vector>
+#include "paddle/fluid/platform/cpu_helper.h"
 
 void PrepareCPUTensors(paddle::framework::LoDTensor* ids,
                        paddle::framework::LoDTensor* scores,
@@ -134,6 +138,86 @@ TEST(BeamSearch, CPU) {
                  paddle::platform::CPUPlace>();
 }
 
+// Compare with a full sort of every source sentence, with the per-source
+// selection running in parallel.
+TEST(BeamSearch, CPULargeParallel) {
+  const size_t num_seqs = 8;
+  const size_t num_prefix = 4;
+  const size_t seq_width = 1000;
+  const size_t beam_size = 16;
+  const int end_id = 0;
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+
+  std::vector<size_t> level0, level1;
+  for (size_t i = 0; i <= num_seqs; ++i) level0.push_back(i * num_prefix);
+  for (size_t i = 0; i <= num_seqs * num_prefix; ++i) level1.push_back(i);
+  paddle::framework::LoD lod({level0, level1});
+
+  const int64_t num_offsets = num_seqs * num_prefix;
+  paddle::framework::LoDTensor ids, scores, pre_ids, pre_scores;
+  scores.set_lod(lod);
+  scores.Resize(paddle::framework::make_ddim(
+      {num_offsets, static_cast<int64_t>(seq_width)}));
+  pre_ids.Resize(paddle::framework::make_ddim({num_offsets, 1}));
+  pre_scores.Resize(paddle::framework::make_ddim({num_offsets, 1}));
+  auto* scores_data = scores.mutable_data<float>(place);
+  auto* pre_ids_data = pre_ids.mutable_data<int64_t>(place);
+  auto* pre_scores_data = pre_scores.mutable_data<float>(place);
+
+  std::mt19937 rng(100);
+  std::uniform_real_distribution<float> dist(0.f, 1.f);
+  for (int64_t i = 0; i < scores.numel(); ++i) scores_data[i] = dist(rng);
+  for (int64_t i = 0; i < num_offsets; ++i) {
+    // The first source has finished one branch.
+    pre_ids_data[i] = i == 1 ? end_id : i + 1;
+    pre_scores_data[i] = 10.f * dist(rng);
+  }
+
+  paddle::framework::LoDTensor selected_ids, selected_scores;
+  paddle::framework::Tensor parent_idx;
+  paddle::platform::SetNumThreads(4);
+  paddle::operators::math::BeamSearchFunctor<
+      paddle::platform::CPUDeviceContext, float>
+      beamsearch;
+  beamsearch(context, &pre_ids, &pre_scores, nullptr, &scores, &selected_ids,
+             &selected_scores, &parent_idx, 0, beam_size, end_id, true);
+  paddle::platform::SetNumThreads(1);
+
+  // (offset, -score, id) sorts in the order of the outputs.
+  std::vector<std::tuple<size_t, float, int64_t>> expected;
+  for (size_t seq = 0; seq < num_seqs; ++seq) {
+    std::vector<std::tuple<float, size_t, int64_t>> candidates;
+    for (size_t offset = level0[seq]; offset < level0[seq + 1]; ++offset) {
+      if (pre_ids_data[offset] == end_id) {
+        candidates.emplace_back(pre_scores_data[offset], offset, end_id);
+        continue;
+      }
+      for (size_t d = 0; d < seq_width; ++d) {
+        candidates.emplace_back(scores_data[offset * seq_width + d], offset,
+                                static_cast<int64_t>(d));
+      }
+    }
+    std::sort(candidates.rbegin(), candidates.rend());
+    std::vector<std::tuple<size_t, float, int64_t>> top;
+    for (size_t i = 0; i < beam_size; ++i) {
+      top.emplace_back(std::get<1>(candidates[i]), -std::get<0>(candidates[i]),
+                       std::get<2>(candidates[i]));
+    }
+    std::sort(top.begin(), top.end());
+    expected.insert(expected.end(), top.begin(), top.end());
+  }
+
+  ASSERT_EQ(selected_ids.numel(), static_cast<int64_t>(expected.size()));
+  ASSERT_EQ(selected_ids.lod()[1].size(), level1.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(selected_ids.data<int64_t>()[i], std::get<2>(expected[i]));
+    EXPECT_EQ(selected_scores.data<float>()[i], -std::get<1>(expected[i]));
+    EXPECT_EQ(parent_idx.data<int>()[i],
+              static_cast<int>(std::get<0>(expected[i])));
+  }
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(BeamSearch, GPU) {
   TestBeamSearch<paddle::platform::CUDADeviceContext,
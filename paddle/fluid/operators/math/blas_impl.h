@@ -42,6 +42,11 @@ struct CBlas<float> {
     platform::dynload::cblas_sgemm_pack(args...);
   }
 
+  template <typename... ARGS>
+  static size_t GEMM_PACK_GET_SIZE(ARGS... args) {
+    return platform::dynload::cblas_sgemm_pack_get_size(args...);
+  }
+
   template <typename... ARGS>
   static void GEMM_COMPUTE(ARGS... args) {
     platform::dynload::cblas_sgemm_compute(args...);
@@ -163,6 +168,11 @@ struct CBlas<double> {
     platform::dynload::cblas_dgemm_pack(args...);
   }
 
+  template <typename... ARGS>
+  static size_t GEMM_PACK_GET_SIZE(ARGS... args) {
+    return platform::dynload::cblas_dgemm_pack_get_size(args...);
+  }
+
   template <typename... ARGS>
   static void GEMM_COMPUTE(ARGS... args) {
     platform::dynload::cblas_dgemm_compute(args...);
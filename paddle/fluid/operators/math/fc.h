@@ -21,12 +21,15 @@ namespace paddle {
 namespace operators {
 namespace math {
 
+// Y = X * W + B, with an optional relu. On CPU, packed_W is the packed form
+// of W from PackedWeightCache and is used instead of W if not null.
 template <typename DeviceContext, typename T>
 class FCFunctor {
  public:
   void operator()(const DeviceContext& context, const int M, const int N,
                   const int K, const T* X, const T* W, T* Y,
-                  const T* B = nullptr, bool relu = false);
+                  const T* B = nullptr, bool relu = false,
+                  const T* packed_W = nullptr);
 };
 
 }  // namespace math
@@ -26,7 +26,7 @@ void SetConstant<DeviceContext, T>::operator()(const DeviceContext& context,
                                                framework::Tensor* tensor,
                                                T num) {
   auto t = framework::EigenVector<T>::Flatten(*tensor);
-  t.device(*context.eigen_device()) = t.constant(static_cast<T>(num));
+  platform::EigenDeviceAssign(context, t, t.constant(static_cast<T>(num)));
 }
 
 template <typename DeviceContext, typename T, int Rank>
@@ -39,8 +39,7 @@ void Transpose<DeviceContext, T, Rank>::operator()(
   }
   auto eigen_in = framework::EigenTensor<T, Rank>::From(in);
   auto eigen_out = framework::EigenTensor<T, Rank>::From(*out);
-  auto* dev = context.eigen_device();
-  eigen_out.device(*dev) = eigen_in.shuffle(permute);
+  platform::EigenDeviceAssign(context, eigen_out, eigen_in.shuffle(permute));
 }
 
 template <typename DeviceContext, typename T>
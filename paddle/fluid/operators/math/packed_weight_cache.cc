@@ -0,0 +1,203 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/packed_weight_cache.h"
+#include "paddle/fluid/operators/math/blas.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+PackedWeightCache& PackedWeightCache::Instance() {
+  static PackedWeightCache cache;
+  return cache;
+}
+
+void PackedWeightCache::AddWeight(const framework::Tensor& weight) {
+  const auto& holder = weight.Holder();
+  PADDLE_ENFORCE_NOT_NULL(holder, "The weight to pack is not initialized.");
+  framework::AutoWRLock guard(&lock_);
+  weights_[holder.get()] = holder;
+  has_weights_.store(true, std::memory_order_release);
+}
+
+// Whether weak points to the allocation of holder. Unlike weak.lock(), it
+// does not touch the reference counts: the control block of weak is kept
+// alive by weak, so no other allocation can have it.
+static bool SameAllocation(const std::weak_ptr<memory::Allocation>& weak,
+                           const std::shared_ptr<memory::Allocation>& holder) {
+  return !weak.owner_before(holder) && !holder.owner_before(weak);
+}
+
+const void* PackedWeightCache::Find(
+    const Key& key, const std::shared_ptr<memory::Allocation>& holder,
+    bool* registered) const {
+  auto weight_it = weights_.find(holder.get());
+  *registered = weight_it != weights_.end() &&
+                SameAllocation(weight_it->second, holder);
+  if (!*registered) {
+    return nullptr;
+  }
+  auto it = entries_.find(key);
+  if (it != entries_.end() && SameAllocation(it->second.holder, holder)) {
+    return it->second.packed.get();
+  }
+  return nullptr;
+}
+
+template <typename T>
+const T* PackedWeightCache::Get(const platform::CPUDeviceContext& context,
+                                const framework::Tensor& weight, const T* B,
+                                int N, int K, int ldb) {
+#ifdef PADDLE_WITH_MKLML
+  if (!has_weights_.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+  const auto& holder = weight.Holder();
+  Key key(B, N, K, ldb);
+  bool registered = false;
+  {
+    framework::AutoRDLock guard(&lock_);
+    const void* packed = Find(key, holder, &registered);
+    if (packed != nullptr || !registered) {
+      return static_cast<const T*>(packed);
+    }
+  }
+
+  framework::AutoWRLock guard(&lock_);
+  // Another thread may have packed it meanwhile.
+  const void* found = Find(key, holder, &registered);
+  if (found != nullptr || !registered) {
+    return static_cast<const T*>(found);
+  }
+  // The weight memory may have been freed and the address reused, release
+  // the packed weights of the freed memory before packing again.
+  ReleaseExpiredLocked();
+
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  T* packed = blas.GEMM_ALLOC(CblasBMatrix, 1, N, K);
+  PADDLE_ENFORCE_NOT_NULL(packed, "Failed to allocate the packed weight.");
+  blas.GEMM_PACK(CblasBMatrix, CblasNoTrans, 1, N, K, static_cast<T>(1), B,
+                 ldb, packed);
+
+  Entry& entry = entries_[key];
+  entry.holder = holder;
+  entry.packed.reset(
+      packed, [](void* ptr) { CBlas<T>::GEMM_FREE(static_cast<T*>(ptr)); });
+  entry.bytes = CBlas<T>::GEMM_PACK_GET_SIZE(CblasBMatrix, 1, N, K);
+  memory_size_ += entry.bytes;
+  VLOG(3) << "Pack GEMM weight of " << K << "x" << N << ", " << entries_.size()
+          << " packed weights take " << memory_size_ << " bytes";
+  return packed;
+#else
+  return nullptr;
+#endif
+}
+
+void PackedWeightCache::Invalidate(const framework::Tensor& weight) {
+  const auto& holder = weight.Holder();
+  if (holder == nullptr) {
+    return;
+  }
+  framework::AutoWRLock guard(&lock_);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (SameAllocation(it->second.holder, holder)) {
+      memory_size_ -= it->second.bytes;
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void PackedWeightCache::ReleaseExpired() {
+  framework::AutoWRLock guard(&lock_);
+  ReleaseExpiredLocked();
+}
+
+void PackedWeightCache::ReleaseExpiredLocked() {
+  for (auto it = weights_.begin(); it != weights_.end();) {
+    if (it->second.expired()) {
+      it = weights_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  has_weights_.store(!weights_.empty(), std::memory_order_release);
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.holder.expired()) {
+      memory_size_ -= it->second.bytes;
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void PackedWeightCache::Clear() {
+  framework::AutoWRLock guard(&lock_);
+  weights_.clear();
+  has_weights_.store(false, std::memory_order_release);
+  entries_.clear();
+  memory_size_ = 0;
+}
+
+size_t PackedWeightCache::Size() const {
+  framework::AutoRDLock guard(&lock_);
+  return entries_.size();
+}
+
+size_t PackedWeightCache::MemorySize() const {
+  framework::AutoRDLock guard(&lock_);
+  return memory_size_;
+}
+
+template <typename T>
+static void PackedGEMMImpl(const platform::CPUDeviceContext& context, int M,
+                           int N, int K, const T* A, int lda,
+                           const T* packed_B, T beta, T* C, int ldc) {
+#ifdef PADDLE_WITH_MKLML
+  auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+  blas.GEMM_COMPUTE(CblasNoTrans, CblasPacked, M, N, K, A, lda, packed_B, N,
+                    beta, C, ldc);
+#else
+  PADDLE_THROW("Packed GEMM is only supported with MKLML.");
+#endif
+}
+
+template <>
+void PackedGEMM<float>(const platform::CPUDeviceContext& context, int M, int N,
+                       int K, const float* A, int lda, const float* packed_B,
+                       float beta, float* C, int ldc) {
+  PackedGEMMImpl<float>(context, M, N, K, A, lda, packed_B, beta, C, ldc);
+}
+
+template <>
+void PackedGEMM<double>(const platform::CPUDeviceContext& context, int M,
+                        int N, int K, const double* A, int lda,
+                        const double* packed_B, double beta, double* C,
+                        int ldc) {
+  PackedGEMMImpl<double>(context, M, N, K, A, lda, packed_B, beta, C, ldc);
+}
+
+template const float* PackedWeightCache::Get<float>(
+    const platform::CPUDeviceContext&, const framework::Tensor&, const float*,
+    int, int, int);
+template const double* PackedWeightCache::Get<double>(
+    const platform::CPUDeviceContext&, const framework::Tensor&, const double*,
+    int, int, int);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,152 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <tuple>
+#include "paddle/fluid/framework/rw_lock.h"
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/**
+ * PackedWeightCache keeps the MKL packed form (cblas_?gemm_pack) of GEMM
+ * weights, so that fc, mul, matmul and the fusion rnn kernels pack a weight
+ * once instead of inside every sgemm call.
+ *
+ * Only tensors registered by AddWeight are packed. The caller guarantees that
+ * they are not modified in place without calling Invalidate, e.g. the
+ * inference predictor registers its persistable parameters when
+ * AnalysisConfig::EnableGemmWeightPacking is set.
+ * A packed weight is bound to the allocation holding the weight: once that
+ * allocation is released the packed weight is stale and is never returned.
+ *
+ * Get is called by every GEMM kernel, so it returns without locking while no
+ * weight is registered, and looks up packed weights under a reader lock
+ * without touching the reference counts of the weights.
+ */
+class PackedWeightCache {
+ public:
+  static PackedWeightCache& Instance();
+
+  // Allow the GEMM weights in the memory of `weight` to be packed.
+  void AddWeight(const framework::Tensor& weight);
+
+  // Return the packed form of the K x N row-major matrix B, which lives in
+  // the memory of `weight` with leading dimension ldb. The matrix is packed
+  // on first use. Return nullptr if `weight` is not registered or packed
+  // GEMM is not supported by the blas library.
+  template <typename T>
+  const T* Get(const platform::CPUDeviceContext& context,
+               const framework::Tensor& weight, const T* B, int N, int K,
+               int ldb);
+
+  // Drop the packed weights of the memory of `weight`, which is going to be
+  // written. They are packed again on next use.
+  void Invalidate(const framework::Tensor& weight);
+
+  // Release the packed weights whose original weights have been freed.
+  void ReleaseExpired();
+
+  void Clear();
+
+  // The number of packed matrices and the memory they take, in bytes.
+  size_t Size() const;
+  size_t MemorySize() const;
+
+ private:
+  PackedWeightCache() = default;
+
+  struct Entry {
+    std::weak_ptr<memory::Allocation> holder;
+    std::shared_ptr<void> packed;
+    size_t bytes{0};
+  };
+  using Key = std::tuple<const void*, int, int, int>;
+
+  // Look up the packed weight of key, nullptr if it is not packed or the
+  // weight is not registered. *registered tells whether the weight is.
+  const void* Find(const Key& key,
+                   const std::shared_ptr<memory::Allocation>& holder,
+                   bool* registered) const;
+
+  // ReleaseExpired with the writer lock held.
+  void ReleaseExpiredLocked();
+
+  // Whether weights_ is not empty, read without locking.
+  std::atomic<bool> has_weights_{false};
+  mutable framework::RWLock lock_;
+  std::map<const memory::Allocation*, std::weak_ptr<memory::Allocation>>
+      weights_;
+  std::map<Key, Entry> entries_;
+  size_t memory_size_{0};
+
+  DISABLE_COPY_AND_ASSIGN(PackedWeightCache);
+};
+
+// Return the packed form of the K x N weight matrix for CPU kernels, or
+// nullptr when the weight can not be packed.
+template <typename T, typename DeviceContext>
+inline const T* GetPackedWeight(const DeviceContext& context,
+                                const framework::Tensor& weight, int N,
+                                int K) {
+  return nullptr;
+}
+
+template <>
+inline const float* GetPackedWeight<float>(
+    const platform::CPUDeviceContext& context, const framework::Tensor& weight,
+    int N, int K) {
+  return PackedWeightCache::Instance().Get<float>(
+      context, weight, weight.data<float>(), N, K, N);
+}
+
+template <>
+inline const double* GetPackedWeight<double>(
+    const platform::CPUDeviceContext& context, const framework::Tensor& weight,
+    int N, int K) {
+  return PackedWeightCache::Instance().Get<double>(
+      context, weight, weight.data<double>(), N, K, N);
+}
+
+// C = A * packed_B + beta * C, where packed_B is the K x N matrix returned by
+// GetPackedWeight.
+template <typename T, typename DeviceContext>
+inline void PackedGEMM(const DeviceContext& context, int M, int N, int K,
+                       const T* A, int lda, const T* packed_B, T beta, T* C,
+                       int ldc) {
+  PADDLE_THROW("Packed GEMM is only supported for float and double on CPU.");
+}
+
+template <>
+void PackedGEMM<float>(const platform::CPUDeviceContext& context, int M, int N,
+                       int K, const float* A, int lda, const float* packed_B,
+                       float beta, float* C, int ldc);
+
+template <>
+void PackedGEMM<double>(const platform::CPUDeviceContext& context, int M,
+                        int N, int K, const double* A, int lda,
+                        const double* packed_B, double beta, double* C,
+                        int ldc);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
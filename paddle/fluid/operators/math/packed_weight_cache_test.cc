@@ -0,0 +1,98 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/packed_weight_cache.h"
+#include <gtest/gtest.h>
+#include <vector>
+#include "paddle/fluid/operators/math/blas.h"
+
+TEST(PackedWeightCache, UnregisteredWeight) {
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  paddle::framework::Tensor weight;
+  weight.Resize({4, 3});
+  weight.mutable_data<float>(place);
+
+  auto& cache = paddle::operators::math::PackedWeightCache::Instance();
+  cache.Clear();
+  EXPECT_EQ(
+      paddle::operators::math::GetPackedWeight<float>(context, weight, 3, 4),
+      nullptr);
+  EXPECT_EQ(cache.Size(), 0UL);
+}
+
+TEST(PackedWeightCache, PackedGEMM) {
+  const int M = 2, N = 3, K = 4;
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  paddle::framework::Tensor weight;
+  weight.Resize({K, N});
+  float* w = weight.mutable_data<float>(place);
+  for (int i = 0; i < K * N; ++i) {
+    w[i] = static_cast<float>(i) / 10;
+  }
+  std::vector<float> x(M * K);
+  for (int i = 0; i < M * K; ++i) {
+    x[i] = static_cast<float>(i) - 3;
+  }
+
+  auto& cache = paddle::operators::math::PackedWeightCache::Instance();
+  cache.Clear();
+  cache.AddWeight(weight);
+  const float* packed =
+      paddle::operators::math::GetPackedWeight<float>(context, weight, N, K);
+#ifdef PADDLE_WITH_MKLML
+  ASSERT_NE(packed, nullptr);
+  EXPECT_EQ(cache.Size(), 1UL);
+  EXPECT_GT(cache.MemorySize(), 0UL);
+  // the second lookup hits the cache
+  EXPECT_EQ(
+      paddle::operators::math::GetPackedWeight<float>(context, weight, N, K),
+      packed);
+
+  std::vector<float> expected(M * N), actual(M * N);
+  auto blas = paddle::operators::math::GetBlas<
+      paddle::platform::CPUDeviceContext, float>(context);
+  blas.MatMul(M, N, K, x.data(), w, expected.data());
+  paddle::operators::math::PackedGEMM<float>(context, M, N, K, x.data(), K,
+                                             packed, 0.f, actual.data(), N);
+  for (int i = 0; i < M * N; ++i) {
+    EXPECT_NEAR(expected[i], actual[i], 1e-5);
+  }
+
+  // a written weight is packed again
+  w[0] = 100.f;
+  cache.Invalidate(weight);
+  EXPECT_EQ(cache.Size(), 0UL);
+  EXPECT_EQ(cache.MemorySize(), 0UL);
+  packed =
+      paddle::operators::math::GetPackedWeight<float>(context, weight, N, K);
+  ASSERT_NE(packed, nullptr);
+  EXPECT_EQ(cache.Size(), 1UL);
+  blas.MatMul(M, N, K, x.data(), w, expected.data());
+  paddle::operators::math::PackedGEMM<float>(context, M, N, K, x.data(), K,
+                                             packed, 0.f, actual.data(), N);
+  for (int i = 0; i < M * N; ++i) {
+    EXPECT_NEAR(expected[i], actual[i], 1e-3);
+  }
+
+  // the packed weight is released together with the weight
+  weight.clear();
+  cache.ReleaseExpired();
+  EXPECT_EQ(cache.Size(), 0UL);
+  EXPECT_EQ(cache.MemorySize(), 0UL);
+#else
+  EXPECT_EQ(packed, nullptr);
+#endif
+}
@@ -39,9 +39,8 @@ void PadFunction(const framework::ExecutionContext& context,
   auto src_tensor = EigenTensor<T, D>::From(src);
   auto out_tensor = EigenTensor<T, D>::From(*out);
 
-  auto& place =
-      *context.template device_context<DeviceContext>().eigen_device();
-  out_tensor.device(place) = src_tensor.pad(paddings, pad_value);
+  platform::EigenDeviceAssign(context.template device_context<DeviceContext>(),
+                              out_tensor, src_tensor.pad(paddings, pad_value));
 }
 
 template <typename DeviceContext, typename T, size_t D>
@@ -56,9 +55,9 @@ void PadGradFunction(const framework::ExecutionContext& context,
 
   auto d_out_tensor = EigenTensor<T, D>::From(*d_out);
   auto src_tensor = EigenTensor<T, D>::From(src);
-  auto& place =
-      *context.template device_context<DeviceContext>().eigen_device();
-  d_out_tensor.device(place) = src_tensor.pad(paddings, static_cast<T>(0));
+  platform::EigenDeviceAssign(
+      context.template device_context<DeviceContext>(), d_out_tensor,
+      src_tensor.pad(paddings, static_cast<T>(0)));
 }
 
 template <typename DeviceContext, typename T>
@@ -0,0 +1,330 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+/*
+ * Map a value to an unsigned key whose unsigned order is the order of the
+ * values, so that floating point and signed keys can be radix sorted.
+ */
+template <typename T>
+struct RadixTraits;
+
+template <>
+struct RadixTraits<float> {
+  using UKey = uint32_t;
+  static UKey Encode(float v) {
+    UKey u;
+    std::memcpy(&u, &v, sizeof(u));
+    return (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+  }
+};
+
+template <>
+struct RadixTraits<double> {
+  using UKey = uint64_t;
+  static UKey Encode(double v) {
+    UKey u;
+    std::memcpy(&u, &v, sizeof(u));
+    return (u & 0x8000000000000000ull) ? ~u : (u | 0x8000000000000000ull);
+  }
+};
+
+template <>
+struct RadixTraits<int32_t> {
+  using UKey = uint32_t;
+  static UKey Encode(int32_t v) {
+    return static_cast<UKey>(v) ^ 0x80000000u;
+  }
+};
+
+template <>
+struct RadixTraits<int64_t> {
+  using UKey = uint64_t;
+  static UKey Encode(int64_t v) {
+    return static_cast<UKey>(v) ^ 0x8000000000000000ull;
+  }
+};
+
+constexpr int kRadixBits = 8;
+constexpr int kRadixBuckets = 1 << kRadixBits;
+// Below this size a comparison sort is faster than the radix passes.
+constexpr int64_t kRadixSortMinSize = 64;
+// Top-k with k up to this size keeps a heap and a scan threshold, larger k
+// use radix select.
+constexpr int64_t kTopKHeapMaxSize = 64;
+
+/*
+ * The buffers of the sorts, reused by all rows sorted on the same thread.
+ */
+template <typename UKey>
+struct RadixWorkspace {
+  std::vector<UKey> keys;
+  std::vector<UKey> keys_tmp;
+  std::vector<int64_t> ids;
+  std::vector<int64_t> ids_tmp;
+
+  void Reserve(size_t n) {
+    if (keys.size() < n) {
+      keys.resize(n);
+      keys_tmp.resize(n);
+      ids.resize(n);
+      ids_tmp.resize(n);
+    }
+  }
+
+  static RadixWorkspace* Get() {
+    static thread_local RadixWorkspace workspace;
+    return &workspace;
+  }
+};
+
+/*
+ * Stable LSD radix sort of keys[0, n) in ascending order, ids are moved along
+ * with their keys. keys_tmp and ids_tmp are scratch buffers of size n. Passes
+ * in which every key has the same digit are skipped.
+ */
+template <typename UKey>
+void RadixSortPairs(UKey* keys, int64_t* ids, UKey* keys_tmp, int64_t* ids_tmp,
+                    int64_t n) {
+  if (n < kRadixSortMinSize) {
+    // Insertion sort keeps the equal keys in their original order.
+    for (int64_t i = 1; i < n; ++i) {
+      UKey key = keys[i];
+      int64_t id = ids[i];
+      int64_t j = i;
+      for (; j > 0 && keys[j - 1] > key; --j) {
+        keys[j] = keys[j - 1];
+        ids[j] = ids[j - 1];
+      }
+      keys[j] = key;
+      ids[j] = id;
+    }
+    return;
+  }
+
+  UKey* src_keys = keys;
+  int64_t* src_ids = ids;
+  UKey* dst_keys = keys_tmp;
+  int64_t* dst_ids = ids_tmp;
+  int64_t offsets[kRadixBuckets];
+  for (int shift = 0; shift < static_cast<int>(sizeof(UKey) * 8);
+       shift += kRadixBits) {
+    std::fill(offsets, offsets + kRadixBuckets, 0);
+    for (int64_t i = 0; i < n; ++i) {
+      ++offsets[(src_keys[i] >> shift) & (kRadixBuckets - 1)];
+    }
+    if (offsets[(src_keys[0] >> shift) & (kRadixBuckets - 1)] == n) continue;
+    int64_t sum = 0;
+    for (int b = 0; b < kRadixBuckets; ++b) {
+      int64_t count = offsets[b];
+      offsets[b] = sum;
+      sum += count;
+    }
+    for (int64_t i = 0; i < n; ++i) {
+      int64_t pos = offsets[(src_keys[i] >> shift) & (kRadixBuckets - 1)]++;
+      dst_keys[pos] = src_keys[i];
+      dst_ids[pos] = src_ids[i];
+    }
+    std::swap(src_keys, dst_keys);
+    std::swap(src_ids, dst_ids);
+  }
+  if (src_keys != keys) {
+    std::memcpy(keys, src_keys, n * sizeof(UKey));
+    std::memcpy(ids, src_ids, n * sizeof(int64_t));
+  }
+}
+
+/*
+ * Sort x[0, n * stride) with step stride in ascending order, write the sorted
+ * values to out and their positions along the sorted axis to out_ids, both
+ * with the same step. Equal values keep their original order.
+ */
+template <typename T>
+void RadixArgsort(const T* x, int64_t n, int64_t stride, T* out,
+                  int64_t* out_ids) {
+  using UKey = typename RadixTraits<T>::UKey;
+  auto* ws = RadixWorkspace<UKey>::Get();
+  ws->Reserve(n);
+  UKey* keys = ws->keys.data();
+  int64_t* ids = ws->ids.data();
+  for (int64_t j = 0; j < n; ++j) {
+    keys[j] = RadixTraits<T>::Encode(x[j * stride]);
+    ids[j] = j;
+  }
+  RadixSortPairs(keys, ids, ws->keys_tmp.data(), ws->ids_tmp.data(), n);
+  for (int64_t j = 0; j < n; ++j) {
+    out[j * stride] = x[ids[j] * stride];
+    out_ids[j * stride] = ids[j];
+  }
+}
+
+namespace detail {
+
+// The heap keeps the worst of the selected items on the top. An item is
+// better when its key is larger, or the key is equal and the index smaller.
+template <typename UKey>
+struct TopKItem {
+  UKey key;
+  int64_t id;
+  bool operator<(const TopKItem& in) const {
+    return key > in.key || (key == in.key && id < in.id);
+  }
+};
+
+template <typename T>
+void TopKByHeap(const T* x, int64_t n, int64_t k, T* out, int64_t* out_ids) {
+  using UKey = typename RadixTraits<T>::UKey;
+  using Item = TopKItem<UKey>;
+  constexpr int64_t kBlock = 16;
+  Item heap[kTopKHeapMaxSize];
+  int64_t size = 0;
+
+  auto push = [&](int64_t j) {
+    Item item{RadixTraits<T>::Encode(x[j]), j};
+    if (size < k) {
+      heap[size++] = item;
+      std::push_heap(heap, heap + size);
+    } else if (item < heap[0]) {
+      std::pop_heap(heap, heap + k);
+      heap[k - 1] = item;
+      std::push_heap(heap, heap + k);
+    }
+  };
+
+  int64_t j = 0;
+  for (; j < n && size < k; ++j) {
+    push(j);
+  }
+  // Once the heap is full, whole blocks below the worst selected value are
+  // skipped. The hit count of a block is a plain compare-and-add loop that
+  // compilers vectorize. Any compare with a NaN is false, so a NaN in the
+  // block or as the threshold counts as a hit and goes through the exact
+  // comparison of the encoded keys.
+  for (; j + kBlock <= n; j += kBlock) {
+    const T threshold = x[heap[0].id];
+    const T* block = x + j;
+    int hits = 0;
+    for (int64_t b = 0; b < kBlock; ++b) {
+      hits += !(block[b] < threshold);
+    }
+    if (hits == 0) continue;
+    for (int64_t b = 0; b < kBlock; ++b) {
+      push(j + b);
+    }
+  }
+  for (; j < n; ++j) {
+    push(j);
+  }
+
+  std::sort_heap(heap, heap + size);
+  for (int64_t i = 0; i < size; ++i) {
+    out[i] = x[heap[i].id];
+    out_ids[i] = heap[i].id;
+  }
+}
+
+template <typename T>
+void TopKByRadixSelect(const T* x, int64_t n, int64_t k, T* out,
+                       int64_t* out_ids) {
+  using UKey = typename RadixTraits<T>::UKey;
+  auto* ws = RadixWorkspace<UKey>::Get();
+  ws->Reserve(n);
+  UKey* keys = ws->keys.data();
+  int64_t* ids = ws->ids.data();
+  UKey* cand_keys = ws->keys_tmp.data();
+  int64_t* cand_ids = ws->ids_tmp.data();
+
+  for (int64_t j = 0; j < n; ++j) {
+    keys[j] = RadixTraits<T>::Encode(x[j]);
+  }
+
+  // Find the k-th largest key digit by digit from the most significant one.
+  // The candidates sharing the selected digits are compacted after every
+  // pass, so later passes only visit a small part of the row.
+  const UKey* cur_keys = keys;
+  int64_t num_cand = n;
+  int64_t remaining = k;
+  UKey kth = 0;
+  int64_t counts[kRadixBuckets];
+  for (int shift = static_cast<int>(sizeof(UKey) * 8) - kRadixBits;
+       shift >= 0; shift -= kRadixBits) {
+    std::fill(counts, counts + kRadixBuckets, 0);
+    for (int64_t i = 0; i < num_cand; ++i) {
+      ++counts[(cur_keys[i] >> shift) & (kRadixBuckets - 1)];
+    }
+    int bucket = kRadixBuckets - 1;
+    for (; bucket > 0 && counts[bucket] < remaining; --bucket) {
+      remaining -= counts[bucket];
+    }
+    kth |= static_cast<UKey>(bucket) << shift;
+    if (counts[bucket] == num_cand) continue;
+    int64_t next = 0;
+    for (int64_t i = 0; i < num_cand; ++i) {
+      if (static_cast<int>((cur_keys[i] >> shift) &
+                           (kRadixBuckets - 1)) == bucket) {
+        cand_keys[next++] = cur_keys[i];
+      }
+    }
+    cur_keys = cand_keys;
+    num_cand = next;
+  }
+
+  // Take every key above the k-th one and the first `remaining` equal ones,
+  // in index order.
+  int64_t selected = 0;
+  for (int64_t j = 0; j < n; ++j) {
+    if (keys[j] > kth || (keys[j] == kth && remaining-- > 0)) {
+      // Inverted keys sort the selection in descending order.
+      cand_keys[selected] = ~keys[j];
+      cand_ids[selected] = j;
+      ++selected;
+    }
+  }
+  RadixSortPairs(cand_keys, cand_ids, keys, ids, selected);
+  for (int64_t i = 0; i < selected; ++i) {
+    out[i] = x[cand_ids[i]];
+    out_ids[i] = cand_ids[i];
+  }
+}
+
+}  // namespace detail
+
+/*
+ * Write the k largest values of x[0, n) to out in descending order, and their
+ * indices to out_ids. Equal values are ordered by their index.
+ */
+template <typename T>
+void TopK(const T* x, int64_t n, int64_t k, T* out, int64_t* out_ids) {
+  k = std::min(k, n);
+  if (k <= 0) return;
+  if (k <= kTopKHeapMaxSize) {
+    detail::TopKByHeap(x, n, k, out, out_ids);
+  } else {
+    detail::TopKByRadixSelect(x, n, k, out, out_ids);
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
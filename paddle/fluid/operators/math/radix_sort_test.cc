@@ -0,0 +1,123 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/radix_sort.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// Values are drawn from [-range, range], a small range gives many ties.
+template <typename T>
+std::vector<T> RandomValues(int64_t n, int range, std::mt19937* rng) {
+  std::uniform_int_distribution<int> dist(-range, range);
+  std::vector<T> x(n);
+  for (auto& v : x) {
+    v = std::is_integral<T>::value ? static_cast<T>(dist(*rng))
+                                   : static_cast<T>(dist(*rng)) / 3;
+  }
+  return x;
+}
+
+template <typename T>
+void TestTopK(int64_t n, int64_t k, int range, std::mt19937* rng) {
+  auto x = RandomValues<T>(n, range, rng);
+  std::vector<int64_t> expected(n);
+  std::iota(expected.begin(), expected.end(), 0);
+  std::stable_sort(expected.begin(), expected.end(),
+                   [&](int64_t a, int64_t b) { return x[a] > x[b]; });
+
+  std::vector<T> out(k);
+  std::vector<int64_t> out_ids(k);
+  TopK<T>(x.data(), n, k, out.data(), out_ids.data());
+  for (int64_t i = 0; i < k; ++i) {
+    ASSERT_EQ(out_ids[i], expected[i]) << "n " << n << ", k " << k;
+    ASSERT_EQ(out[i], x[expected[i]]);
+  }
+}
+
+template <typename T>
+void TestArgsort(int64_t n, int64_t stride, int range, std::mt19937* rng) {
+  auto x = RandomValues<T>(n * stride, range, rng);
+  std::vector<T> out(n * stride);
+  std::vector<int64_t> out_ids(n * stride);
+  for (int64_t s = 0; s < stride; ++s) {
+    RadixArgsort<T>(x.data() + s, n, stride, out.data() + s,
+                    out_ids.data() + s);
+
+    std::vector<int64_t> expected(n);
+    std::iota(expected.begin(), expected.end(), 0);
+    std::stable_sort(expected.begin(), expected.end(),
+                     [&](int64_t a, int64_t b) {
+                       return x[a * stride + s] < x[b * stride + s];
+                     });
+    for (int64_t j = 0; j < n; ++j) {
+      ASSERT_EQ(out_ids[j * stride + s], expected[j]) << "n " << n;
+      ASSERT_EQ(out[j * stride + s], x[expected[j] * stride + s]);
+    }
+  }
+}
+
+template <typename T>
+void TestAll() {
+  std::mt19937 rng(100);
+  for (int range : {3, 1000000}) {
+    for (int64_t n : {1, 17, 64, 1000, 50000}) {
+      // Both the heap path and the radix select path.
+      for (int64_t k : {1, 10, 64, 65, 500}) {
+        if (k <= n) TestTopK<T>(n, k, range, &rng);
+      }
+      TestArgsort<T>(n, 1, range, &rng);
+    }
+    TestArgsort<T>(300, 3, range, &rng);
+  }
+}
+
+// A NaN ranks above every number, wherever it is in the row.
+template <typename T>
+void TestTopKNaN() {
+  std::mt19937 rng(100);
+  auto x = RandomValues<T>(200, 1000000, &rng);
+  x[3] = std::numeric_limits<T>::quiet_NaN();
+  x[150] = std::numeric_limits<T>::quiet_NaN();
+  for (int64_t k : {2, 10, 100}) {
+    std::vector<T> out(k);
+    std::vector<int64_t> out_ids(k);
+    TopK<T>(x.data(), x.size(), k, out.data(), out_ids.data());
+    EXPECT_EQ(out_ids[0], 3) << "k " << k;
+    EXPECT_EQ(out_ids[1], 150) << "k " << k;
+    EXPECT_TRUE(std::isnan(out[0]));
+    EXPECT_TRUE(std::isnan(out[1]));
+  }
+}
+
+TEST(RadixSort, float) { TestAll<float>(); }
+TEST(RadixSort, double) { TestAll<double>(); }
+TEST(RadixSort, int32) { TestAll<int32_t>(); }
+TEST(RadixSort, int64) { TestAll<int64_t>(); }
+TEST(RadixSort, TopKNaN) {
+  TestTopKNaN<float>();
+  TestTopKNaN<double>();
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -13,50 +13,77 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/operators/math/sequence_padding.h"
+#include <algorithm>
+#include "paddle/fluid/operators/math/sequence_parallel.h"
 
 namespace paddle {
 namespace operators {
 namespace math {
 
+/*
+ * Copy the valid steps of every sequence between the sequence tensor and the
+ * padded tensor. When pad_value is given (kSeqToPad only), the padded steps
+ * of every sequence are filled in the same pass. The sequences are
+ * distributed over the intra-op threads of the context.
+ */
 template <typename T>
-void CopyValidData(framework::Tensor* dst_tensor,
+void CopyValidData(const platform::CPUDeviceContext& context,
+                   framework::Tensor* dst_tensor,
                    const framework::Tensor* src_tensor,
                    const framework::Vector<size_t>& seq_offsets,
                    int pad_seq_len, int step_width, bool norm_by_len,
-                   CopyType type, PadLayout layout) {
+                   CopyType type, PadLayout layout,
+                   const framework::Tensor* pad_value = nullptr) {
   int seq_num = seq_offsets.size() - 1;
+  PADDLE_ENFORCE_GE(
+      static_cast<size_t>(pad_seq_len), MaximumSequenceLength(seq_offsets),
+      "The padded sequence length can not be less than its original length.");
+  const size_t* offsets = seq_offsets.data();
   const T* src_data = src_tensor->data<T>();
   T* dst_data = dst_tensor->data<T>();
+  const T* pad_value_data = pad_value ? pad_value->data<T>() : nullptr;
+  const bool is_scalar_pad = pad_value && pad_value->numel() == 1;
 
-  int seq_cpy_gap = step_width;
-  int pad_cpy_gap =
+  int64_t seq_cpy_gap = step_width;
+  int64_t pad_cpy_gap =
       layout == kBatchLengthWidth ? step_width : seq_num * step_width;
-  for (int seq_idx = 0; seq_idx < seq_num; ++seq_idx) {
-    int valid_seq_len = seq_offsets[seq_idx + 1] - seq_offsets[seq_idx];
-    PADDLE_ENFORCE_GE(
-        pad_seq_len, valid_seq_len,
-        "The padded sequence length can not be less than its original length.");
-    int seq_data_offset = seq_offsets[seq_idx] * step_width;
-    int pad_data_offset = layout == kBatchLengthWidth
-                              ? seq_idx * pad_seq_len * step_width
-                              : seq_idx * step_width;
-    float scale = 1.0f / static_cast<float>(valid_seq_len);
-
-    for (int step_idx = 0; step_idx < valid_seq_len; ++step_idx) {
-      const T* src =
-          src_data + (type == kSeqToPad ? seq_data_offset : pad_data_offset);
-      T* dst =
-          dst_data + (type == kSeqToPad ? pad_data_offset : seq_data_offset);
-      memcpy(dst, src, step_width * sizeof(T));
-      if (norm_by_len) {
-        for (int i = 0; i < step_width; ++i) {
-          *(dst + i) *= scale;
+  ParallelForSequences(context, seq_offsets, step_width, [&](int64_t seq_begin,
+                                                             int64_t seq_end) {
+    for (int64_t seq_idx = seq_begin; seq_idx < seq_end; ++seq_idx) {
+      int valid_seq_len = offsets[seq_idx + 1] - offsets[seq_idx];
+      int64_t seq_data_offset = offsets[seq_idx] * step_width;
+      int64_t pad_data_offset = layout == kBatchLengthWidth
+                                    ? seq_idx * pad_seq_len * step_width
+                                    : seq_idx * step_width;
+      float scale = 1.0f / static_cast<float>(valid_seq_len);
+
+      for (int step_idx = 0; step_idx < valid_seq_len; ++step_idx) {
+        const T* src =
+            src_data + (type == kSeqToPad ? seq_data_offset : pad_data_offset);
+        T* dst =
+            dst_data + (type == kSeqToPad ? pad_data_offset : seq_data_offset);
+        memcpy(dst, src, step_width * sizeof(T));
+        if (norm_by_len) {
+          for (int i = 0; i < step_width; ++i) {
+            *(dst + i) *= scale;
+          }
         }
+        seq_data_offset += seq_cpy_gap;
+        pad_data_offset += pad_cpy_gap;
+      }
+
+      if (pad_value_data == nullptr) continue;
+      for (int step_idx = valid_seq_len; step_idx < pad_seq_len; ++step_idx) {
+        T* dst = dst_data + pad_data_offset;
+        if (is_scalar_pad) {
+          std::fill(dst, dst + step_width, *pad_value_data);
+        } else {
+          memcpy(dst, pad_value_data, step_width * sizeof(T));
+        }
+        pad_data_offset += pad_cpy_gap;
       }
-      seq_data_offset += seq_cpy_gap;
-      pad_data_offset += pad_cpy_gap;
     }
-  }
+  });
 }
 
 template <typename T>
@@ -99,20 +126,25 @@ class PaddingLoDTensorFunctor<platform::CPUDeviceContext, T> {
                    "The numel of 'pad_value' can only be 1 or be equal to the "
                    "'step_width'.");
 
-    // fill padding value
-    T* pad_data = pad_tensor->data<T>();
-    const T* pad_value_data = pad_value.data<T>();
-    if (pad_value.numel() == 1) {
-      fast_mem_init<T>(pad_data, pad_tensor->numel(), pad_value_data,
-                       sizeof(T));
-    } else {
-      for (int i = 0; i < pad_tensor->numel(); i += step_width) {
-        memcpy(pad_data + i, pad_value_data, step_width * sizeof(T));
+    // The padded steps are filled together with the valid ones, unless the
+    // padded tensor holds more than the padded sequences.
+    int64_t seq_num = seq_offsets.size() - 1;
+    if (pad_tensor->numel() != seq_num * pad_seq_len * step_width) {
+      T* pad_data = pad_tensor->data<T>();
+      const T* pad_value_data = pad_value.data<T>();
+      if (pad_value.numel() == 1) {
+        fast_mem_init<T>(pad_data, pad_tensor->numel(), pad_value_data,
+                         sizeof(T));
+      } else {
+        for (int i = 0; i < pad_tensor->numel(); i += step_width) {
+          memcpy(pad_data + i, pad_value_data, step_width * sizeof(T));
+        }
       }
     }
 
-    CopyValidData<T>(pad_tensor, &seq_tensor, seq_offsets, pad_seq_len,
-                     step_width, norm_by_times, kSeqToPad, layout);
+    CopyValidData<T>(context, pad_tensor, &seq_tensor, seq_offsets,
+                     pad_seq_len, step_width, norm_by_times, kSeqToPad, layout,
+                     &pad_value);
   }
 };
 
@@ -135,8 +167,9 @@ class UnpaddingLoDTensorFunctor<platform::CPUDeviceContext, T> {
     CheckDims(seq_tensor_dims, pad_tensor_dims, seq_offsets, pad_seq_len,
               step_width, layout);
 
-    CopyValidData<T>(seq_tensor, &pad_tensor, seq_offsets, pad_seq_len,
-                     step_width, norm_by_times, kPadToSeq, layout);
+    CopyValidData<T>(context, seq_tensor, &pad_tensor, seq_offsets,
+                     pad_seq_len, step_width, norm_by_times, kPadToSeq,
+                     layout);
   }
 };
 
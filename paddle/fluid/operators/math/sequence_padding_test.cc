@@ -14,7 +14,9 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/sequence_padding.h"
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <vector>
+#include "paddle/fluid/platform/cpu_helper.h"
 
 template <typename DeviceContext, typename Place, typename T>
 void TestSequencePadding(const paddle::framework::LoD& lod,
@@ -105,6 +107,73 @@ TEST(Seq2BatchPadding, CPU) {
                       paddle::platform::CPUPlace, float>(lod2, 128);
 }
 
+// Padding and unpadding on several threads write the same tensors as on the
+// calling thread, the padded steps included.
+TEST(SequencePadding, CPU_ParallelMatchesSerial) {
+  const int64_t width = 64;
+  std::vector<size_t> offsets({0});
+  for (size_t i = 0; i < 2000; ++i) {
+    offsets.push_back(offsets.back() + i % 7);
+  }
+  paddle::framework::LoD lod({offsets});
+  const int64_t num_seqs = offsets.size() - 1;
+  const int64_t num_rows = offsets.back();
+  const int64_t max_len = static_cast<int64_t>(
+      paddle::operators::math::MaximumSequenceLength(lod[0]));
+
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  paddle::framework::LoDTensor seq;
+  seq.set_lod(lod);
+  float* seq_data = seq.mutable_data<float>(
+      paddle::framework::make_ddim({num_rows, width}), place);
+  for (int64_t i = 0; i < seq.numel(); ++i) {
+    seq_data[i] = static_cast<float>((i * 37) % 101) / 10.f;
+  }
+  paddle::framework::LoDTensor pad_value;
+  *pad_value.mutable_data<float>({1}, place) = -1.f;
+
+  for (auto layout : {paddle::operators::math::kBatchLengthWidth,
+                      paddle::operators::math::kLengthBatchWidth}) {
+    auto padding_dims =
+        layout == paddle::operators::math::kBatchLengthWidth
+            ? paddle::framework::make_ddim({num_seqs, max_len, width})
+            : paddle::framework::make_ddim({max_len, num_seqs, width});
+    for (bool norm_by_times : {false, true}) {
+      paddle::framework::LoDTensor paddings[2];
+      paddle::framework::LoDTensor seq_backs[2];
+      for (int k = 0; k < 2; ++k) {
+        paddle::platform::SetNumThreads(k == 0 ? 1 : 4);
+        float* padding_data =
+            paddings[k].mutable_data<float>(padding_dims, place);
+        std::fill(padding_data, padding_data + paddings[k].numel(), 9.f);
+        paddle::operators::math::PaddingLoDTensorFunctor<
+            paddle::platform::CPUDeviceContext, float>()(
+            context, seq, &paddings[k], pad_value, -1, 0, norm_by_times,
+            layout);
+
+        seq_backs[k].set_lod(lod);
+        float* seq_back_data = seq_backs[k].mutable_data<float>(
+            paddle::framework::make_ddim({num_rows, width}), place);
+        std::fill(seq_back_data, seq_back_data + seq_backs[k].numel(), 9.f);
+        paddle::operators::math::UnpaddingLoDTensorFunctor<
+            paddle::platform::CPUDeviceContext, float>()(
+            context, paddings[0], &seq_backs[k], -1, 0, norm_by_times,
+            layout);
+      }
+      paddle::platform::SetNumThreads(1);
+      for (int64_t i = 0; i < paddings[0].numel(); ++i) {
+        ASSERT_EQ(paddings[0].data<float>()[i], paddings[1].data<float>()[i])
+            << "padding element " << i;
+      }
+      for (int64_t i = 0; i < seq_backs[0].numel(); ++i) {
+        ASSERT_EQ(seq_backs[0].data<float>()[i], seq_backs[1].data<float>()[i])
+            << "unpadding element " << i;
+      }
+    }
+  }
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(SequencePadding, CUDA) {
   paddle::framework::LoD lod1;
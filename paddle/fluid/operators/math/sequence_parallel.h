@@ -0,0 +1,81 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <algorithm>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// Batches with fewer elements than this are processed on the calling thread.
+constexpr int64_t kMinParallelSequenceElements = 1 << 15;
+
+/*
+ * \brief Call func(seq_begin, seq_end) over the sequences described by the
+ *        absolute offsets seq_offsets, in parallel on the Eigen thread pool
+ *        device of the context.
+ *
+ * The sequences are split into one contiguous chunk per thread, so that every
+ * chunk holds about the same number of rows. Different chunks never touch the
+ * same rows, so func needs no synchronization when it only writes the rows of
+ * its own sequences. framework::Vector is not safe to read from several
+ * threads, func should read the offsets through seq_offsets.data() taken on
+ * the calling thread.
+ */
+template <typename Func>
+void ParallelForSequences(const platform::CPUDeviceContext& context,
+                          const framework::Vector<size_t>& seq_offsets,
+                          int64_t step_width, Func func) {
+  const int64_t num_seqs = static_cast<int64_t>(seq_offsets.size()) - 1;
+  if (num_seqs <= 0) return;
+  const size_t* offsets = seq_offsets.data();
+  const size_t first_row = offsets[0];
+  const size_t num_rows = offsets[num_seqs] - first_row;
+
+  auto* pool_device = context.eigen_pool_device();
+  if (pool_device == nullptr || num_seqs == 1 ||
+      static_cast<int64_t>(num_rows) * step_width <
+          kMinParallelSequenceElements) {
+    func(0, num_seqs);
+    return;
+  }
+
+  const int64_t num_chunks =
+      std::min<int64_t>(pool_device->numThreads(), num_seqs);
+  auto chunk_boundary = [&](int64_t chunk) -> int64_t {
+    if (chunk == 0) return 0;
+    if (chunk == num_chunks) return num_seqs;
+    size_t row = first_row + num_rows * chunk / num_chunks;
+    return std::lower_bound(offsets, offsets + num_seqs, row) - offsets;
+  };
+  // Every chunk is a full share of the work, make each one a separate task.
+  Eigen::TensorOpCost cost(0, 0, static_cast<double>(num_rows) * step_width /
+                                     num_chunks);
+  pool_device->parallelFor(
+      num_chunks, cost, [&](Eigen::Index first, Eigen::Index last) {
+        for (Eigen::Index chunk = first; chunk < last; ++chunk) {
+          int64_t seq_begin = chunk_boundary(chunk);
+          int64_t seq_end = chunk_boundary(chunk + 1);
+          if (seq_begin < seq_end) func(seq_begin, seq_end);
+        }
+      });
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -12,11 +12,14 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <cmath>
+#include <cstring>
 #include <string>
 
 #include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/sequence_parallel.h"
 #include "paddle/fluid/operators/math/sequence_pooling.h"
 
 namespace paddle {
@@ -25,12 +28,6 @@ namespace math {
 
 using Tensor = framework::Tensor;
 using LoDTensor = framework::LoDTensor;
-template <typename T, int MajorType = Eigen::RowMajor,
-          typename IndexType = Eigen::DenseIndex>
-using EigenVector = framework::EigenVector<T, MajorType, IndexType>;
-template <typename T, int MajorType = Eigen::RowMajor,
-          typename IndexType = Eigen::DenseIndex>
-using EigenMatrix = framework::EigenMatrix<T, MajorType, IndexType>;
 
 template <typename T, bool is_test>
 class MaxSeqPoolFunctor {
@@ -53,34 +50,38 @@ class MaxSeqPoolFunctor {
                       "The dimension of index and output shall be same.");
 
     auto lod_level = input.lod().size();
-    auto starts = input.lod()[lod_level - 1];
+    const auto& lod = input.lod()[lod_level - 1];
+    const size_t* starts = lod.data();
     const T* in_data = input.data<T>();
     T* out_data = output->data<T>();
     int* max_index = index->data<int>();
 
     int64_t num_seq = out_dims[0];
     int64_t dim = output->numel() / num_seq;
-    for (int64_t i = 0; i < num_seq; ++i) {
-      if (starts[i] == starts[i + 1]) {
-        for (int64_t k = 0; k < dim; ++k) {
-          out_data[i * dim + k] = pad_value;
-          max_index[i * dim + k] = -1;
+    ParallelForSequences(context, lod, dim, [&](int64_t seq_begin,
+                                                int64_t seq_end) {
+      for (int64_t i = seq_begin; i < seq_end; ++i) {
+        if (starts[i] == starts[i + 1]) {
+          for (int64_t k = 0; k < dim; ++k) {
+            out_data[i * dim + k] = pad_value;
+            max_index[i * dim + k] = -1;
+          }
+          continue;
         }
-        continue;
-      }
-      for (int64_t k = 0; k < dim; ++k) {
-        out_data[i * dim + k] = in_data[starts[i] * dim + k];
-        max_index[i * dim + k] = starts[i];
-      }
-      for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
         for (int64_t k = 0; k < dim; ++k) {
-          if (in_data[j * dim + k] > out_data[i * dim + k]) {
-            out_data[i * dim + k] = in_data[j * dim + k];
-            max_index[i * dim + k] = j;
+          out_data[i * dim + k] = in_data[starts[i] * dim + k];
+          max_index[i * dim + k] = starts[i];
+        }
+        for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
+          for (int64_t k = 0; k < dim; ++k) {
+            if (in_data[j * dim + k] > out_data[i * dim + k]) {
+              out_data[i * dim + k] = in_data[j * dim + k];
+              max_index[i * dim + k] = j;
+            }
           }
         }
       }
-    }
+    });
   }
 };
 // Instantisation of Max Sequence Pooling for test phase eg. no need to fill
@@ -103,29 +104,33 @@ class MaxSeqPoolFunctor<T, true> {
     }
 
     auto lod_level = input.lod().size();
-    auto starts = input.lod()[lod_level - 1];
+    const auto& lod = input.lod()[lod_level - 1];
+    const size_t* starts = lod.data();
     const T* in_data = input.data<T>();
     T* out_data = output->data<T>();
 
     int64_t num_seq = out_dims[0];
     int64_t dim = output->numel() / num_seq;
-    for (int64_t i = 0; i < num_seq; ++i) {
-      if (starts[i] == starts[i + 1]) {
-        for (int64_t k = 0; k < dim; ++k) {
-          out_data[i * dim + k] = pad_value;
+    ParallelForSequences(context, lod, dim, [&](int64_t seq_begin,
+                                                int64_t seq_end) {
+      for (int64_t i = seq_begin; i < seq_end; ++i) {
+        if (starts[i] == starts[i + 1]) {
+          for (int64_t k = 0; k < dim; ++k) {
+            out_data[i * dim + k] = pad_value;
+          }
+          continue;
         }
-        continue;
-      }
-      std::memcpy(&out_data[i * dim], &in_data[starts[i] * dim],
-                  dim * sizeof(T));
-      for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
-        for (int64_t k = 0; k < dim; ++k) {
-          if (in_data[j * dim + k] > out_data[i * dim + k]) {
-            out_data[i * dim + k] = in_data[j * dim + k];
+        std::memcpy(&out_data[i * dim], &in_data[starts[i] * dim],
+                    dim * sizeof(T));
+        for (size_t j = starts[i] + 1; j < starts[i + 1]; ++j) {
+          for (int64_t k = 0; k < dim; ++k) {
+            if (in_data[j * dim + k] > out_data[i * dim + k]) {
+              out_data[i * dim + k] = in_data[j * dim + k];
+            }
           }
         }
       }
-    }
+    });
   }
 };
 template <typename T>
@@ -154,17 +159,24 @@ class MaxSeqPoolGradFunctor {
     const int* max_index = index.data<int>();
     T* ig_data = in_grad->data<T>();
 
-    SetConstant<platform::CPUDeviceContext, T> set_zero;
-    set_zero(context, in_grad, static_cast<T>(0.0));
+    auto lod_level = in_grad->lod().size();
+    const auto& lod = in_grad->lod()[lod_level - 1];
+    const size_t* starts = lod.data();
     int64_t num_seq = og_dims[0];
     int64_t dim = out_grad.numel() / num_seq;
-    for (int64_t i = 0; i < num_seq; ++i) {
-      for (int64_t j = 0; j < dim; ++j) {
-        int step_id = max_index[i * dim + j];
-        if (step_id == -1) continue;
-        ig_data[step_id * dim + j] = og_data[i * dim + j];
+    ParallelForSequences(context, lod, dim, [&](int64_t seq_begin,
+                                                int64_t seq_end) {
+      // Every chunk clears the rows of its own sequences.
+      std::memset(ig_data + starts[seq_begin] * dim, 0,
+                  (starts[seq_end] - starts[seq_begin]) * dim * sizeof(T));
+      for (int64_t i = seq_begin; i < seq_end; ++i) {
+        for (int64_t j = 0; j < dim; ++j) {
+          int step_id = max_index[i * dim + j];
+          if (step_id == -1) continue;
+          ig_data[step_id * dim + j] = og_data[i * dim + j];
+        }
       }
-    }
+    });
   }
 };
 
@@ -181,23 +193,23 @@ class LastSeqPoolFunctor {
     // Calculate the size of each item in sequence
     int64_t item_size = input.numel() / input.dims()[0];
     auto lod_level = input.lod().size();
-    auto lod = input.lod()[lod_level - 1];
-    int seq_num = static_cast<int>(lod.size()) - 1;
-    for (int i = 0; i < seq_num; ++i) {
-      // Calculate the length of each sequence
-      int64_t seq_len = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      if (seq_len == 0) {
-        for (int j = 0; j < item_size; ++j) {
-          out_data[j] = pad_value;
+    const auto& lod = input.lod()[lod_level - 1];
+    const size_t* starts = lod.data();
+    ParallelForSequences(context, lod, item_size, [&](int64_t seq_begin,
+                                                      int64_t seq_end) {
+      for (int64_t i = seq_begin; i < seq_end; ++i) {
+        T* out_pos = out_data + i * item_size;
+        if (starts[i] == starts[i + 1]) {
+          for (int j = 0; j < item_size; ++j) {
+            out_pos[j] = pad_value;
+          }
+        } else {
+          // Copy the last item of sequence to output
+          std::memcpy(out_pos, in_data + (starts[i + 1] - 1) * item_size,
+                      item_size * sizeof(T));
         }
-      } else {
-        // Point to the begin of next sequence
-        in_data += seq_len * item_size;
-        // Copy the last item of sequence to output
-        std::memcpy(out_data, (in_data - item_size), item_size * sizeof(T));
       }
-      out_data += item_size;
-    }
+    });
   }
 };
 
@@ -214,23 +226,23 @@ class FirstSeqPoolFunctor {
     // Calculate the size of each item in sequence
     int64_t item_size = input.numel() / input.dims()[0];
     auto lod_level = input.lod().size();
-    auto lod = input.lod()[lod_level - 1];
-    int seq_num = static_cast<int>(lod.size()) - 1;
-    for (int i = 0; i < seq_num; ++i) {
-      // Calculate the length of each sequence
-      int64_t seq_len = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      if (seq_len == 0) {
-        for (int j = 0; j < item_size; ++j) {
-          out_data[j] = pad_value;
+    const auto& lod = input.lod()[lod_level - 1];
+    const size_t* starts = lod.data();
+    ParallelForSequences(context, lod, item_size, [&](int64_t seq_begin,
+                                                      int64_t seq_end) {
+      for (int64_t i = seq_begin; i < seq_end; ++i) {
+        T* out_pos = out_data + i * item_size;
+        if (starts[i] == starts[i + 1]) {
+          for (int j = 0; j < item_size; ++j) {
+            out_pos[j] = pad_value;
+          }
+        } else {
+          // Copy the first item of sequence to output
+          std::memcpy(out_pos, in_data + starts[i] * item_size,
+                      item_size * sizeof(T));
         }
-      } else {
-        // Copy the first item of sequence to output
-        std::memcpy(out_data, in_data, item_size * sizeof(T));
-        // Point to the next sequence
-        in_data += seq_len * item_size;
       }
-      out_data += item_size;
-    }
+    });
   }
 };
 
@@ -241,7 +253,8 @@ class SumSeqPoolGradFunctor {
                   const framework::LoDTensor& out_grad,
                   framework::LoDTensor* in_grad) {
     auto lod_level = in_grad->lod().size();
-    auto lod = in_grad->lod()[lod_level - 1];
+    const auto& lod = in_grad->lod()[lod_level - 1];
+    const size_t* starts = lod.data();
     int64_t out_w = out_grad.numel() / out_grad.dims()[0];
     int64_t in_w = in_grad->numel() / in_grad->dims()[0];
     PADDLE_ENFORCE_EQ(
@@ -250,16 +263,19 @@ class SumSeqPoolGradFunctor {
     const T* out_g_data = out_grad.data<T>();
     T* in_g_data = in_grad->mutable_data<T>(context.GetPlace());
     auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
-    for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
-      int64_t h = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      if (h == 0) continue;
-      int64_t in_offset = lod[i] * in_w;
-      const T* out_pos = out_g_data + i * out_w;
-      T* in_pos = in_g_data + in_offset;
-      for (int r = 0; r != h; ++r) {
-        blas.VCOPY(in_w, out_pos, in_pos + r * in_w);
+    ParallelForSequences(context, lod, in_w, [&](int64_t seq_begin,
+                                                 int64_t seq_end) {
+      for (int64_t i = seq_begin; i < seq_end; ++i) {
+        int64_t h = static_cast<int64_t>(starts[i + 1] - starts[i]);
+        if (h == 0) continue;
+        int64_t in_offset = starts[i] * in_w;
+        const T* out_pos = out_g_data + i * out_w;
+        T* in_pos = in_g_data + in_offset;
+        for (int r = 0; r != h; ++r) {
+          blas.VCOPY(in_w, out_pos, in_pos + r * in_w);
+        }
       }
-    }
+    });
   }
 };
 
@@ -292,59 +308,54 @@ class SequencePoolFunctor<platform::CPUDeviceContext, T> {
       first_pool(context, input, pad_value, output);
       return;
     }
+    if (pooltype != "SUM" && pooltype != "AVERAGE" && pooltype != "SQRT") {
+      PADDLE_THROW("unsupported pooling pooltype");
+    }
+    auto place = context.GetPlace();
+    PADDLE_ENFORCE_EQ(platform::is_cpu_place(place), true,
+                      "Sequence_pool should run on CPU Device when pooltype is "
+                      "SUM, AVERAGE or SQRT");
     auto lod_level = input.lod().size();
-    auto lod = input.lod()[lod_level - 1];
-    if (pooltype == "SUM") {
-      auto place = context.GetPlace();
-      PADDLE_ENFORCE_EQ(
-          platform::is_cpu_place(place), true,
-          "Sequence_pool should run on CPU Device when pooltype is SUM");
-      const T* src = input.data<T>();
-      T* dst = output->mutable_data<T>(place);
-      jit::seq_pool_attr_t attr(
-          static_cast<int>(input.numel() / input.dims()[0]),
-          jit::SeqPoolType::kSum);
-      auto seqpool =
-          jit::KernelFuncs<jit::SeqPoolTuple<T>, platform::CPUPlace>::Cache()
-              .At(attr);
-      for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
-        attr.h = static_cast<int>(lod[i + 1] - lod[i]);
+    const auto& lod = input.lod()[lod_level - 1];
+    const size_t* starts = lod.data();
+    const T* src = input.data<T>();
+    T* dst = output->mutable_data<T>(place);
+    // The sum is done by the jit SeqPool kernel, AVERAGE and SQRT scale it
+    // afterwards. The jit code of kAvg and kSqrt keeps 1/h in a member of the
+    // shared kernel and can not run from several threads at once.
+    const jit::seq_pool_attr_t sum_attr(
+        static_cast<int>(input.numel() / input.dims()[0]),
+        jit::SeqPoolType::kSum);
+    const int w = sum_attr.w;
+    auto seqpool =
+        jit::KernelFuncs<jit::SeqPoolTuple<T>, platform::CPUPlace>::Cache().At(
+            sum_attr);
+    auto vscal =
+        jit::KernelFuncs<jit::VScalTuple<T>, platform::CPUPlace>::Cache().At(
+            w);
+    const bool is_avg = pooltype == "AVERAGE";
+    const bool is_sqrt = pooltype == "SQRT";
+    ParallelForSequences(context, lod, w, [&](int64_t seq_begin,
+                                              int64_t seq_end) {
+      jit::seq_pool_attr_t attr = sum_attr;
+      for (int64_t i = seq_begin; i < seq_end; ++i) {
+        T* out_pos = dst + i * w;
+        attr.h = static_cast<int>(starts[i + 1] - starts[i]);
         if (attr.h == 0) {
-          for (int j = 0; j < attr.w; ++j) {
-            dst[j] = pad_value;
+          for (int j = 0; j < w; ++j) {
+            out_pos[j] = pad_value;
           }
-        } else {
-          seqpool(src, dst, &attr);
+          continue;
         }
-        dst += attr.w;
-        src += attr.h * attr.w;
-      }
-      return;
-    }
-    auto& place = *context.eigen_device();
-    for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
-      Tensor out_t = output->Slice(i, i + 1);
-      int64_t w = input.numel() / input.dims()[0];
-      if (lod[i] == lod[i + 1]) {
-        for (int j = 0; j < w; ++j) {
-          out_t.data<T>()[j] = pad_value;
+        seqpool(src + starts[i] * w, out_pos, &attr);
+        if (is_avg || is_sqrt) {
+          T scale = static_cast<T>(1) /
+                    (is_avg ? static_cast<T>(attr.h)
+                            : std::sqrt(static_cast<T>(attr.h)));
+          vscal(&scale, out_pos, out_pos, w);
         }
-        continue;
       }
-      Tensor in_t =
-          input.Slice(static_cast<int>(lod[i]), static_cast<int>(lod[i + 1]));
-      int64_t h = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      auto in_e = EigenMatrix<T>::From(in_t, framework::make_ddim({h, w}));
-      auto out_e = EigenVector<T>::Flatten(out_t);
-      if (pooltype == "AVERAGE") {
-        out_e.device(place) = in_e.mean(Eigen::array<int, 1>({{0}}));
-      } else if (pooltype == "SQRT") {
-        out_e.device(place) = in_e.sum(Eigen::array<int, 1>({{0}})) /
-                              std::sqrt(static_cast<T>(h));
-      } else {
-        PADDLE_THROW("unsupported pooling pooltype");
-      }
-    }
+    });
   }
 };
 
@@ -363,46 +374,55 @@ class SequencePoolGradFunctor<platform::CPUDeviceContext, T> {
       return;
     }
 
-    if (pooltype == "LAST" || pooltype == "FIRST") {
-      // set X@Grad be zero at first when pooltype is LAST/FIRST
-      math::SetConstant<platform::CPUDeviceContext, T> functor;
-      functor(context, in_grad, 0);
-    }
-
     if (pooltype == "SUM") {
       math::SumSeqPoolGradFunctor<T> sum_pool_grad;
       sum_pool_grad(context, out_grad, in_grad);
       return;
     }
 
-    auto lod_level = in_grad->lod().size();
-    auto lod = in_grad->lod()[lod_level - 1];
-    auto& place = *context.eigen_device();
-    for (int i = 0; i < static_cast<int>(lod.size()) - 1; ++i) {
-      if (lod[i] == lod[i + 1]) continue;
-      auto in_g_t = in_grad->Slice(static_cast<int>(lod[i]),
-                                   static_cast<int>(lod[i + 1]));
-      auto out_g_t = out_grad.Slice(i, i + 1);
-      int64_t h = static_cast<int64_t>(lod[i + 1] - lod[i]);
-      int64_t w = in_grad->numel() / in_grad->dims()[0];
-      auto in_g_e = EigenMatrix<T>::From(in_g_t, {h, w});
-      auto out_g_e = EigenMatrix<T>::From(out_g_t, {1, w});
-      auto out_g_e_v = EigenVector<T>::Flatten(out_g_t);
-      Eigen::DSizes<int, 2> bcast(h, 1);
+    const bool is_avg = pooltype == "AVERAGE";
+    const bool is_sqrt = pooltype == "SQRT";
+    const bool is_last = pooltype == "LAST";
+    const bool is_first = pooltype == "FIRST";
+    if (!is_avg && !is_sqrt && !is_last && !is_first) {
+      PADDLE_THROW("unsupported pooling pooltype");
+    }
 
-      if (pooltype == "AVERAGE") {
-        in_g_e.device(place) = (out_g_e / static_cast<T>(h)).broadcast(bcast);
-      } else if (pooltype == "SQRT") {
-        in_g_e.device(place) =
-            (out_g_e / std::sqrt(static_cast<T>(h))).broadcast(bcast);
-      } else if (pooltype == "LAST") {
-        in_g_e.chip(h - 1, 0).device(place) = out_g_e_v;
-      } else if (pooltype == "FIRST") {
-        in_g_e.chip(0, 0).device(place) = out_g_e_v;
-      } else {
-        PADDLE_THROW("unsupported pooling pooltype");
+    auto lod_level = in_grad->lod().size();
+    const auto& lod = in_grad->lod()[lod_level - 1];
+    const size_t* starts = lod.data();
+    int64_t w = in_grad->numel() / in_grad->dims()[0];
+    const T* og_data = out_grad.data<T>();
+    T* ig_data = in_grad->mutable_data<T>(context.GetPlace());
+    auto vscal =
+        jit::KernelFuncs<jit::VScalTuple<T>, platform::CPUPlace>::Cache().At(
+            static_cast<int>(w));
+    ParallelForSequences(context, lod, w, [&](int64_t seq_begin,
+                                              int64_t seq_end) {
+      if (is_last || is_first) {
+        // X@Grad is zero except the selected step when pooltype is
+        // LAST/FIRST, every chunk clears the rows of its own sequences.
+        std::memset(ig_data + starts[seq_begin] * w, 0,
+                    (starts[seq_end] - starts[seq_begin]) * w * sizeof(T));
       }
-    }
+      for (int64_t i = seq_begin; i < seq_end; ++i) {
+        int64_t h = static_cast<int64_t>(starts[i + 1] - starts[i]);
+        if (h == 0) continue;
+        const T* og_pos = og_data + i * w;
+        if (is_last || is_first) {
+          size_t row = is_last ? starts[i + 1] - 1 : starts[i];
+          std::memcpy(ig_data + row * w, og_pos, w * sizeof(T));
+          continue;
+        }
+        T scale =
+            static_cast<T>(1) / (is_avg ? static_cast<T>(h)
+                                        : std::sqrt(static_cast<T>(h)));
+        for (int64_t r = 0; r < h; ++r) {
+          vscal(&scale, og_pos, ig_data + (starts[i] + r) * w,
+                static_cast<int>(w));
+        }
+      }
+    });
   }
 };
 
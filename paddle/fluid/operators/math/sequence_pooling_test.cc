@@ -14,7 +14,11 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/sequence_pooling.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
 #include <vector>
+#include "paddle/fluid/platform/cpu_helper.h"
 
 template <typename DeviceContext, typename Place, typename T>
 void TestSequencePoolingSum(const paddle::framework::LoD& lod) {
@@ -111,6 +115,127 @@ TEST(SequencePoolingGrad, CPU_SUM) {
                          paddle::platform::CPUPlace, float>(lod2);
 }
 
+// Many short sequences, some of them empty, pooled by several threads.
+TEST(SequencePooling, CPU_ParallelAllTypes) {
+  const int64_t width = 64;
+  std::vector<size_t> offsets({0});
+  for (size_t i = 0; i < 2000; ++i) {
+    offsets.push_back(offsets.back() + i % 7);
+  }
+  paddle::framework::LoD lod({offsets});
+  const int64_t num_seqs = offsets.size() - 1;
+  const int64_t num_rows = offsets.back();
+
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  paddle::framework::LoDTensor input;
+  input.set_lod(lod);
+  float* in_data = input.mutable_data<float>(
+      paddle::framework::make_ddim({num_rows, width}), place);
+  for (int64_t i = 0; i < input.numel(); ++i) {
+    in_data[i] = static_cast<float>((i * 37) % 101) / 10.f;
+  }
+
+  const float pad_value = -1.f;
+  paddle::platform::SetNumThreads(4);
+  for (std::string pooltype :
+       {"SUM", "AVERAGE", "SQRT", "MAX", "LAST", "FIRST"}) {
+    paddle::framework::LoDTensor output;
+    output.mutable_data<float>(paddle::framework::make_ddim({num_seqs, width}),
+                               place);
+    paddle::framework::Tensor index;
+    index.mutable_data<int>(paddle::framework::make_ddim({num_seqs, width}),
+                            place);
+    paddle::operators::math::SequencePoolFunctor<
+        paddle::platform::CPUDeviceContext, float>()(
+        context, pooltype, pad_value, input, &output, false, &index);
+
+    for (int64_t i = 0; i < num_seqs; ++i) {
+      int64_t h = offsets[i + 1] - offsets[i];
+      for (int64_t k = 0; k < width; ++k) {
+        float expected = pad_value;
+        if (h > 0) {
+          const float* col = in_data + offsets[i] * width + k;
+          float sum = 0.f, max = col[0];
+          for (int64_t r = 0; r < h; ++r) {
+            sum += col[r * width];
+            max = std::max(max, col[r * width]);
+          }
+          if (pooltype == "SUM") expected = sum;
+          if (pooltype == "AVERAGE") expected = sum / h;
+          if (pooltype == "SQRT") expected = sum / std::sqrt(h);
+          if (pooltype == "MAX") expected = max;
+          if (pooltype == "LAST") expected = col[(h - 1) * width];
+          if (pooltype == "FIRST") expected = col[0];
+        }
+        EXPECT_NEAR(output.data<float>()[i * width + k], expected, 1e-4)
+            << pooltype << " sequence " << i;
+      }
+    }
+  }
+  paddle::platform::SetNumThreads(1);
+}
+
+// The backward pass on several threads writes the same gradients as on the
+// calling thread, every row included.
+TEST(SequencePoolingGrad, CPU_ParallelMatchesSerial) {
+  const int64_t width = 64;
+  std::vector<size_t> offsets({0});
+  for (size_t i = 0; i < 2000; ++i) {
+    offsets.push_back(offsets.back() + i % 7);
+  }
+  paddle::framework::LoD lod({offsets});
+  const int64_t num_seqs = offsets.size() - 1;
+  const int64_t num_rows = offsets.back();
+
+  paddle::platform::CPUPlace place;
+  paddle::platform::CPUDeviceContext context(place);
+  paddle::framework::LoDTensor input;
+  input.set_lod(lod);
+  float* in_data = input.mutable_data<float>(
+      paddle::framework::make_ddim({num_rows, width}), place);
+  for (int64_t i = 0; i < input.numel(); ++i) {
+    in_data[i] = static_cast<float>((i * 37) % 101) / 10.f;
+  }
+  paddle::framework::LoDTensor out_grad;
+  float* out_grad_data = out_grad.mutable_data<float>(
+      paddle::framework::make_ddim({num_seqs, width}), place);
+  for (int64_t i = 0; i < out_grad.numel(); ++i) {
+    out_grad_data[i] = static_cast<float>((i * 13) % 29) / 7.f;
+  }
+
+  for (std::string pooltype :
+       {"SUM", "AVERAGE", "SQRT", "MAX", "LAST", "FIRST"}) {
+    paddle::framework::LoDTensor output;
+    output.mutable_data<float>(paddle::framework::make_ddim({num_seqs, width}),
+                               place);
+    paddle::framework::Tensor index;
+    index.mutable_data<int>(paddle::framework::make_ddim({num_seqs, width}),
+                            place);
+    paddle::operators::math::SequencePoolFunctor<
+        paddle::platform::CPUDeviceContext, float>()(
+        context, pooltype, 0.f, input, &output, false, &index);
+
+    paddle::framework::LoDTensor in_grads[2];
+    for (int k = 0; k < 2; ++k) {
+      paddle::platform::SetNumThreads(k == 0 ? 1 : 4);
+      auto& in_grad = in_grads[k];
+      in_grad.set_lod(lod);
+      float* in_grad_data = in_grad.mutable_data<float>(
+          paddle::framework::make_ddim({num_rows, width}), place);
+      std::fill(in_grad_data, in_grad_data + in_grad.numel(), 7.f);
+      paddle::operators::math::SequencePoolGradFunctor<
+          paddle::platform::CPUDeviceContext, float>()(
+          context, pooltype, out_grad, &in_grad, &index);
+    }
+    paddle::platform::SetNumThreads(1);
+    for (int64_t i = 0; i < in_grads[0].numel(); ++i) {
+      ASSERT_EQ(in_grads[0].data<float>()[i], in_grads[1].data<float>()[i])
+          << pooltype << " element " << i;
+    }
+  }
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(SequencePoolingGrad, CUDA_SUM) {
   paddle::framework::LoD lod1;
@@ -18,6 +18,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/packed_weight_cache.h"
 
 namespace paddle {
 namespace operators {
@@ -61,6 +62,29 @@ class MatMulKernel : public framework::OpKernel<T> {
         ColumnMatrixFromVector(y.dims()), 0, context.Attr<bool>("transpose_Y"));
     auto scale = static_cast<T>(context.Attr<float>("alpha"));
 
+    // Multiply by the packed weight if Y is a registered 2-D weight.
+    bool use_packed_y = y.dims().size() == 2 && !mat_dim_a.trans_ &&
+                        !mat_dim_b.trans_ &&
+                        mat_dim_a.width_ == mat_dim_b.height_ &&
+                        scale == static_cast<T>(1);
+#if defined(PADDLE_WITH_MKLML) && !defined(PADDLE_WITH_CUDA)
+    // The multi-head product is not a plain GEMM.
+    use_packed_y = use_packed_y && context.Attr<int>("head_number") <= 1;
+#endif
+    if (use_packed_y) {
+      auto &dev_ctx = context.template device_context<DeviceContext>();
+      const int M =
+          mat_dim_a.height_ * std::max<int64_t>(mat_dim_a.batch_size_, 1);
+      const int N = mat_dim_b.width_;
+      const int K = mat_dim_b.height_;
+      const T *packed_y = math::GetPackedWeight<T>(dev_ctx, y, N, K);
+      if (packed_y != nullptr) {
+        math::PackedGEMM<T>(dev_ctx, M, N, K, x.data<T>(), K, packed_y,
+                            static_cast<T>(0), out->data<T>(), N);
+        return;
+      }
+    }
+
 #if defined(PADDLE_WITH_MKLML) && !defined(PADDLE_WITH_CUDA)
     int head_number = context.Attr<int>("head_number");
     bool split_vertical_y = (mat_dim_a.width_ != mat_dim_b.height_);
@@ -0,0 +1,74 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/packed_weight_cache.h"
+
+USE_OP(matmul);
+
+TEST(MatMulOp, PackedWeightWithHeads) {
+  const int M = 2, K = 4, N = 3;
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  auto* x = scope.Var("x")->GetMutable<paddle::framework::LoDTensor>();
+  x->Resize({M, K});
+  float* x_data = x->mutable_data<float>(place);
+  for (int i = 0; i < M * K; ++i) {
+    x_data[i] = static_cast<float>(i) - 3;
+  }
+  auto* y = scope.Var("y")->GetMutable<paddle::framework::LoDTensor>();
+  y->Resize({K, N});
+  float* y_data = y->mutable_data<float>(place);
+  for (int i = 0; i < K * N; ++i) {
+    y_data[i] = static_cast<float>(i) / 10;
+  }
+  scope.Var("out")->GetMutable<paddle::framework::LoDTensor>();
+
+  auto& cache = paddle::operators::math::PackedWeightCache::Instance();
+  cache.Clear();
+  cache.AddWeight(*y);
+
+  paddle::framework::AttributeMap attrs;
+  int head_number = 1;
+#if defined(PADDLE_WITH_MKLML) && !defined(PADDLE_WITH_CUDA)
+  head_number = 2;
+  attrs.insert({"head_number", head_number});
+#endif
+  auto op = paddle::framework::OpRegistry::CreateOp(
+      "matmul", {{"X", {"x"}}, {"Y", {"y"}}}, {{"Out", {"out"}}}, attrs);
+  op->Run(scope, place);
+
+  // Head h multiplies the h-th column block of X by the h-th row block of Y
+  // into the h-th column block of Out.
+  const int sub_k = K / head_number;
+  const int out_width = N * head_number;
+  auto& out = scope.FindVar("out")->Get<paddle::framework::LoDTensor>();
+  ASSERT_EQ(out.dims(), paddle::framework::make_ddim({M, out_width}));
+  const float* out_data = out.data<float>();
+  for (int h = 0; h < head_number; ++h) {
+    for (int i = 0; i < M; ++i) {
+      for (int j = 0; j < N; ++j) {
+        float expected = 0;
+        for (int k = h * sub_k; k < (h + 1) * sub_k; ++k) {
+          expected += x_data[i * K + k] * y_data[k * N + j];
+        }
+        EXPECT_NEAR(out_data[i * out_width + h * N + j], expected, 1e-5);
+      }
+    }
+  }
+  cache.Clear();
+}
@@ -18,6 +18,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/math_function.h"
+#include "paddle/fluid/operators/math/packed_weight_cache.h"
 
 namespace paddle {
 namespace operators {
@@ -50,9 +51,18 @@ class MulKernel : public framework::OpKernel<T> {
       z->Resize({x_matrix.dims()[0], y_matrix.dims()[1]});
     }
 
-    auto blas = math::GetBlas<DeviceContext, T>(context);
-
-    blas.MatMul(x_matrix, y_matrix, z);
+    auto& dev_ctx = context.template device_context<DeviceContext>();
+    const int M = x_matrix.dims()[0];
+    const int N = y_matrix.dims()[1];
+    const int K = y_matrix.dims()[0];
+    const T* packed_y = math::GetPackedWeight<T>(dev_ctx, y_matrix, N, K);
+    if (packed_y != nullptr) {
+      math::PackedGEMM<T>(dev_ctx, M, N, K, x_matrix.data<T>(), K, packed_y,
+                          static_cast<T>(0), z->data<T>(), N);
+    } else {
+      auto blas = math::GetBlas<DeviceContext, T>(dev_ctx);
+      blas.MatMul(x_matrix, y_matrix, z);
+    }
     if (z_dim.size() != 2) {
       z->Resize(z_dim);
     }
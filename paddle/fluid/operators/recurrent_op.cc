@@ -15,6 +15,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/recurrent_op.h"
 
 #include <algorithm>
+#include <utility>
 #include "paddle/fluid/string/string_helper.h"
 
 namespace paddle {
@@ -42,33 +43,38 @@ const char RecurrentBase::kInitStateGrads[] = "initial_states" GRAD_SUFFIX;
 
 static void ClearStepScopes(const platform::DeviceContext &dev_ctx,
                             framework::Scope *parent_scope,
-                            StepScopeVar *step_scopes) {
+                            StepScopeVar *step_scopes,
+                            framework::StepScopePool::LoopScopes *scope_pool) {
   if (step_scopes->empty()) return;
 
   dev_ctx.Wait();
 
   for (auto *sub_scope : *step_scopes) {
-    parent_scope->DeleteScope(sub_scope);
+    scope_pool->DeleteScope(*parent_scope, sub_scope);
   }
 
   step_scopes->clear();
 }
 
-StepScopes::StepScopes(const platform::DeviceContext &dev_ctx,
-                       const framework::Scope &parent, StepScopeVar *scopes,
-                       bool is_train, size_t seq_len, bool is_backward)
+StepScopes::StepScopes(
+    const platform::DeviceContext &dev_ctx, const framework::Scope &parent,
+    StepScopeVar *scopes,
+    std::shared_ptr<framework::StepScopePool::LoopScopes> scope_pool,
+    bool is_train, size_t seq_len, bool is_backward)
     : counter_(is_backward ? seq_len - 1 : 0UL),
       scopes_(scopes),
+      scope_pool_(std::move(scope_pool)),
       is_train_(is_train),
       is_backward_(is_backward) {
   size_t num_step_scopes = is_train ? seq_len : 2;
   PADDLE_ENFORCE_EQ(is_train || !is_backward, true,
                     "Cannot backward when is not training");
   if (!is_backward_) {
-    ClearStepScopes(dev_ctx, const_cast<framework::Scope *>(&parent), scopes);
+    ClearStepScopes(dev_ctx, const_cast<framework::Scope *>(&parent), scopes,
+                    scope_pool_.get());
     scopes->reserve(static_cast<size_t>(num_step_scopes));
     for (size_t i = 0; i < num_step_scopes; ++i) {
-      scopes->emplace_back(&parent.NewScope());
+      scopes->emplace_back(&scope_pool_->NewScope(parent));
     }
   }
 }
@@ -85,7 +91,7 @@ void StepScopes::BackwardNext(const platform::DeviceContext &dev_ctx,
   PADDLE_ENFORCE_EQ(is_backward_, true,
                     "Cannot get backward next scope when is forward");
   if (counter_ + 2 == scopes_->size()) {
-    parent_scope->DeleteScope((*scopes_)[counter_ + 1]);
+    scope_pool_->DeleteScope(*parent_scope, (*scopes_)[counter_ + 1]);
     scopes_->pop_back();
     VLOG(3) << "Deleted scope at " << counter_ + 1;
   }
@@ -136,6 +142,13 @@ int64_t RecurrentBase::GetSequenceLength(const framework::Scope &scope) const {
   return seq_len;
 }
 
+std::shared_ptr<framework::StepScopePool::LoopScopes>
+RecurrentBase::GetStepScopesPool(const std::string &step_scopes_name) const {
+  return framework::StepScopePool::Instance().Get(framework::StepScopePool::Key(
+      Attr<framework::BlockDesc *>(kStepBlock)->Program()->Id(),
+      step_scopes_name));
+}
+
 // for src_tensor, dst_tensor in zip(map(src_scope.FindVar, src_vars),
 //                                   map(dst_scope.Var, dst_vars)):
 //   dst_tensor.ShareDataWith(src_tensor)
@@ -260,6 +273,7 @@ StepScopes RecurrentOp::CreateStepScopes(const platform::DeviceContext &dev_ctx,
   auto *var = scope.FindVar(Output(kStepScopes));
   PADDLE_ENFORCE_NOT_NULL(var);
   return StepScopes(dev_ctx, scope, var->GetMutable<StepScopeVar>(),
+                    GetStepScopesPool(Output(kStepScopes)),
                     Attr<bool>(kIsTrain), seq_len);
 }
 
@@ -461,7 +475,8 @@ void RecurrentGradOp::RunImpl(const framework::Scope &scope,
   auto *var = scope.FindVar(Input(kStepScopes));
   PADDLE_ENFORCE_NOT_NULL(var);
   auto *step_scopes = var->GetMutable<StepScopeVar>();
-  ClearStepScopes(dev_ctx, const_cast<framework::Scope *>(&scope), step_scopes);
+  ClearStepScopes(dev_ctx, const_cast<framework::Scope *>(&scope), step_scopes,
+                  GetStepScopesPool(Input(kStepScopes)).get());
 }
 
 StepScopes RecurrentGradOp::CreateStepScopes(
@@ -470,6 +485,7 @@ StepScopes RecurrentGradOp::CreateStepScopes(
   auto *var = scope.FindVar(Input(kStepScopes));
   PADDLE_ENFORCE_NOT_NULL(var);
   return StepScopes(dev_ctx, scope, var->GetMutable<StepScopeVar>(),
+                    GetStepScopesPool(Input(kStepScopes)),
                     Attr<bool>(kIsTrain), seq_len, true /*is_backward*/);
 }
 
@@ -21,6 +21,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/scope_pool.h"
 
 namespace paddle {
 namespace operators {
@@ -38,10 +39,13 @@ namespace operators {
 //   access scopes from beginning to end
 class StepScopes {
  public:
+  // The step scopes are taken from and returned to scope_pool, see
+  // framework::StepScopePool.
   StepScopes(const platform::DeviceContext &dev_ctx,
              const framework::Scope &parent,
-             std::vector<framework::Scope *> *scopes, bool is_train,
-             size_t seq_len, bool is_backward = false);
+             std::vector<framework::Scope *> *scopes,
+             std::shared_ptr<framework::StepScopePool::LoopScopes> scope_pool,
+             bool is_train, size_t seq_len, bool is_backward = false);
 
   // Get the current scope
   framework::Scope &CurScope();
@@ -62,6 +66,7 @@ class StepScopes {
 
   size_t counter_;
   std::vector<framework::Scope *> *scopes_;
+  std::shared_ptr<framework::StepScopePool::LoopScopes> scope_pool_;
   bool is_train_;
   bool is_backward_;
 };
@@ -100,6 +105,11 @@ class RecurrentBase : public framework::OperatorBase {
   //   nested sequence length.
   int64_t GetSequenceLength(const framework::Scope &scope) const;
 
+  // The step scopes in framework::StepScopePool, shared by the forward and
+  // backward op of one RNN.
+  std::shared_ptr<framework::StepScopePool::LoopScopes> GetStepScopesPool(
+      const std::string &step_scopes_name) const;
+
   // for src_tensor, dst_tensor in zip(map(src_scope.FindVar, src_vars),
   //                                   map(dst_scope.Var, dst_vars)):
   //   dst_tensor.ShareDataWith(src_tensor)
@@ -15,6 +15,7 @@ limitations under the License. */
 #pragma once
 
 #include <algorithm>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -46,11 +47,11 @@ class ReduceKernel : public framework::OpKernel<T> {
       // Flatten and reduce 1-D tensor
       auto x = EigenVector<T>::Flatten(*input);
       auto out = EigenScalar<T>::From(*output);
-      auto& place =
-          *context.template device_context<DeviceContext>().eigen_device();
       auto reduce_dim = Eigen::array<int, 1>({{0}});
       Functor functor;
-      functor(place, &x, &out, reduce_dim);
+      platform::VisitEigenDevice(
+          context.template device_context<DeviceContext>(),
+          std::bind(functor, std::placeholders::_1, &x, &out, reduce_dim));
     } else {
       int ndim = input->dims().size();
       int rdim = dims.size();
@@ -109,13 +110,13 @@ class ReduceGradKernel : public framework::OpKernel<T> {
       auto x_reduce = EigenVector<T>::From(*input1);
       auto x_reduce_grad = EigenVector<T>::From(*input2);
       auto x_grad = EigenVector<T>::Flatten(*output);
-      auto& place =
-          *context.template device_context<DeviceContext>().eigen_device();
       auto broadcast_dim =
           Eigen::array<int, 1>({{static_cast<int>(input0->numel())}});
       Functor functor;
-      functor(place, &x, &x_reduce, &x_grad, &x_reduce_grad, broadcast_dim,
-              broadcast_dim[0]);
+      platform::VisitEigenDevice(
+          context.template device_context<DeviceContext>(),
+          std::bind(functor, std::placeholders::_1, &x, &x_reduce, &x_grad,
+                    &x_reduce_grad, broadcast_dim, broadcast_dim[0]));
     } else {
       int rank = input0->dims().size();
       switch (rank) {
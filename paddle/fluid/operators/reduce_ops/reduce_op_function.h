@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #pragma once
+#include <functional>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
@@ -57,15 +58,18 @@ void ReduceFunctor(const DeviceContext& context, const framework::Tensor& input,
                       dims_vector.end());
     out_dims = framework::make_ddim(dims_vector);
   }
-  auto& place = *context.eigen_device();
   Functor functor;
 
   if (D == 1) {
     auto out = EigenScalar<T>::From(*output);
-    functor(place, &x, &out, reduce_dim);
+    platform::VisitEigenDevice(
+        context,
+        std::bind(functor, std::placeholders::_1, &x, &out, reduce_dim));
   } else {
     auto out = EigenTensor<T, (D - R_D)>::From(*output, out_dims);
-    functor(place, &x, &out, reduce_dim);
+    platform::VisitEigenDevice(
+        context,
+        std::bind(functor, std::placeholders::_1, &x, &out, reduce_dim));
   }
 }
 
@@ -98,11 +102,10 @@ void ReduceGradFunctor(const DeviceContext& context,
   auto x_reduce = EigenTensor<T, D>::From(input1, reduced_dims);
   auto x_reduce_grad = EigenTensor<T, D>::From(input2, reduced_dims);
 
-  auto& place = *context.eigen_device();
-
   Functor functor;
-  functor(place, &x, &x_reduce, &x_grad, &x_reduce_grad, broadcast_dim,
-          broad_cats_times);
+  platform::VisitEigenDevice(
+      context, std::bind(functor, std::placeholders::_1, &x, &x_reduce, &x_grad,
+                         &x_reduce_grad, broadcast_dim, broad_cats_times));
 }
 
 }  // namespace operators
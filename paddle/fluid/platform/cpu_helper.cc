@@ -27,7 +27,12 @@ limitations under the License. */
 namespace paddle {
 namespace platform {
 
+// The intra-op thread budget is kept per thread, so that predictors and
+// executors running on different threads can use different budgets.
+static thread_local int intra_op_num_threads = 1;
+
 void SetNumThreads(int num_threads) {
+  intra_op_num_threads = num_threads > 1 ? num_threads : 1;
 #ifdef PADDLE_USE_OPENBLAS
 // windows has no support for openblas multi-thread
 // please refer to: https://github.com/PaddlePaddle/Paddle/issues/7234
@@ -47,5 +52,7 @@ void SetNumThreads(int num_threads) {
 #endif
 }
 
+int GetNumThreads() { return intra_op_num_threads; }
+
 }  // namespace platform
 }  // namespace paddle
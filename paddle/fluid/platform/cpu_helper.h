@@ -22,5 +22,9 @@ namespace platform {
 //! Set the number of threads in use.
 void SetNumThreads(int num_threads);
 
+//! Get the intra-op thread budget of the calling thread, i.e. the value of
+//! the last SetNumThreads called on this thread.
+int GetNumThreads();
+
 }  // namespace platform
 }  // namespace paddle
@@ -20,3 +20,10 @@ TEST(CpuHelper, SetNumThread) {
   paddle::platform::SetNumThreads(1);
   paddle::platform::SetNumThreads(4);
 }
+
+TEST(CpuHelper, GetNumThread) {
+  paddle::platform::SetNumThreads(4);
+  EXPECT_EQ(paddle::platform::GetNumThreads(), 4);
+  paddle::platform::SetNumThreads(0);
+  EXPECT_EQ(paddle::platform::GetNumThreads(), 1);
+}
@@ -16,6 +16,7 @@ limitations under the License. */
 #include <vector>
 
 #include "paddle/fluid/memory/memory.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/framework/rw_lock.h"
 #include "paddle/fluid/memory/allocation/cuda_device_context_allocator.h"
@@ -129,6 +130,43 @@ Eigen::DefaultDevice* CPUDeviceContext::eigen_device() const {
   return eigen_device_.get();
 }
 
+namespace {
+struct EigenThreadPoolDevice {
+  explicit EigenThreadPoolDevice(int num_threads)
+      : pool_(num_threads), device_(&pool_, num_threads) {}
+
+  Eigen::ThreadPool pool_;
+  Eigen::ThreadPoolDevice device_;
+};
+
+Eigen::ThreadPoolDevice* GetEigenThreadPoolDevice(int num_threads) {
+  static std::mutex mtx;
+  static std::map<int, std::unique_ptr<EigenThreadPoolDevice>> devices;
+  std::lock_guard<std::mutex> guard(mtx);
+  auto& device = devices[num_threads];
+  if (device == nullptr) {
+    VLOG(3) << "Create eigen thread pool with " << num_threads << " threads";
+    device.reset(new EigenThreadPoolDevice(num_threads));
+  }
+  return &device->device_;
+}
+}  // namespace
+
+Eigen::ThreadPoolDevice* CPUDeviceContext::eigen_pool_device() const {
+  int num_threads = GetNumThreads();
+  if (num_threads <= 1) {
+    return nullptr;
+  }
+  // Cache the last device of this thread to avoid locking on every kernel.
+  static thread_local int cached_num_threads = 0;
+  static thread_local Eigen::ThreadPoolDevice* cached_device = nullptr;
+  if (num_threads != cached_num_threads) {
+    cached_device = GetEigenThreadPoolDevice(num_threads);
+    cached_num_threads = num_threads;
+  }
+  return cached_device;
+}
+
 Place CPUDeviceContext::GetPlace() const { return place_; }
 
 #ifdef PADDLE_WITH_CUDA
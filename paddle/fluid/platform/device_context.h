@@ -59,6 +59,12 @@ class CPUDeviceContext : public DeviceContext {
 
   Eigen::DefaultDevice* eigen_device() const;
 
+  /*! \brief  Return the thread-pool eigen device sized to the intra-op
+   *  thread budget of the calling thread (see SetNumThreads), or nullptr
+   *  when the budget is a single thread. The thread pools are shared by all
+   *  CPU device contexts. */
+  Eigen::ThreadPoolDevice* eigen_pool_device() const;
+
   Place GetPlace() const override;
 
  private:
@@ -66,6 +72,48 @@ class CPUDeviceContext : public DeviceContext {
   std::unique_ptr<Eigen::DefaultDevice> eigen_device_;
 };
 
+/*! \brief  Call `func` with the eigen device that CPU kernels of `ctx`
+ *  should run on.
+ *
+ *  For CPUDeviceContext this is the thread-pool device when the calling
+ *  thread has an intra-op thread budget larger than one, and the default
+ *  device otherwise. `func` must be callable with any eigen device. */
+template <typename DeviceContext, typename Func>
+inline void VisitEigenDevice(const DeviceContext& ctx, Func&& func) {
+  func(*ctx.eigen_device());
+}
+
+template <typename Func>
+inline void VisitEigenDevice(const CPUDeviceContext& ctx, Func&& func) {
+  auto* pool_device = ctx.eigen_pool_device();
+  if (pool_device != nullptr) {
+    func(*pool_device);
+  } else {
+    func(*ctx.eigen_device());
+  }
+}
+
+template <typename Out, typename Expr>
+struct EigenAssignFunctor {
+  EigenAssignFunctor(Out out, const Expr& expr) : out_(out), expr_(expr) {}
+
+  template <typename Device>
+  void operator()(const Device& device) {
+    out_.device(device) = expr_;
+  }
+
+  Out out_;
+  const Expr& expr_;
+};
+
+/*! \brief  Evaluate `out = expr` on the eigen device chosen by
+ *  VisitEigenDevice. */
+template <typename DeviceContext, typename Out, typename Expr>
+inline void EigenDeviceAssign(const DeviceContext& ctx, Out out,
+                              const Expr& expr) {
+  VisitEigenDevice(ctx, EigenAssignFunctor<Out, Expr>(out, expr));
+}
+
 template <typename Place>
 struct DefaultDeviceContextType;
 
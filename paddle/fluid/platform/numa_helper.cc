@@ -0,0 +1,156 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/numa_helper.h"
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <dirent.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>  // NOLINT
+
+#include "glog/logging.h"
+
+namespace paddle {
+namespace platform {
+
+std::vector<int> ParseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    range.erase(std::remove_if(range.begin(), range.end(), ::isspace),
+                range.end());
+    if (range.empty()) {
+      continue;
+    }
+    size_t dash = range.find('-');
+    int first = std::stoi(range.substr(0, dash));
+    int last =
+        dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+static const char kNodeDir[] = "/sys/devices/system/node";
+
+std::vector<NumaNode> GetNumaNodes() {
+  std::vector<NumaNode> nodes;
+#if !defined(_WIN32) && !defined(__APPLE__)
+  DIR* dir = opendir(kNodeDir);
+  if (dir != nullptr) {
+    while (struct dirent* entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+          !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+        continue;
+      }
+      std::ifstream fin(std::string(kNodeDir) + "/" + name + "/cpulist");
+      std::string list;
+      std::getline(fin, list);
+      NumaNode node;
+      node.id = std::stoi(name.substr(4));
+      node.cpus = ParseCpuList(list);
+      if (!node.cpus.empty()) {
+        nodes.push_back(node);
+      }
+    }
+    closedir(dir);
+  }
+#endif
+  if (nodes.empty()) {
+    NumaNode node;
+    node.id = 0;
+    int num_cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (int cpu = 0; cpu < num_cpus; ++cpu) {
+      node.cpus.push_back(cpu);
+    }
+    nodes.push_back(node);
+  }
+  std::sort(nodes.begin(), nodes.end(),
+            [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+  return nodes;
+}
+
+std::vector<int> AssignThreadsToNumaNodes(int num_threads,
+                                          const std::vector<NumaNode>& nodes) {
+  std::vector<int> thread_nodes(num_threads, 0);
+  size_t total_cpus = 0;
+  for (auto& node : nodes) {
+    total_cpus += node.cpus.size();
+  }
+  if (total_cpus == 0) {
+    return thread_nodes;
+  }
+  // Node i takes the threads from round(num_threads * c_i / total) to
+  // round(num_threads * c_{i+1} / total), where c_i is the number of CPUs of
+  // the nodes before i.
+  auto boundary = [&](size_t cpus_before) {
+    return static_cast<int>((num_threads * cpus_before + total_cpus / 2) /
+                            total_cpus);
+  };
+  size_t cpus_before = 0;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    int begin = boundary(cpus_before);
+    cpus_before += nodes[i].cpus.size();
+    int end = boundary(cpus_before);
+    for (int t = begin; t < end; ++t) {
+      thread_nodes[t] = static_cast<int>(i);
+    }
+  }
+  return thread_nodes;
+}
+
+bool BindThreadToCpus(const std::vector<int>& cpus) {
+#if !defined(_WIN32) && !defined(__APPLE__)
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &mask);
+    }
+  }
+  if (CPU_COUNT(&mask) == 0 ||
+      sched_setaffinity(0, sizeof(mask), &mask) != 0) {
+    VLOG(1) << "WARNING: Failed to bind the thread to " << cpus.size()
+            << " CPUs";
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+std::map<std::string, int64_t> GetNumaStat(int node_id) {
+  std::map<std::string, int64_t> stat;
+  std::ifstream fin(std::string(kNodeDir) + "/node" + std::to_string(node_id) +
+                    "/numastat");
+  std::string name;
+  int64_t value;
+  while (fin >> name >> value) {
+    stat[name] = value;
+  }
+  return stat;
+}
+
+}  // namespace platform
+}  // namespace paddle
@@ -0,0 +1,53 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace platform {
+
+//! A NUMA node and its CPUs.
+struct NumaNode {
+  int id;
+  std::vector<int> cpus;
+};
+
+//! Parse a CPU list of the Linux sysfs, such as "0-3,8,10-11".
+std::vector<int> ParseCpuList(const std::string& list);
+
+//! Get the NUMA nodes having CPUs, read from the sysfs. A host without NUMA
+//! information is one node holding all the CPUs.
+std::vector<NumaNode> GetNumaNodes();
+
+//! Spread num_threads threads over nodes in contiguous blocks, in proportion
+//! to the number of CPUs of each node. Return the index in nodes of the node
+//! of every thread.
+std::vector<int> AssignThreadsToNumaNodes(int num_threads,
+                                          const std::vector<NumaNode>& nodes);
+
+//! Restrict the calling thread to cpus. The threads it creates afterwards
+//! inherit the restriction. Return false if it cannot be set.
+bool BindThreadToCpus(const std::vector<int>& cpus);
+
+//! Get the counters of /sys/devices/system/node/node<node_id>/numastat, in
+//! pages, e.g. numa_hit, numa_miss and other_node. Empty if not available.
+std::map<std::string, int64_t> GetNumaStat(int node_id);
+
+}  // namespace platform
+}  // namespace paddle
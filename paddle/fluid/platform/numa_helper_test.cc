@@ -0,0 +1,58 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/platform/numa_helper.h"
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace platform {
+
+TEST(NumaHelper, ParseCpuList) {
+  EXPECT_EQ(ParseCpuList("0-3,8,10-11\n"),
+            std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(ParseCpuList("5"), std::vector<int>({5}));
+  EXPECT_TRUE(ParseCpuList("").empty());
+}
+
+TEST(NumaHelper, GetNumaNodes) {
+  auto nodes = GetNumaNodes();
+  ASSERT_FALSE(nodes.empty());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    EXPECT_FALSE(nodes[i].cpus.empty());
+    if (i > 0) {
+      EXPECT_LT(nodes[i - 1].id, nodes[i].id);
+    }
+  }
+}
+
+TEST(NumaHelper, AssignThreadsToNumaNodes) {
+  std::vector<NumaNode> nodes(2);
+  nodes[0].id = 0;
+  nodes[0].cpus = {0, 1, 2, 3};
+  nodes[1].id = 1;
+  nodes[1].cpus = {4, 5, 6, 7};
+  EXPECT_EQ(AssignThreadsToNumaNodes(4, nodes),
+            std::vector<int>({0, 0, 1, 1}));
+  EXPECT_EQ(AssignThreadsToNumaNodes(3, nodes), std::vector<int>({0, 0, 1}));
+  EXPECT_EQ(AssignThreadsToNumaNodes(1, nodes), std::vector<int>({0}));
+
+  // Proportional to the CPUs of the nodes.
+  nodes[1].cpus = {4, 5};
+  EXPECT_EQ(AssignThreadsToNumaNodes(6, nodes),
+            std::vector<int>({0, 0, 0, 0, 1, 1}));
+}
+
+}  // namespace platform
+}  // namespace paddle
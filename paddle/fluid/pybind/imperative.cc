@@ -21,6 +21,7 @@ limitations under the License. */
 #include <pybind11/stl.h>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -184,6 +185,8 @@ void BindImperative(py::module *m_ptr) {
 
     1. :code:`sort_sum_gradient`, which will sum the gradient by the reverse order of trace.
 
+    2. :code:`num_threads`, the number of threads to run the independent grad ops on CPU, 1 by default.
+
     Examples:
 
         .. code-block:: python
@@ -211,6 +214,16 @@ void BindImperative(py::module *m_ptr) {
                     [](imperative::detail::BackwardStrategy &self,
                        bool sorted_sum_gradient) {
                       self.sorted_sum_gradient_ = sorted_sum_gradient;
+                    })
+      .def_property("num_threads",
+                    [](const imperative::detail::BackwardStrategy &self) {
+                      return self.num_threads_;
+                    },
+                    [](imperative::detail::BackwardStrategy &self,
+                       size_t num_threads) {
+                      PADDLE_ENFORCE_GT(num_threads, 0,
+                                        "num_threads should be positive");
+                      self.num_threads_ = num_threads;
                     });
 
   m.def("start_imperative_gperf_profiler",
@@ -218,6 +231,22 @@ void BindImperative(py::module *m_ptr) {
 
   m.def("stop_imperative_gperf_profiler", []() { imperative::StopProfile(); });
 
+  m.def("_enable_op_dispatch_stats", &imperative::EnableOpDispatchStats,
+        py::arg("enable") = true);
+  m.def("_reset_op_dispatch_stats", &imperative::ResetOpDispatchStats);
+  m.def("_get_op_dispatch_stats", []() {
+    // op type -> (hits, misses, hit time in ns, miss time in ns)
+    std::unordered_map<std::string,
+                       std::tuple<uint64_t, uint64_t, uint64_t, uint64_t>>
+        result;
+    for (auto& pair : imperative::GetOpDispatchStats()) {
+      auto& stats = pair.second;
+      result[pair.first] = std::make_tuple(stats.num_hits, stats.num_misses,
+                                           stats.hit_ns, stats.miss_ns);
+    }
+    return result;
+  });
+
   m.def("_is_dygraph_debug_enabled",
         []() { return imperative::IsDebugEnabled(); });
   m.def("_dygraph_debug_level", []() { return imperative::GetDebugLevel(); });
@@ -340,7 +369,14 @@ void BindImperative(py::module *m_ptr) {
                self.TraceOp(type, std::move(ins_map), std::move(outs_map),
                             std::move(attrs), place, trace_backward);
              }
-           });
+           })
+      .def("enable_capture", &imperative::Tracer::EnableCapture,
+           py::arg("enable") = true)
+      .def("is_capture_enabled", &imperative::Tracer::IsCaptureEnabled)
+      .def("begin_step", &imperative::Tracer::BeginStep)
+      .def("end_step", &imperative::Tracer::EndStep)
+      .def("num_replayed_ops", &imperative::Tracer::NumReplayedOps)
+      .def("num_captured_ops", &imperative::Tracer::NumCapturedOps);
 
   // define parallel context
   py::class_<imperative::ParallelStrategy> parallel_strategy(
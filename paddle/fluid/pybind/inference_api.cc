@@ -324,6 +324,8 @@ void BindAnalysisConfig(py::module *m) {
       .def("model_dir", &AnalysisConfig::model_dir)
       .def("prog_file", &AnalysisConfig::prog_file)
       .def("params_file", &AnalysisConfig::params_file)
+      .def("set_optim_model_file", &AnalysisConfig::SetOptimModelFile)
+      .def("optim_model_file", &AnalysisConfig::optim_model_file)
       .def("enable_use_gpu", &AnalysisConfig::EnableUseGpu,
            py::arg("memory_pool_init_size_mb"), py::arg("device_id") = 0)
       .def("disable_gpu", &AnalysisConfig::DisableGpu)
@@ -369,6 +371,15 @@ void BindAnalysisConfig(py::module *m) {
            &AnalysisConfig::SetCpuMathLibraryNumThreads)
       .def("cpu_math_library_num_threads",
            &AnalysisConfig::cpu_math_library_num_threads)
+      .def("set_inter_op_num_threads", &AnalysisConfig::SetInterOpNumThreads)
+      .def("inter_op_num_threads", &AnalysisConfig::inter_op_num_threads)
+      .def("enable_gemm_weight_packing",
+           &AnalysisConfig::EnableGemmWeightPacking, py::arg("x") = true)
+      .def("gemm_weight_packing_enabled",
+           &AnalysisConfig::gemm_weight_packing_enabled)
+      .def("enable_shared_params", &AnalysisConfig::EnableSharedParams,
+           py::arg("x") = true)
+      .def("shared_params_enabled", &AnalysisConfig::shared_params_enabled)
       .def("to_native_config", &AnalysisConfig::ToNativeConfig)
       .def("enable_quantizer", &AnalysisConfig::EnableMkldnnQuantizer)
 #ifdef PADDLE_WITH_MKLDNN
@@ -422,7 +433,11 @@ void BindAnalysisPredictor(py::module *m) {
       .def("scope", &AnalysisPredictor::scope,
            py::return_value_policy::reference)
       .def("SaveOptimModel", &AnalysisPredictor::SaveOptimModel,
-           py::arg("dir"));
+           py::arg("dir"))
+      .def("save_optim_model_file", &AnalysisPredictor::SaveOptimModelFile,
+           py::arg("path"))
+      .def("mutable_parameter", &AnalysisPredictor::MutableParameter,
+           py::return_value_policy::reference);
 }
 }  // namespace
 }  // namespace pybind
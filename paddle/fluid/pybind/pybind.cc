@@ -1175,6 +1175,13 @@ All parameter, weight, gradient are variables in Paddle.
   m.def("disable_profiler", platform::DisableProfiler);
   m.def("is_profiler_enabled", platform::IsProfileEnabled);
   m.def("reset_profiler", platform::ResetProfiler);
+  // The {op_type: (skipped, inferred)} InferShape counts of
+  // FLAGS_cache_infer_shape.
+  m.def("get_infer_shape_cache_stats", []() {
+    return framework::InferShapeCacheStats::Instance().Snapshot();
+  });
+  m.def("reset_infer_shape_cache_stats",
+        []() { framework::InferShapeCacheStats::Instance().Reset(); });
   m.def("get_pass", [](const std::string &pass_type) {
     auto pass = framework::ir::PassRegistry::Instance().Get(pass_type);
     return std::shared_ptr<framework::ir::Pass>(std::move(pass));
@@ -1330,6 +1337,20 @@ All parameter, weight, gradient are variables in Paddle.
           R"DOC(This config that how many iteration the executor will run when
                 user call pe.run() in python
               )DOC")
+      .def_property(
+          "use_critical_path_priority",
+          [](const ExecutionStrategy &self) {
+            return self.use_critical_path_priority_;
+          },
+          [](ExecutionStrategy &self, bool use_critical_path_priority) {
+            self.use_critical_path_priority_ = use_critical_path_priority;
+          },
+          R"DOC(The type is BOOL, use_critical_path_priority indicates whether
+                to run the ready operators in the order of the time of the
+                longest path from them to the end of the graph. The time of
+                every operator is measured in each iteration. It only works
+                with use_experimental_executor and num_threads > 1.
+                Default False.)DOC")
       .def_property("_dry_run",
                     [](const ExecutionStrategy &self) { return self.dry_run_; },
                     [](ExecutionStrategy &self, bool dry_run) {
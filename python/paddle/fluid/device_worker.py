@@ -211,6 +211,10 @@ class Section(DeviceWorker):
         section_param.queue_size = pipeline_opt["queue_size"]
         section_param.sync_steps = pipeline_opt["sync_steps"]
         section_param.start_cpu_core_id = pipeline_opt["start_cpu_core_id"]
+        section_param.adaptive_concurrency = pipeline_opt.get(
+            "adaptive_concurrency", False)
+        section_param.balance_interval_ms = pipeline_opt.get(
+            "balance_interval_ms", 1000)
         for e in pipeline_opt["param_need_sync"]:
             section_param.param_need_sync.append(e)
         for i, program in enumerate(pipeline_opt["section_program_list"]):
@@ -2804,6 +2804,10 @@ class PipelineOptimizer(object):
                         specify the scope queue size. [Optional. Default: 30].
         sync_steps (int): The synchronization steps between different cards. [Optional. Default: 1].
         start_cpu_core_id (int): specify the first cpu core id. [Optional. Default:0].
+        adaptive_concurrency (bool): Move the threads between the CPU sections after \
+                        the first one at runtime, to equalize their throughput. The \
+                        concurrency_list gives the initial threads. [Optional. Default: False].
+        balance_interval_ms (int): The interval of the moves in milliseconds. [Optional. Default: 1000].
 
     Examples:
         .. code-block:: python
@@ -2852,7 +2856,9 @@ class PipelineOptimizer(object):
                  concurrency_list=None,
                  queue_size=30,
                  sync_steps=1,
-                 start_cpu_core_id=0):
+                 start_cpu_core_id=0,
+                 adaptive_concurrency=False,
+                 balance_interval_ms=1000):
         # TODO: check properties
         self._optimizer = optimizer
         self._cut_list = cut_list
@@ -2861,6 +2867,8 @@ class PipelineOptimizer(object):
         self._queue_size = queue_size
         self._sync_steps = sync_steps
         self._start_cpu_core_id = start_cpu_core_id
+        self._adaptive_concurrency = adaptive_concurrency
+        self._balance_interval_ms = balance_interval_ms
 
     def _create_vars(self, block, main_program):
         used_var_set = set()
@@ -3067,7 +3075,9 @@ class PipelineOptimizer(object):
             "queue_size": self._queue_size,
             "start_cpu_core_id": self._start_cpu_core_id,
             "sync_steps": self._sync_steps,
-            "param_need_sync": param_need_sync
+            "param_need_sync": param_need_sync,
+            "adaptive_concurrency": self._adaptive_concurrency,
+            "balance_interval_ms": self._balance_interval_ms
         }
 
 
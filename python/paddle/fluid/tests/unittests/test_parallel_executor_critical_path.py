@@ -0,0 +1,96 @@
+# Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import os
+os.environ['CPU_NUM'] = str(4)
+
+import time
+import unittest
+import numpy as np
+import six
+import paddle.fluid as fluid
+from paddle.fluid import compiler
+
+
+def branchy_net():
+    img = fluid.layers.data(name='img', shape=[784], dtype='float32')
+    label = fluid.layers.data(name='label', shape=[1], dtype='int64')
+    # Branches of different depth, so that the critical path is not the
+    # path through the most operators.
+    branches = []
+    for depth in (1, 2, 4):
+        hidden = img
+        for _ in six.moves.xrange(depth):
+            hidden = fluid.layers.fc(input=hidden, size=64, act='tanh')
+        branches.append(hidden)
+    wide = fluid.layers.fc(input=img, size=512, act='relu')
+    branches.append(fluid.layers.fc(input=wide, size=64, act='tanh'))
+    hidden = fluid.layers.sums(branches)
+    prediction = fluid.layers.fc(input=hidden, size=10, act='softmax')
+    loss = fluid.layers.cross_entropy(input=prediction, label=label)
+    avg_loss = fluid.layers.mean(loss)
+    fluid.optimizer.SGD(learning_rate=0.01).minimize(avg_loss)
+    return avg_loss
+
+
+class TestCriticalPathPriority(unittest.TestCase):
+    def run_program(self, use_critical_path_priority, iters=10):
+        main_prog = fluid.Program()
+        startup_prog = fluid.Program()
+        main_prog.random_seed = 1
+        startup_prog.random_seed = 1
+        scope = fluid.Scope()
+        with fluid.program_guard(main_prog, startup_prog):
+            with fluid.scope_guard(scope):
+                loss = branchy_net()
+                exe = fluid.Executor(fluid.CPUPlace())
+                exe.run(startup_prog)
+
+                exec_strategy = fluid.ExecutionStrategy()
+                exec_strategy.num_threads = 4
+                exec_strategy.use_experimental_executor = True
+                exec_strategy.use_critical_path_priority = \
+                    use_critical_path_priority
+                train_cp = compiler.CompiledProgram(
+                    main_prog).with_data_parallel(
+                        loss_name=loss.name, exec_strategy=exec_strategy)
+
+                np.random.seed(1)
+                img = np.random.random(size=[32, 784]).astype('float32')
+                label = np.random.randint(
+                    0, 10, size=[32, 1]).astype('int64')
+                losses = []
+                start = time.time()
+                for _ in six.moves.xrange(iters):
+                    loss_v, = exe.run(train_cp,
+                                      feed={'img': img,
+                                            'label': label},
+                                      fetch_list=[loss.name])
+                    losses.append(np.mean(loss_v))
+                elapsed = (time.time() - start) / iters
+        print("use_critical_path_priority={}: {:.3f} ms per iteration".format(
+            use_critical_path_priority, elapsed * 1000))
+        return losses
+
+    def test_same_losses(self):
+        expected = self.run_program(False)
+        actual = self.run_program(True)
+        self.assertTrue(np.allclose(expected, actual, atol=1e-5))
+        self.assertLess(actual[-1], actual[0])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -94,6 +94,17 @@ class TrainerDesc(object):
     def _set_dump_converter(self, converter):
         self.proto_desc.dump_converter = converter
 
+    def _set_metrics(self, path, interval_ms=10000):
+        self.proto_desc.metrics_path = path
+        self.proto_desc.metrics_interval_ms = interval_ms
+
+    def _set_binding_cpu(self, binding_cpu):
+        self.proto_desc.binding_cpu = binding_cpu
+
+    def _set_numa_replica(self, max_numel, sync_interval_ms=100):
+        self.proto_desc.numa_replica_max_numel = max_numel
+        self.proto_desc.numa_sync_interval_ms = sync_interval_ms
+
     def _set_adjust_ins_weight(self, config_dict):
         self.proto_desc.adjust_ins_weight_config.need_adjust = \
                 config_dict.get("need_adjust", False)
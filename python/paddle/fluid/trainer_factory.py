@@ -46,5 +46,14 @@ class TrainerFactory(object):
                 trainer._set_dump_fields_path(opt_info["dump_fields_path"])
                 trainer._set_dump_converter(opt_info["dump_converter"])
                 trainer._set_adjust_ins_weight(opt_info["adjust_ins_weight"])
+            if opt_info.get("metrics_path"):
+                trainer._set_metrics(opt_info["metrics_path"],
+                                     opt_info.get("metrics_interval_ms",
+                                                  10000))
+            if opt_info.get("binding_cpu"):
+                trainer._set_binding_cpu(True)
+                trainer._set_numa_replica(
+                    opt_info.get("numa_replica_max_numel", 0),
+                    opt_info.get("numa_sync_interval_ms", 100))
             trainer._set_device_worker(device_worker)
         return trainer